@@ -0,0 +1,279 @@
+//
+//  File: bench.cpp
+//
+//  Created by Jon Spencer on 2026-10-16 15:31:12
+//  Copyright (c) Jon Spencer. See LICENSE file.
+//
+
+#include "corpus.h"
+#include "generate.h"
+#include "namemap.h"
+#include "descriptorset.h"
+#include "descriptorwrite.h"
+#include "shadersource.h"
+#include <cxxopts.hpp>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <sstream>
+
+#ifdef WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+namespace autoshader {
+
+	namespace {
+
+		// the phases in the order they run
+		const char *phases[] = {
+			"load_spirv", "parse", "find_buffer_structs", "get_descriptor_sets", "map_struct_names",
+			"struct_definition", "descriptor_writer", "shader_source", "generate_pipeline",
+		};
+
+		//------------------------------------------------------------------------------------------
+		//-- PhaseTimes: the times of each phase for every iteration, in milliseconds
+
+		typedef std::map<string, vector<double>> PhaseTimes;
+
+		//------------------------------------------------------------------------------------------
+		//-- time a phase, adding it to the times
+
+		void time_phase(PhaseTimes &times, const char *phase, const std::function<void()> &f) {
+			auto start = std::chrono::steady_clock::now();
+			f();
+			times[phase].push_back(std::chrono::duration<double, std::milli>(
+				std::chrono::steady_clock::now() - start).count());
+		}
+
+		double median(vector<double> v) {
+			std::sort(v.begin(), v.end());
+			auto n = v.size();
+			return n == 0 ? 0 : n % 2 == 1 ? v[n / 2] : (v[n / 2 - 1] + v[n / 2]) / 2;
+		}
+
+		void make_directory(const string &d) {
+			#ifdef WIN32
+			_mkdir(d.c_str());
+			#else
+			mkdir(d.c_str(), 0777);
+			#endif
+		}
+
+		//------------------------------------------------------------------------------------------
+		//-- write the corpus stages to files, returning the file names
+
+		vector<string> write_corpus(const CorpusOptions &c, const string &dir, size_t scale) {
+			make_directory(dir);
+			vector<string> r;
+			for (size_t i = 0; i < c.stages; ++i) {
+				auto w = build_corpus_stage(c, i);
+				auto name = fmt::format("{}/corpus{}.{}.spv", dir, scale, corpus_stage_name(i));
+				std::ofstream str(name, std::ios::binary);
+				str.write(reinterpret_cast<const char*>(w.data()), sizeof(uint32_t) * w.size());
+				if (!str.good())
+					throw std::runtime_error("error writing corpus file: " + name);
+				r.push_back(name);
+			}
+			return r;
+		}
+
+		//------------------------------------------------------------------------------------------
+		//-- run every phase over the corpus once
+
+		void run_phases(PhaseTimes &times, const vector<string> &files) {
+			vector<ShaderRecord> sh(files.size());
+			time_phase(times, "load_spirv", [&] () {
+				for (size_t i = 0; i < files.size(); ++i)
+					sh[i].source = load_spirv(files[i]);
+			});
+
+			time_phase(times, "parse", [&] () {
+				for (auto &s : sh)
+					s.reflection = reflect_spirv(s.source);
+			});
+
+			time_phase(times, "find_buffer_structs", [&] () {
+				for (auto &s : sh)
+					find_buffer_structs(s.structs, *s.reflection);
+			});
+
+			std::map<uint32_t, DescriptorSet> sets;
+			time_phase(times, "get_descriptor_sets", [&] () {
+				for (auto &s : sh) {
+					std::map<uint32_t, DescriptorSet> ss;
+					get_descriptor_sets(ss, *s.reflection);
+					merge_descriptor_sets(sets, ss);
+				}
+			});
+
+			time_phase(times, "map_struct_names", [&] () { map_struct_names(sh); });
+
+			fmt::memory_buffer r;
+			time_phase(times, "struct_definition", [&] () {
+				for (auto &s : sh) {
+					for (auto t : s.structs)
+						struct_definition(r, s, t, "  ");
+				}
+			});
+
+			time_phase(times, "descriptor_writer", [&] () { descriptor_writer(r, sets, "  "); });
+
+			time_phase(times, "shader_source", [&] () {
+				for (auto &s : sh)
+					stage_source(r, stage_data(s, false, false), "  ");
+			});
+
+			// the whole generator, starting from a parsed pipeline
+			PipelineOptions opts;
+			opts.namespaces = { "bench" };
+			time_phase(times, "generate_pipeline", [&] () { generate_pipeline("bench", opts, sh, 1); });
+		}
+
+		//------------------------------------------------------------------------------------------
+		//-- read a baseline file of "scale phase milliseconds" lines
+
+		std::map<std::pair<size_t, string>, double> read_baseline(const string &name) {
+			std::ifstream str(name);
+			if (!str.good())
+				throw std::runtime_error("failed to open baseline: " + name);
+			std::map<std::pair<size_t, string>, double> r;
+			string line;
+			while (std::getline(str, line)) {
+				std::istringstream l(line);
+				size_t scale;
+				string phase;
+				double ms;
+				if (l >> scale >> phase >> ms)
+					r[std::make_pair(scale, phase)] = ms;
+			}
+			return r;
+		}
+
+		vector<size_t> parse_scales(const string &s) {
+			vector<size_t> r;
+			std::istringstream str(s);
+			for (string t; std::getline(str, t, ',');) {
+				auto v = std::stoul(t);
+				if (v == 0)
+					throw std::runtime_error("scales must be positive");
+				r.push_back(v);
+			}
+			return r;
+		}
+
+	} // namespace
+
+	int main(int ac, char *av[]) {
+		cxxopts::Options opts("autoshader-bench", "time the phases of the generator on a synthetic pipeline");
+
+		opts
+		.add_options()
+			("h,help", "print help")
+			("structs", "structures per stage at scale 1", cxxopts::value<size_t>()->default_value("256"))
+			("depth", "nesting depth of the structure chains", cxxopts::value<size_t>()->default_value("8"))
+			("descriptors", "image descriptors at scale 1", cxxopts::value<size_t>()->default_value("64"))
+			("specs", "specialization constants at scale 1", cxxopts::value<size_t>()->default_value("64"))
+			("stages", "number of stages (at most 5)", cxxopts::value<size_t>()->default_value("5"))
+			("scales", "comma separated multipliers of the structures, descriptors and constants",
+				cxxopts::value<string>()->default_value("1,2,4,8"))
+			("iterations", "runs of each scale, the median time is reported",
+				cxxopts::value<size_t>()->default_value("5"))
+			("corpus-dir", "directory for the generated spirv",
+				cxxopts::value<string>()->default_value("autoshader-bench-corpus"))
+			("save", "save the times as a baseline", cxxopts::value<string>())
+			("compare", "compare the times against a baseline, failing on regressions",
+				cxxopts::value<string>())
+			("tolerance", "slowdown ratio that counts as a regression",
+				cxxopts::value<double>()->default_value("1.25"))
+			("min-time", "times below this many milliseconds are too noisy to compare",
+				cxxopts::value<double>()->default_value("0.1"));
+
+		auto options = opts.parse(ac, av);
+
+		if (options["help"].as<bool>()) {
+			std::cerr << opts.help() << std::endl;
+			return 0;
+		}
+
+		CorpusOptions base;
+		base.structs = options["structs"].as<size_t>();
+		base.depth = options["depth"].as<size_t>();
+		base.descriptors = options["descriptors"].as<size_t>();
+		base.specs = options["specs"].as<size_t>();
+		base.stages = options["stages"].as<size_t>();
+		if (base.stages == 0 || base.stages > maxCorpusStages)
+			throw std::runtime_error(fmt::format("stages must be 1 to {}", maxCorpusStages));
+		auto iterations = std::max(options["iterations"].as<size_t>(), size_t(1));
+		auto dir = options["corpus-dir"].as<string>();
+
+		std::map<std::pair<size_t, string>, double> baseline;
+		if (options.count("compare") != 0)
+			baseline = read_baseline(options["compare"].as<string>());
+		auto tolerance = options["tolerance"].as<double>();
+		auto minTime = options["min-time"].as<double>();
+
+		// one row per scale and phase, so the scaling curve of each phase can be plotted
+		fmt::memory_buffer saved;
+		size_t regressions = 0;
+		std::cout << fmt::format("{:>6} {:>8} {:>11} {:>6} {:>6} {:<20} {:>10}{}\n", "scale",
+			"structs", "descriptors", "specs", "stages", "phase", "ms", baseline.empty() ? "" : "   baseline");
+		for (auto scale : parse_scales(options["scales"].as<string>())) {
+			auto c = base;
+			c.structs *= scale;
+			c.descriptors *= scale;
+			c.specs *= scale;
+			auto files = write_corpus(c, dir, scale);
+
+			PhaseTimes times;
+			for (size_t i = 0; i < iterations; ++i)
+				run_phases(times, files);
+
+			for (auto phase : phases) {
+				auto ms = median(times[phase]);
+				format_to(std::back_inserter(saved), "{} {} {:.4f}\n", scale, phase, ms);
+				std::cout << fmt::format("{:>6} {:>8} {:>11} {:>6} {:>6} {:<20} {:>10.3f}", scale,
+					c.structs, c.descriptors, c.specs, c.stages, phase, ms);
+
+				auto b = baseline.find(std::make_pair(scale, string(phase)));
+				if (b != baseline.end()) {
+					bool slow = ms > b->second * tolerance && ms > minTime;
+					regressions += slow ? 1 : 0;
+					std::cout << fmt::format(" {:>10.3f} {:>5.2f}x{}", b->second,
+						b->second > 0 ? ms / b->second : 0, slow ? " REGRESSION" : "");
+				}
+				std::cout << "\n";
+			}
+		}
+
+		if (options.count("save") != 0) {
+			auto name = options["save"].as<string>();
+			std::ofstream str(name);
+			str.write(saved.data(), saved.size());
+			if (!str.good())
+				throw std::runtime_error("error writing baseline: " + name);
+		}
+
+		if (regressions != 0) {
+			std::cerr << "autoshader-bench: " << regressions << " phases regressed" << std::endl;
+			return 1;
+		}
+		return 0;
+	}
+
+} // namespace autoshader
+
+int main(int ac, char *av[]) {
+	try {
+		return autoshader::main(ac, av);
+	}
+	catch (std::exception &err) {
+		std::cerr << av[0] << " failed: " << err.what() << std::endl;
+	}
+	return 10;
+}
@@ -0,0 +1,252 @@
+//
+//  File: corpus.cpp
+//
+//  Created by Jon Spencer on 2026-10-16 14:59:02
+//  Copyright (c) Jon Spencer. See LICENSE file.
+//
+
+#include "corpus.h"
+#include <fmt/format.h>
+#include <algorithm>
+#include <stdexcept>
+
+namespace autoshader {
+
+	namespace {
+
+		// the pieces of the spirv specification used by the corpus
+		enum : uint32_t {
+			OpSource = 3, OpName = 5, OpMemberName = 6, OpMemoryModel = 14, OpEntryPoint = 15,
+			OpExecutionMode = 16, OpCapability = 17, OpTypeVoid = 19, OpTypeInt = 21,
+			OpTypeFloat = 22, OpTypeVector = 23, OpTypeMatrix = 24, OpTypeImage = 25,
+			OpTypeSampledImage = 27, OpTypeArray = 28, OpTypeStruct = 30, OpTypePointer = 32,
+			OpTypeFunction = 33, OpConstant = 43, OpSpecConstant = 50, OpFunction = 54,
+			OpFunctionEnd = 56, OpVariable = 59, OpDecorate = 71, OpMemberDecorate = 72,
+			OpLabel = 248, OpReturn = 253,
+		};
+
+		enum : uint32_t {
+			DecorationSpecId = 1, DecorationBlock = 2, DecorationBufferBlock = 3,
+			DecorationColMajor = 5, DecorationArrayStride = 6, DecorationMatrixStride = 7,
+			DecorationLocation = 30, DecorationBinding = 33, DecorationDescriptorSet = 34,
+			DecorationOffset = 35,
+		};
+
+		enum : uint32_t {
+			StorageUniformConstant = 0, StorageInput = 1, StorageUniform = 2,
+			StoragePushConstant = 9,
+		};
+
+		struct StageInfo {
+			const char *name;
+			uint32_t model;
+			vector<vector<uint32_t>> modes;
+		};
+
+		// the graphics stages in pipeline order of the generated names
+		const StageInfo &stage_info(size_t stage) {
+			static const StageInfo stages[maxCorpusStages] = {
+				{ "vert", 0, {} },
+				{ "frag", 4, { { 7 } } },
+				{ "tesc", 1, { { 26, 3 } } },
+				{ "tese", 2, { { 22 }, { 1 }, { 4 } } },
+				{ "geom", 3, { { 19 }, { 27 }, { 26, 1 }, { 0, 1 } } },
+			};
+			if (stage >= maxCorpusStages)
+				throw std::runtime_error(fmt::format("corpus has at most {} stages", maxCorpusStages));
+			return stages[stage];
+		}
+
+		//------------------------------------------------------------------------------------------
+		//-- SpirvBuilder: collects the logical sections of a module and assembles them in order
+
+		struct SpirvBuilder {
+			uint32_t bound = 1;
+			vector<uint32_t> preamble, entry, debug, annotations, types, functions;
+
+			uint32_t id() { return bound++; }
+
+			static void op(vector<uint32_t> &s, uint32_t code, const vector<uint32_t> &operands) {
+				s.push_back(uint32_t(operands.size() + 1) << 16 | code);
+				s.insert(s.end(), operands.begin(), operands.end());
+			}
+
+			static vector<uint32_t> literal(const string &n) {
+				vector<uint32_t> r(n.size() / 4 + 1, 0);
+				for (size_t i = 0; i < n.size(); ++i)
+					r[i / 4] |= uint32_t(uint8_t(n[i])) << (8 * (i % 4));
+				return r;
+			}
+
+			static vector<uint32_t> concat(vector<uint32_t> a, const vector<uint32_t> &b) {
+				a.insert(a.end(), b.begin(), b.end());
+				return a;
+			}
+
+			void name(uint32_t t, const string &n) { op(debug, OpName, concat({ t }, literal(n))); }
+
+			void member_name(uint32_t t, uint32_t m, const string &n) {
+				op(debug, OpMemberName, concat({ t, m }, literal(n)));
+			}
+
+			void decorate(uint32_t t, const vector<uint32_t> &d) {
+				op(annotations, OpDecorate, concat({ t }, d));
+			}
+
+			void member_decorate(uint32_t t, uint32_t m, const vector<uint32_t> &d) {
+				op(annotations, OpMemberDecorate, concat({ t, m }, d));
+			}
+
+			uint32_t type(uint32_t code, const vector<uint32_t> &operands) {
+				auto r = id();
+				op(types, code, concat({ r }, operands));
+				return r;
+			}
+
+			uint32_t value(uint32_t code, uint32_t type, const vector<uint32_t> &operands) {
+				auto r = id();
+				op(types, code, concat({ type, r }, operands));
+				return r;
+			}
+
+			vector<uint32_t> assemble() const {
+				vector<uint32_t> r = { 0x07230203, 0x00010000, 0, bound, 0 };
+				for (auto s : { &preamble, &entry, &debug, &annotations, &types, &functions })
+					r.insert(r.end(), s->begin(), s->end());
+				return r;
+			}
+		};
+
+	} // namespace
+
+
+	//------------------------------------------------------------------------------------------
+	//-- the name of a corpus stage
+
+	string corpus_stage_name(size_t stage) {
+		return stage_info(stage).name;
+	}
+
+
+	//------------------------------------------------------------------------------------------
+	//-- build one stage of the corpus
+
+	vector<uint32_t> build_corpus_stage(const CorpusOptions &opts, size_t stage) {
+		auto &info = stage_info(stage);
+		auto depth = std::max(opts.depth, size_t(1));
+		SpirvBuilder b;
+
+		SpirvBuilder::op(b.preamble, OpCapability, { 1 });
+		if (info.model == 1 || info.model == 2)
+			SpirvBuilder::op(b.preamble, OpCapability, { 3 });
+		if (info.model == 3)
+			SpirvBuilder::op(b.preamble, OpCapability, { 2 });
+		SpirvBuilder::op(b.preamble, OpMemoryModel, { 0, 1 });
+		SpirvBuilder::op(b.debug, OpSource, { 2, 450 });
+
+		// the basic types
+		auto tvoid = b.type(OpTypeVoid, {});
+		auto tfn = b.type(OpTypeFunction, { tvoid });
+		auto tfloat = b.type(OpTypeFloat, { 32 });
+		auto tint = b.type(OpTypeInt, { 32, 1 });
+		auto tuint = b.type(OpTypeInt, { 32, 0 });
+		auto tvec4 = b.type(OpTypeVector, { tfloat, 4 });
+		auto tmat4 = b.type(OpTypeMatrix, { tvec4, 4 });
+		auto c4 = b.value(OpConstant, tuint, { 4 });
+		auto tarr = b.type(OpTypeArray, { tvec4, c4 });
+		b.decorate(tarr, { DecorationArrayStride, 16 });
+
+		// the structures, each chain ending in a block
+		vector<uint32_t> interface;
+		vector<uint32_t> structs(opts.structs);
+		uint32_t binding = 0;
+		for (size_t i = 0; i < opts.structs; ++i) {
+			bool nested = i % depth != 0;
+			bool variant = stage != 0 && (i + stage) % 7 == 0;
+			vector<uint32_t> members = { variant ? tint : tfloat, tvec4, tmat4, tarr };
+			if (nested)
+				members.push_back(structs[i - 1]);
+			auto t = structs[i] = b.type(OpTypeStruct, members);
+
+			b.name(t, fmt::format("S{}", i));
+			const char *names[] = { "a", "b", "c", "d", "e" };
+			const uint32_t offsets[] = { 0, 16, 32, 96, 160 };
+			for (uint32_t m = 0; m < members.size(); ++m) {
+				b.member_name(t, m, names[m]);
+				b.member_decorate(t, m, { DecorationOffset, offsets[m] });
+			}
+			b.member_decorate(t, 2, { DecorationColMajor });
+			b.member_decorate(t, 2, { DecorationMatrixStride, 16 });
+
+			// the root of a chain is bound as a uniform or storage buffer
+			if (i % depth == depth - 1 || i + 1 == opts.structs) {
+				bool storage = binding % 2 == 1;
+				b.decorate(t, { storage ? DecorationBufferBlock : DecorationBlock });
+				auto p = b.type(OpTypePointer, { StorageUniform, t });
+				auto v = b.value(OpVariable, p, { StorageUniform });
+				b.name(v, fmt::format("buffer{}", binding));
+				b.decorate(v, { DecorationDescriptorSet, 0 });
+				b.decorate(v, { DecorationBinding, binding++ });
+			}
+		}
+
+		// a large image descriptor set, with some arrays
+		auto timg = b.type(OpTypeImage, { tfloat, 1, 0, 0, 0, 1, 0 });
+		auto tsimg = b.type(OpTypeSampledImage, { timg });
+		auto psimg = b.type(OpTypePointer, { StorageUniformConstant, tsimg });
+		auto tsarr = b.type(OpTypeArray, { tsimg, c4 });
+		auto psarr = b.type(OpTypePointer, { StorageUniformConstant, tsarr });
+		for (uint32_t i = 0; i < opts.descriptors; ++i) {
+			auto v = b.value(OpVariable, i % 8 == 7 ? psarr : psimg, { StorageUniformConstant });
+			b.name(v, fmt::format("image{}", i));
+			b.decorate(v, { DecorationDescriptorSet, 1 });
+			b.decorate(v, { DecorationBinding, i });
+		}
+
+		// each stage has its own push constant range
+		auto tpush = b.type(OpTypeStruct, { tmat4 });
+		b.name(tpush, "Push");
+		b.member_name(tpush, 0, "transform");
+		b.member_decorate(tpush, 0, { DecorationOffset, uint32_t(64 * stage) });
+		b.member_decorate(tpush, 0, { DecorationColMajor });
+		b.member_decorate(tpush, 0, { DecorationMatrixStride, 16 });
+		b.decorate(tpush, { DecorationBlock });
+		auto ppush = b.type(OpTypePointer, { StoragePushConstant, tpush });
+		auto vpush = b.value(OpVariable, ppush, { StoragePushConstant });
+		b.name(vpush, "push");
+
+		// the specialization constants are shared by every stage
+		for (uint32_t i = 0; i < opts.specs; ++i) {
+			auto c = b.value(OpSpecConstant, tuint, { i });
+			b.name(c, fmt::format("spec{}", i));
+			b.decorate(c, { DecorationSpecId, i });
+		}
+
+		// vertex inputs
+		if (info.model == 0) {
+			auto pin = b.type(OpTypePointer, { StorageInput, tvec4 });
+			for (uint32_t i = 0; i < 4; ++i) {
+				auto v = b.value(OpVariable, pin, { StorageInput });
+				b.name(v, fmt::format("in{}", i));
+				b.decorate(v, { DecorationLocation, i });
+				interface.push_back(v);
+			}
+		}
+
+		// an empty main
+		auto main = b.id();
+		b.name(main, "main");
+		SpirvBuilder::op(b.functions, OpFunction, { tvoid, main, 0, tfn });
+		SpirvBuilder::op(b.functions, OpLabel, { b.id() });
+		SpirvBuilder::op(b.functions, OpReturn, {});
+		SpirvBuilder::op(b.functions, OpFunctionEnd, {});
+
+		SpirvBuilder::op(b.entry, OpEntryPoint, SpirvBuilder::concat(
+			SpirvBuilder::concat({ info.model, main }, SpirvBuilder::literal("main")), interface));
+		for (auto &m : info.modes)
+			SpirvBuilder::op(b.entry, OpExecutionMode, SpirvBuilder::concat({ main }, m));
+
+		return b.assemble();
+	}
+
+} // namespace autoshader
@@ -0,0 +1,42 @@
+//
+//  File: corpus.h
+//
+//  Created by Jon Spencer on 2026-10-16 14:58:37
+//  Copyright (c) Jon Spencer. See LICENSE file.
+//
+#ifndef H_BENCH_CORPUS_H__
+#define H_BENCH_CORPUS_H__
+
+#include "autoshader.h"
+#include <cstdint>
+
+namespace autoshader {
+
+	//------------------------------------------------------------------------------------------
+	//-- CorpusOptions: the shape of a synthetic pipeline. the structures are nested in chains of
+	//-- depth, and the root of every chain is a buffer block. each stage declares the same
+	//-- structure names, with some stages changing a member so the names conflict.
+
+	struct CorpusOptions {
+		size_t structs = 256;
+		size_t depth = 8;
+		size_t descriptors = 64;
+		size_t specs = 64;
+		size_t stages = 5;
+	};
+
+	//------------------------------------------------------------------------------------------
+	//-- the largest number of stages in a corpus pipeline
+	constexpr size_t maxCorpusStages = 5;
+
+	//------------------------------------------------------------------------------------------
+	//-- the name of a corpus stage (vert, frag, tesc, tese, geom)
+	string corpus_stage_name(size_t stage);
+
+	//------------------------------------------------------------------------------------------
+	//-- build the spirv module for one stage of the corpus pipeline
+	vector<uint32_t> build_corpus_stage(const CorpusOptions &opts, size_t stage);
+
+} // namespace autoshader
+
+#endif // H_BENCH_CORPUS_H__
@@ -1,8 +1,15 @@
 #
 # Copyright(c) 2018 Jon Spencer. See LICENSE file.
 
+# quote an argument for an autoshader manifest line
+function(autoshader_manifest_quote var arg)
+	string(REPLACE "\\" "\\\\" arg "${arg}")
+	string(REPLACE "\"" "\\\"" arg "${arg}")
+	set(${var} "\"${arg}\"" PARENT_SCOPE)
+endfunction()
+
 function(autoshader)
-	cmake_parse_arguments(arg "" "OUTPUT;DATAFILE" "SHADERS;DEPENDS;EXTRA" "${ARGN}")
+	cmake_parse_arguments(arg "" "OUTPUT;DATAFILE;DATAFORMAT;REFLECTJSON;REFLECTBINARY;MANIFEST" "SHADERS;DEPENDS;EXTRA" "${ARGN}")
 
 	# add in input arg for each source shader
 	set(arglist "")
@@ -21,6 +28,22 @@ function(autoshader)
 		list(APPEND outputs "${arg_DATAFILE}")
 	endif()
 
+	# the incbin stub changes whenever the stage binaries it includes do, so they don't need
+	# to be listed as outputs
+	if(arg_DATAFORMAT)
+		list(APPEND arglist "--data-format" "${arg_DATAFORMAT}")
+	endif()
+
+	# machine readable reflection of the pipeline
+	if(arg_REFLECTJSON)
+		list(APPEND arglist "--reflect-json" "${arg_REFLECTJSON}")
+		list(APPEND outputs "${arg_REFLECTJSON}")
+	endif()
+	if(arg_REFLECTBINARY)
+		list(APPEND arglist "--reflect-binary" "${arg_REFLECTBINARY}")
+		list(APPEND outputs "${arg_REFLECTBINARY}")
+	endif()
+
 	# create output directories
 	foreach(out ${outputs})
 		get_filename_component(out_dir ${out} DIRECTORY)
@@ -30,6 +53,41 @@ function(autoshader)
 		endif()
 	endforeach()
 
+	# add the pipeline to a manifest that is generated by autoshader_manifest
+	if(arg_MANIFEST)
+		# the manifest command may run elsewhere, so make the paths absolute
+		set(line "")
+		set(path_next OFF)
+		foreach(a ${arglist})
+			if(a STREQUAL "--input" OR a STREQUAL "--output" OR a STREQUAL "--data" OR
+					a STREQUAL "--reflect-json" OR a STREQUAL "--reflect-binary")
+				set(path_next ON)
+			elseif(path_next)
+				get_filename_component(a "${a}" ABSOLUTE BASE_DIR "${CMAKE_CURRENT_BINARY_DIR}")
+				set(path_next OFF)
+			endif()
+			autoshader_manifest_quote(a "${a}")
+			string(APPEND line " ${a}")
+		endforeach()
+		string(STRIP "${line}" line)
+
+		set(abs_outputs "")
+		foreach(out ${outputs})
+			get_filename_component(out "${out}" ABSOLUTE BASE_DIR "${CMAKE_CURRENT_BINARY_DIR}")
+			list(APPEND abs_outputs "${out}")
+		endforeach()
+		set(abs_depends "")
+		foreach(dep ${arg_SHADERS} ${arg_DEPENDS})
+			get_filename_component(dep "${dep}" ABSOLUTE BASE_DIR "${CMAKE_CURRENT_BINARY_DIR}")
+			list(APPEND abs_depends "${dep}")
+		endforeach()
+
+		set_property(GLOBAL APPEND PROPERTY autoshader_manifest_${arg_MANIFEST}_lines "${line}")
+		set_property(GLOBAL APPEND PROPERTY autoshader_manifest_${arg_MANIFEST}_outputs ${abs_outputs})
+		set_property(GLOBAL APPEND PROPERTY autoshader_manifest_${arg_MANIFEST}_depends ${abs_depends})
+		return()
+	endif()
+
 	# invoke autoshader to generate the interface
 	add_custom_command(
 		OUTPUT ${outputs}
@@ -38,3 +96,35 @@ function(autoshader)
 		VERBATIM
 		)
 endfunction()
+
+# generate every pipeline added with autoshader(MANIFEST name ...) in a single command. the
+# outputs are usable by targets in the calling directory, and a custom target with the
+# manifest name (built by default with ALL) is created for dependencies from elsewhere.
+function(autoshader_manifest name)
+	cmake_parse_arguments(arg "ALL" "" "EXTRA" "${ARGN}")
+
+	get_property(lines GLOBAL PROPERTY autoshader_manifest_${name}_lines)
+	get_property(outputs GLOBAL PROPERTY autoshader_manifest_${name}_outputs)
+	get_property(depends GLOBAL PROPERTY autoshader_manifest_${name}_depends)
+	if(NOT lines)
+		message(FATAL_ERROR "autoshader manifest ${name} has no pipelines")
+	endif()
+
+	# only touch the manifest when it changes
+	set(manifest "${CMAKE_CURRENT_BINARY_DIR}/${name}.autoshader")
+	list(JOIN lines "\n" content)
+	file(WRITE "${manifest}.tmp" "${content}\n")
+	configure_file("${manifest}.tmp" "${manifest}" COPYONLY)
+
+	add_custom_command(
+		OUTPUT ${outputs}
+		COMMAND autoshader --manifest "${manifest}" ${arg_EXTRA}
+		DEPENDS ${depends} "${manifest}" autoshader
+		VERBATIM
+		)
+	set(all "")
+	if(arg_ALL)
+		set(all ALL)
+	endif()
+	add_custom_target(${name} ${all} DEPENDS ${outputs})
+endfunction()
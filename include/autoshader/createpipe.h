@@ -8,15 +8,214 @@
 #define H_AUTOSHADER_CREATEPIPE
 
 #include "anyarg.h"
+#include "spirvpack.h"
 #include "vulkan/vulkan.hpp"
+#include <tuple>
+#include <type_traits>
+
+//-- the pipelines use vulkan 1.3 structures and commands (creation feedback, dynamic rendering,
+//-- subgroup size control and extended dynamic state). the extensions beyond it are used when
+//-- the headers declare them.
+#ifndef VK_VERSION_1_3
+#error "autoshader needs the vulkan 1.3 headers or later"
+#endif
+
+//-- the extension commands aren't exported by the loader, so the functions that call them need
+//-- the dynamic dispatcher (VULKAN_HPP_DISPATCH_LOADER_DYNAMIC=1, with
+//-- VULKAN_HPP_DEFAULT_DISPATCHER initialized for the instance and device). define this to 1
+//-- when the default dispatcher is replaced with another that loads them.
+#ifndef AUTOSHADER_EXTENSION_DISPATCH
+#define AUTOSHADER_EXTENSION_DISPATCH VULKAN_HPP_DISPATCH_LOADER_DYNAMIC
+#endif
 
 namespace autoshader {
 
+	//-- a static_assert condition that only fails where a template calling the extension
+	//-- commands is instantiated
+	template <typename... T>
+	constexpr bool extension_dispatch() { return AUTOSHADER_EXTENSION_DISPATCH != 0; }
+
+	//----------------------------------------------------------------------------------------
+	//-- FailIfUncached - an argument that makes creation return a null pipeline instead of
+	//-- compiling one that isn't in the cache. the device needs pipelineCreationCacheControl
+	//-- (VK_EXT_pipeline_creation_cache_control or vulkan 1.3) enabled.
+
+	struct FailIfUncached {};
+
+	//----------------------------------------------------------------------------------------
+	//-- BasePipeline - an argument that makes the pipeline a derivative of a parent, given by
+	//-- its handle or by its index in a createPipes batch. a null handle and negative index
+	//-- create a pipeline that isn't derived. the parent must be created with the
+	//-- AllowDerivatives argument or vk::PipelineCreateFlagBits::eAllowDerivatives.
+
+	struct BasePipeline {
+		BasePipeline(vk::Pipeline p) : handle(p) {}
+		explicit BasePipeline(int32_t i) : index(i) {}
+
+		bool derived() const { return handle != vk::Pipeline() || index >= 0; }
+
+		vk::Pipeline handle;
+		int32_t index = -1;
+	};
+
+	struct AllowDerivatives {};
+
+	//----------------------------------------------------------------------------------------
+	//-- CreationFeedback - an argument, passed by pointer, filled with how long the pipeline
+	//-- and each of its stages took to create and whether they were found in the cache
+	//-- (vulkan 1.3 or VK_EXT_pipeline_creation_feedback). with captureStatistics set the
+	//-- pipeline is created so its executable statistics can be read, which needs
+	//-- pipelineExecutableInfo (VK_KHR_pipeline_executable_properties) enabled.
+
+	struct CreationFeedback {
+		static constexpr size_t maxStages = 8;
+
+		vk::PipelineCreationFeedback pipeline;
+		std::array<vk::PipelineCreationFeedback, maxStages> stages;
+		std::array<vk::ShaderStageFlagBits, maxStages> stageFlags;
+		uint32_t stageCount = 0;
+		bool captureStatistics = false;
+	};
+
+	template <typename... A>
+	CreationFeedback *getCreationFeedback(A &&...a) {
+		return anyarg::Arg<CreationFeedback*>::dget(nullptr, std::forward<A>(a)...);
+	}
+
+	//-- point a create info at the feedback for its stages
+	inline const void *chainFeedback(vk::PipelineCreationFeedbackCreateInfo &info,
+			CreationFeedback *f, const vk::PipelineShaderStageCreateInfo *stages, uint32_t count) {
+		if (f == nullptr)
+			return nullptr;
+		assert(count <= f->stages.size());
+		f->stageCount = count;
+		for (uint32_t i = 0; i < count; ++i)
+			f->stageFlags[i] = stages[i].stage;
+		info = vk::PipelineCreationFeedbackCreateInfo{ &f->pipeline, count, f->stages.data() };
+		return &info;
+	}
+
+	template <typename... A>
+	BasePipeline getBasePipeline(A &&...a) {
+		return anyarg::Arg<BasePipeline>::dget(BasePipeline(vk::Pipeline()), std::forward<A>(a)...);
+	}
+
+	template <typename... A>
+	vk::PipelineCreateFlags getCreateFlags(A &&...a) {
+		using anyarg::Arg;
+		auto flags = Arg<vk::PipelineCreateFlags>::dget(
+			Arg<vk::PipelineCreateFlagBits>::dget({}, std::forward<A>(a)...),
+			std::forward<A>(a)...);
+		if (Arg<FailIfUncached>::contains<A...>())
+			flags |= vk::PipelineCreateFlagBits::eFailOnPipelineCompileRequired;
+		if (Arg<AllowDerivatives>::contains<A...>())
+			flags |= vk::PipelineCreateFlagBits::eAllowDerivatives;
+		if (getBasePipeline(std::forward<A>(a)...).derived())
+			flags |= vk::PipelineCreateFlagBits::eDerivative;
+#ifdef VK_KHR_pipeline_executable_properties
+		auto feedback = getCreationFeedback(std::forward<A>(a)...);
+		if (feedback != nullptr && feedback->captureStatistics)
+			flags |= vk::PipelineCreateFlagBits::eCaptureStatisticsKHR;
+#endif
+		return flags;
+	}
+
+	//----------------------------------------------------------------------------------------
+	//-- DynamicStates - an argument that leaves groups of state out of a graphics pipeline, to
+	//-- be set on the command buffer with setDynamicState. the state left out is created the
+	//-- same in every pipeline, so pipelines that differ only in it share a cache entry and a
+	//-- PipelineVariants key. the groups are a template parameter, so only the commands of the
+	//-- groups used are referenced. the device needs each group enabled.
+	//--   Extended: viewport and scissor with count, cull mode, front face, primitive topology
+	//--     (within its class), depth test, write and compare. vulkan 1.3 or
+	//--     VK_EXT_extended_dynamic_state
+	//--   Extended2: primitive restart, rasterizer discard and depth bias enable. vulkan 1.3 or
+	//--     VK_EXT_extended_dynamic_state2
+	//--   Extended3: polygon mode, color blend enable, equation and write mask.
+	//--     VK_EXT_extended_dynamic_state3 with those features
+	//--   VertexInput: the vertex bindings and attributes. VK_EXT_vertex_input_dynamic_state
+	//-- setting Extended3 or VertexInput calls extension commands (AUTOSHADER_EXTENSION_DISPATCH).
+	//-- All is the groups whose extensions are declared by the vulkan headers.
+
+	struct DynamicGroup {
+		enum Bits : uint32_t {
+			Extended = 1,
+			Extended2 = 2,
+			Extended3 = 4,
+			VertexInput = 8,
+			All = Extended | Extended2
+#ifdef VK_EXT_extended_dynamic_state3
+				| Extended3
+#endif
+#ifdef VK_EXT_vertex_input_dynamic_state
+				| VertexInput
+#endif
+		};
+	};
+
+	template <uint32_t Groups = DynamicGroup::All>
+	struct DynamicStates {
+		static constexpr uint32_t groups = Groups;
+	};
+
+	template <typename T> struct DynamicGroupsOf {
+		static constexpr bool present = false;
+		static constexpr uint32_t value = 0;
+	};
+
+	template <uint32_t G> struct DynamicGroupsOf<DynamicStates<G>> {
+		static constexpr bool present = true;
+		static constexpr uint32_t value = G;
+	};
+
+	//-- whether an argument pack has a DynamicStates, and the groups it leaves out
+	template <typename... A>
+	constexpr bool has_dynamic_states() {
+		bool p[] = { false, DynamicGroupsOf<std::decay_t<A>>::present... };
+		for (size_t i = 0; i < sizeof(p) / sizeof(p[0]); ++i) {
+			if (p[i])
+				return true;
+		}
+		return false;
+	}
+
+	template <typename... A>
+	constexpr uint32_t dynamic_groups() {
+		uint32_t g[] = { 0u, DynamicGroupsOf<std::decay_t<A>>::value... };
+		uint32_t r = 0;
+		for (size_t i = 0; i < sizeof(g) / sizeof(g[0]); ++i)
+			r |= g[i];
+		return r;
+	}
+
+	//----------------------------------------------------------------------------------------
+	//-- topologyClass - the topology a pipeline is created with when the topology is dynamic.
+	//-- only a topology of the same class can be set, so there is one for each class.
+
+	inline vk::PrimitiveTopology topologyClass(vk::PrimitiveTopology t) {
+		switch (t) {
+			case vk::PrimitiveTopology::ePointList:
+				return vk::PrimitiveTopology::ePointList;
+			case vk::PrimitiveTopology::eLineList:
+			case vk::PrimitiveTopology::eLineStrip:
+			case vk::PrimitiveTopology::eLineListWithAdjacency:
+			case vk::PrimitiveTopology::eLineStripWithAdjacency:
+				return vk::PrimitiveTopology::eLineList;
+			case vk::PrimitiveTopology::ePatchList:
+				return vk::PrimitiveTopology::ePatchList;
+			default:
+				return vk::PrimitiveTopology::eTriangleList;
+		}
+	}
+
 	//----------------------------------------------------------------------------------------
 	//-- createComputePipe - create a compute pipeline
 	//--   required: vk::Device, vk::PipelineLayout
 	//--     also one of vk::PipelineShaderStageCreateInfo or vk::ShaderModule
-	//--   options vk::PipelineCreateFlags, vk::PipelineCache
+	//--   options vk::PipelineCreateFlags, vk::PipelineCache, FailIfUncached, BasePipeline,
+	//--     AllowDerivatives, CreationFeedback*,
+	//--     vk::PipelineShaderStageRequiredSubgroupSizeCreateInfo (see requiredSubgroupSize),
+	//--     vk::PipelineShaderStageCreateFlags such as eRequireFullSubgroups
 
 	template <typename... A>
 	vk::SpecializationInfo *getSpecialization(vk::ShaderStageFlags stage, A &&...a) {
@@ -31,8 +230,38 @@ namespace autoshader {
 		return Arg<vk::SpecializationInfo>::pget(std::forward<A>(a)...);
 	}
 
+	//----------------------------------------------------------------------------------------
+	//-- requiredSubgroupSize - the subgroup size to require of a stage: the preferred size if
+	//-- the device can run the stage with it (vulkan 1.3 subgroupSizeControl), otherwise zero,
+	//-- which createComputePipe leaves to the driver
+
+	inline vk::PipelineShaderStageRequiredSubgroupSizeCreateInfo requiredSubgroupSize(
+			vk::PhysicalDevice phys, uint32_t preferred,
+			vk::ShaderStageFlagBits stage = vk::ShaderStageFlagBits::eCompute) {
+		auto props = phys.getProperties2<vk::PhysicalDeviceProperties2,
+			vk::PhysicalDeviceSubgroupSizeControlProperties>();
+		auto &sub = props.get<vk::PhysicalDeviceSubgroupSizeControlProperties>();
+		bool supported = preferred != 0 && (preferred & (preferred - 1)) == 0 &&
+			preferred >= sub.minSubgroupSize && preferred <= sub.maxSubgroupSize &&
+			(sub.requiredSubgroupSizeStages & stage);
+		return vk::PipelineShaderStageRequiredSubgroupSizeCreateInfo{ supported ? preferred : 0 };
+	}
+
+	//----------------------------------------------------------------------------------------
+	//-- ComputePipeState - the create info of a compute pipeline and the state it points to.
+	//-- it is filled in place and can't be moved once filled.
+
+	struct ComputePipeState {
+		std::string entry;
+		vk::PipelineShaderStageRequiredSubgroupSizeCreateInfo subgroup;
+		vk::PipelineCreationFeedbackCreateInfo feedback;
+		vk::ComputePipelineCreateInfo info;
+		vk::PipelineCache cache;
+		vk::Device device;
+	};
+
 	template <typename... A>
-	vk::UniquePipeline createComputePipe(A &&...a) {
+	void fillComputePipe(ComputePipeState &s, A &&...a) {
 		using anyarg::Arg;
 		// You have to pass in this stuff
 		static_assert(Arg<vk::Device>::contains<A...>(),
@@ -44,35 +273,57 @@ namespace autoshader {
 			"need a stage or shader module for a compute pipeline");
 
 		// flags
-		auto flags = Arg<vk::PipelineCreateFlags>::dget(
-			Arg<vk::PipelineCreateFlagBits>::dget({}, std::forward<A>(a)...),
-			std::forward<A>(a)...);
+		auto flags = getCreateFlags(std::forward<A>(a)...);
 
 	 	// check for shader module and entry name
 		auto module = Arg<vk::ShaderModule>::dget({}, std::forward<A>(a)...);
-		auto entry = Arg<std::string>::dget(Arg<const char*>::dget("main",
+		s.entry = Arg<std::string>::dget(Arg<const char*>::dget("main",
 			std::forward<A>(a)...), std::forward<A>(a)...);
 
 		// get the compute stage
 		auto stage = Arg<vk::PipelineShaderStageCreateInfo>::dget({ {},
-			vk::ShaderStageFlagBits::eCompute, module, entry.c_str() },
+			vk::ShaderStageFlagBits::eCompute, module, s.entry.c_str() },
 			std::forward<A>(a)...);
 
 		// look for specialization constants
 		if (stage.pSpecializationInfo == nullptr)
 			stage.pSpecializationInfo = getSpecialization(stage.stage, std::forward<A>(a)...);
 
+		// optional subgroup size and the stage flags that control it
+		stage.flags |= Arg<vk::PipelineShaderStageCreateFlags>::dget(
+			Arg<vk::PipelineShaderStageCreateFlagBits>::dget({}, std::forward<A>(a)...),
+			std::forward<A>(a)...);
+		auto subgroup = Arg<vk::PipelineShaderStageRequiredSubgroupSizeCreateInfo>::pget(
+			std::forward<A>(a)...);
+		if (subgroup != nullptr && subgroup->requiredSubgroupSize != 0) {
+			s.subgroup = *subgroup;
+			s.subgroup.pNext = const_cast<void*>(stage.pNext);
+			stage.pNext = &s.subgroup;
+		}
+
 		// pipeline layout
 		auto layout = Arg<vk::PipelineLayout>::get(std::forward<A>(a)...);
 
 		// optional cache
-		auto cache = Arg<vk::PipelineCache>::dget(vk::PipelineCache{}, std::forward<A>(a)...);
+		s.cache = Arg<vk::PipelineCache>::dget(vk::PipelineCache{}, std::forward<A>(a)...);
 
 		// device to create pipeline
-		auto dev = Arg<vk::Device>::get(std::forward<A>(a)...);
-		assert(dev != vk::Device{});
+		s.device = Arg<vk::Device>::get(std::forward<A>(a)...);
+		assert(s.device != vk::Device{});
 
-		return dev.createComputePipelineUnique(cache, { flags, stage, layout }).value;
+		s.info = vk::ComputePipelineCreateInfo{ flags, stage, layout };
+		s.info.pNext = chainFeedback(s.feedback, getCreationFeedback(std::forward<A>(a)...),
+			&s.info.stage, 1);
+		auto base = getBasePipeline(std::forward<A>(a)...);
+		s.info.basePipelineHandle = base.handle;
+		s.info.basePipelineIndex = base.index;
+	}
+
+	template <typename... A>
+	vk::UniquePipeline createComputePipe(A &&...a) {
+		ComputePipeState s;
+		fillComputePipe(s, std::forward<A>(a)...);
+		return s.device.createComputePipelineUnique(s.cache, s.info).value;
 	}
 
 	struct SubPass {
@@ -81,77 +332,118 @@ namespace autoshader {
 		int value;
 	};
 
-
 	//----------------------------------------------------------------------------------------
-	//-- createGraphicsPipe - create a compute pipeline
+	//-- ColorAttachmentCount - the number of default blend attachments when none are passed,
+	//-- one unless the pipeline is for dynamic rendering, where it is the color attachment
+	//-- count of the vk::PipelineRenderingCreateInfo. the generated Components pass the color
+	//-- outputs of their fragment shader.
+
+	struct ColorAttachmentCount {
+		ColorAttachmentCount(uint32_t v = 1) : value(v) {}
+		operator uint32_t () const { return value; }
+		uint32_t value;
+	};
 
 	template <typename... A>
-	vk::UniquePipeline createGraphicsPipe(A &&...a) {
+	uint32_t getColorAttachmentCount(A &&...a) {
 		using anyarg::Arg;
-		// You have to pass in this stuff
-		static_assert(Arg<vk::Device>::contains<A...>(),
-			"createGraphicsPipe needs a vk::Device argument");
-		static_assert(Arg<vk::PipelineLayout>::contains<A...>(),
-			"createGraphicsPipe needs a vk::PipelineLayout argument");
-		static_assert(Arg<vk::RenderPass>::contains<A...>(),
-			"createGraphicsPipe needs a vk::RenderPass argument");
+		auto r = Arg<vk::PipelineRenderingCreateInfo>::pget(std::forward<A>(a)...);
+		if (r != nullptr)
+			return r->colorAttachmentCount;
+		return Arg<ColorAttachmentCount>::dget(1, std::forward<A>(a)...);
+	}
 
-		// get the flags and stages
-		auto flags = Arg<vk::PipelineCreateFlags>::dget(
-			Arg<vk::PipelineCreateFlagBits>::dget({}, std::forward<A>(a)...),
-			std::forward<A>(a)...);
-		auto stages = Arg<vk::PipelineShaderStageCreateInfo>::gather(std::forward<A>(a)...);
-		static_assert(stages.size() > 1, "need at least two stages for a graphics pipeline");
 
-		// look for specialization constants
-		for (auto &stage : stages) {
-			if (stage.pSpecializationInfo == nullptr)
-				stage.pSpecializationInfo = getSpecialization(stage.stage, std::forward<A>(a)...);
-		}
+	//----------------------------------------------------------------------------------------
+	//-- GraphicsPipeState - the create info of a graphics pipeline and the state it points to,
+	//-- sized for the stages, vertex input and blend attachments of an argument pack. it is
+	//-- filled in place and can't be moved once filled.
+
+	template <size_t Stages, size_t Bindings, size_t Attributes, size_t Blends>
+	struct GraphicsPipeState {
+		static constexpr size_t maxColorAttachments = 8;
+
+		std::array<vk::PipelineShaderStageCreateInfo, Stages> stages;
+		std::array<vk::VertexInputBindingDescription, Bindings> bindings;
+		std::array<vk::VertexInputAttributeDescription, Attributes> attributes;
+		vk::PipelineVertexInputStateCreateInfo vis;
+		vk::PipelineInputAssemblyStateCreateInfo ass;
+		vk::Rect2D scissor;
+		vk::Viewport viewport;
+		vk::PipelineViewportStateCreateInfo vps;
+		vk::PipelineRasterizationStateCreateInfo ras;
+		vk::PipelineMultisampleStateCreateInfo mul;
+		vk::PipelineDepthStencilStateCreateInfo dep;
+		std::array<vk::PipelineColorBlendAttachmentState, Blends> blends;
+		std::array<vk::PipelineColorBlendAttachmentState, maxColorAttachments> defaultBlends;
+		vk::PipelineColorBlendStateCreateInfo col;
+		std::array<vk::DynamicState, 32> dynamics;
+		vk::PipelineDynamicStateCreateInfo dyn;
+		vk::PipelineCreationFeedbackCreateInfo feedback;
+		vk::PipelineRenderingCreateInfo rendering;
+		vk::GraphicsPipelineCreateInfo info;
+		vk::PipelineCache cache;
+		vk::Device device;
+	};
+
+	template <typename... A>
+	using GraphicsPipeStateFor = GraphicsPipeState<
+		anyarg::Arg<vk::PipelineShaderStageCreateInfo>::count<A...>::value,
+		anyarg::Arg<vk::VertexInputBindingDescription>::count<A...>::value,
+		anyarg::Arg<vk::VertexInputAttributeDescription>::count<A...>::value,
+		anyarg::Arg<vk::PipelineColorBlendAttachmentState>::count<A...>::value>;
 
+	template <typename... A>
+	constexpr bool has_viewport() {
+		using anyarg::Arg;
+		return Arg<vk::Rect2D>::contains<A...>() ||
+			Arg<vk::Extent2D>::contains<A...>() ||
+			Arg<vk::Viewport>::contains<A...>() ||
+			Arg<vk::PipelineViewportStateCreateInfo>::contains<A...>();
+	}
+
+	//----------------------------------------------------------------------------------------
+	//-- fillFixedState - the vertex input and fixed function state of a graphics pipeline,
+	//-- shared by fillGraphicsPipe and setDynamicState so both resolve the same defaults
+
+	template <typename S, typename... A>
+	void fillFixedState(S &s, A &&...a) {
+		using anyarg::Arg;
 		// gather any bindings and attributes passed by the user.
-		auto bin = Arg<vk::VertexInputBindingDescription>::gather(std::forward<A>(a)...);
-		auto att = Arg<vk::VertexInputAttributeDescription>::gather(std::forward<A>(a)...);
+		s.bindings = Arg<vk::VertexInputBindingDescription>::gather(std::forward<A>(a)...);
+		s.attributes = Arg<vk::VertexInputAttributeDescription>::gather(std::forward<A>(a)...);
 
 		// grab the vertex input from the args or from the bindings and attrs.
-		auto vis = Arg<vk::PipelineVertexInputStateCreateInfo>::dget(
-			{ {}, uint32_t(bin.size()), bin.data(), uint32_t(att.size()), att.data() },
+		s.vis = Arg<vk::PipelineVertexInputStateCreateInfo>::dget(
+			{ {}, uint32_t(s.bindings.size()), s.bindings.data(), uint32_t(s.attributes.size()),
+				s.attributes.data() },
 			std::forward<A>(a)...);
 
 		// get the input assembly
 		auto topology = Arg<vk::PrimitiveTopology>::dget(vk::PrimitiveTopology::eTriangleStrip,
 			std::forward<A>(a)...);
-		auto ass = Arg<vk::PipelineInputAssemblyStateCreateInfo>::dget(
+		s.ass = Arg<vk::PipelineInputAssemblyStateCreateInfo>::dget(
 			{ {}, topology, false }, std::forward<A>(a)...);
 
-		// optional tessellation state
-		auto ptes = Arg<vk::PipelineTessellationStateCreateInfo>::pget(std::forward<A>(a)...);
-
 		// scissor and viewport
-		vk::Rect2D scissor;
-		vk::Viewport viewport;
-		constexpr bool withviewport = Arg<vk::Rect2D>::contains<A...>() ||
-			Arg<vk::Extent2D>::contains<A...>() ||
-			Arg<vk::Viewport>::contains<A...>() ||
-			Arg<vk::PipelineViewportStateCreateInfo>::contains<A...>();
-		if (withviewport) {
+		if (has_viewport<A...>()) {
 			// default the viewport from the scissor or vice-versa
-			auto ext = Arg<vk::Extent2D>::dget(scissor.extent, std::forward<A>(a)...);
-			scissor = Arg<vk::Rect2D>::dget(vk::Rect2D({}, ext), std::forward<A>(a)...);
-			viewport = Arg<vk::Viewport>::dget({
-				float(scissor.offset.x), float(scissor.offset.y),
-				float(scissor.extent.width), float(scissor.extent.height), 0, 1 },
+			auto ext = Arg<vk::Extent2D>::dget(s.scissor.extent, std::forward<A>(a)...);
+			s.scissor = Arg<vk::Rect2D>::dget(vk::Rect2D({}, ext), std::forward<A>(a)...);
+			s.viewport = Arg<vk::Viewport>::dget({
+				float(s.scissor.offset.x), float(s.scissor.offset.y),
+				float(s.scissor.extent.width), float(s.scissor.extent.height), 0, 1 },
 				std::forward<A>(a)...);
-			scissor = Arg<vk::Rect2D>::dget(vk::Rect2D(
-				{ int32_t(viewport.x), int32_t(viewport.y) },
-				{ uint32_t(viewport.width), uint32_t(viewport.height) }),
+			s.scissor = Arg<vk::Rect2D>::dget(vk::Rect2D(
+				{ int32_t(s.viewport.x), int32_t(s.viewport.y) },
+				{ uint32_t(s.viewport.width), uint32_t(s.viewport.height) }),
 				std::forward<A>(a)...);
 		}
-		auto vps = Arg<vk::PipelineViewportStateCreateInfo>::dget({ {},
-			1, &viewport, 1, &scissor }, std::forward<A>(a)...);
+		s.vps = Arg<vk::PipelineViewportStateCreateInfo>::dget({ {},
+			1, &s.viewport, 1, &s.scissor }, std::forward<A>(a)...);
 
 		// resterization state
-		auto ras = Arg<vk::PipelineRasterizationStateCreateInfo>::dget({ {}, false, false,
+		s.ras = Arg<vk::PipelineRasterizationStateCreateInfo>::dget({ {}, false, false,
 			Arg<vk::PolygonMode>::dget(vk::PolygonMode::eFill, std::forward<A>(a)...),
 			Arg<vk::CullModeFlags>::dget(
 				Arg<vk::CullModeFlagBits>::dget(vk::CullModeFlagBits::eNone,
@@ -161,48 +453,566 @@ namespace autoshader {
 			0, 0, 0, 0, 1 }, std::forward<A>(a)...);
 
 		// multi-sampling
-		auto mul = Arg<vk::PipelineMultisampleStateCreateInfo>::dget({ {},
+		s.mul = Arg<vk::PipelineMultisampleStateCreateInfo>::dget({ {},
 			Arg<vk::SampleCountFlagBits>::dget(vk::SampleCountFlagBits::e1,
 				std::forward<A>(a)...)
 			}, std::forward<A>(a)...);
 
 		// depth test
-		auto dep = Arg<vk::PipelineDepthStencilStateCreateInfo>::dget({ {}, true, true,
+		s.dep = Arg<vk::PipelineDepthStencilStateCreateInfo>::dget({ {}, true, true,
 			Arg<vk::CompareOp>::dget(vk::CompareOp::eLess, std::forward<A>(a)...) },
 			std::forward<A>(a)...);
 
-		// color blending
-		auto cba = Arg<vk::PipelineColorBlendAttachmentState>::gather(std::forward<A>(a)...);
-		vk::PipelineColorBlendAttachmentState dcba{
+		// color blending, the default for each color attachment unless blends are passed
+		s.blends = Arg<vk::PipelineColorBlendAttachmentState>::gather(std::forward<A>(a)...);
+		auto blends = uint32_t(s.blends.size());
+		if (blends == 0) {
+			blends = getColorAttachmentCount(std::forward<A>(a)...);
+			assert(blends <= s.defaultBlends.size());
+		}
+		s.defaultBlends.fill(vk::PipelineColorBlendAttachmentState{
 			true, vk::BlendFactor::eSrcAlpha, vk::BlendFactor::eOneMinusSrcAlpha,
 			vk::BlendOp::eAdd, vk::BlendFactor::eOne,
 			vk::BlendFactor::eZero, vk::BlendOp::eAdd,
 			vk::ColorComponentFlagBits::eR | vk::ColorComponentFlagBits::eG
 				| vk::ColorComponentFlagBits::eB | vk::ColorComponentFlagBits::eA
+		});
+		s.col = Arg<vk::PipelineColorBlendStateCreateInfo>::dget({ {}, false,
+			vk::LogicOp::eClear, blends,
+			s.blends.empty() ? s.defaultBlends.data() : s.blends.data() }, std::forward<A>(a)...);
+	}
+
+	//----------------------------------------------------------------------------------------
+	//-- leave the dynamic groups out of the pipeline state, setting what they replace to the
+	//-- same values in every pipeline, and add them to the dynamic states
+
+	template <typename S>
+	void fillDynamicStates(S &s, uint32_t groups, const vk::PipelineDynamicStateCreateInfo *pdyn) {
+		uint32_t n = 0;
+		auto add = [&s, &n] (vk::DynamicState x) {
+			for (uint32_t i = 0; i < n; ++i) {
+				if (s.dynamics[i] == x)
+					return;
+			}
+			assert(n < s.dynamics.size());
+			s.dynamics[n++] = x;
 		};
-		auto col = Arg<vk::PipelineColorBlendStateCreateInfo>::dget({ {}, false,
-			vk::LogicOp::eClear, cba.empty() ? 1 : cba.size(),
-			cba.empty() ? &dcba : cba.data() }, std::forward<A>(a)...);
+		if (pdyn != nullptr) {
+			for (uint32_t i = 0; i < pdyn->dynamicStateCount; ++i)
+				add(pdyn->pDynamicStates[i]);
+		}
+
+		if (groups & DynamicGroup::Extended) {
+			s.vps = vk::PipelineViewportStateCreateInfo{};
+			s.ass.topology = topologyClass(s.ass.topology);
+			s.ras.cullMode = vk::CullModeFlagBits::eNone;
+			s.ras.frontFace = vk::FrontFace::eCounterClockwise;
+			s.dep.depthTestEnable = false;
+			s.dep.depthWriteEnable = false;
+			s.dep.depthCompareOp = vk::CompareOp::eNever;
+			add(vk::DynamicState::eViewportWithCount);
+			add(vk::DynamicState::eScissorWithCount);
+			add(vk::DynamicState::ePrimitiveTopology);
+			add(vk::DynamicState::eCullMode);
+			add(vk::DynamicState::eFrontFace);
+			add(vk::DynamicState::eDepthTestEnable);
+			add(vk::DynamicState::eDepthWriteEnable);
+			add(vk::DynamicState::eDepthCompareOp);
+		}
+		if (groups & DynamicGroup::Extended2) {
+			s.ass.primitiveRestartEnable = false;
+			s.ras.rasterizerDiscardEnable = false;
+			s.ras.depthBiasEnable = false;
+			add(vk::DynamicState::ePrimitiveRestartEnable);
+			add(vk::DynamicState::eRasterizerDiscardEnable);
+			add(vk::DynamicState::eDepthBiasEnable);
+		}
+#ifdef VK_EXT_extended_dynamic_state3
+		if (groups & DynamicGroup::Extended3) {
+			// blend state passed in a vk::PipelineColorBlendStateCreateInfo isn't ours to change
+			s.ras.polygonMode = vk::PolygonMode::eFill;
+			for (auto &b : s.blends)
+				b = vk::PipelineColorBlendAttachmentState{};
+			s.defaultBlends.fill(vk::PipelineColorBlendAttachmentState{});
+			add(vk::DynamicState::ePolygonModeEXT);
+			add(vk::DynamicState::eColorBlendEnableEXT);
+			add(vk::DynamicState::eColorBlendEquationEXT);
+			add(vk::DynamicState::eColorWriteMaskEXT);
+		}
+#endif
+#ifdef VK_EXT_vertex_input_dynamic_state
+		if (groups & DynamicGroup::VertexInput)
+			add(vk::DynamicState::eVertexInputEXT);
+#endif
+
+		s.dyn = vk::PipelineDynamicStateCreateInfo{ pdyn != nullptr ? pdyn->flags :
+			vk::PipelineDynamicStateCreateFlags(), n, s.dynamics.data() };
+		s.dyn.pNext = pdyn != nullptr ? pdyn->pNext : nullptr;
+	}
+
+	template <typename S, typename... A>
+	void fillGraphicsPipe(S &s, A &&...a) {
+		using anyarg::Arg;
+		// You have to pass in this stuff
+		static_assert(Arg<vk::Device>::contains<A...>(),
+			"createGraphicsPipe needs a vk::Device argument");
+		static_assert(Arg<vk::PipelineLayout>::contains<A...>(),
+			"createGraphicsPipe needs a vk::PipelineLayout argument");
+		static_assert(Arg<vk::RenderPass>::contains<A...>() ||
+			Arg<vk::PipelineRenderingCreateInfo>::contains<A...>(),
+			"createGraphicsPipe needs a vk::RenderPass or vk::PipelineRenderingCreateInfo argument");
+
+		// get the flags and stages
+		auto flags = getCreateFlags(std::forward<A>(a)...);
+		s.stages = Arg<vk::PipelineShaderStageCreateInfo>::gather(std::forward<A>(a)...);
+		static_assert(Arg<vk::PipelineShaderStageCreateInfo>::count<A...>::value > 1,
+			"need at least two stages for a graphics pipeline");
+
+		// look for specialization constants
+		for (auto &stage : s.stages) {
+			if (stage.pSpecializationInfo == nullptr)
+				stage.pSpecializationInfo = getSpecialization(stage.stage, std::forward<A>(a)...);
+		}
 
-		// grab the optional dynamic state
+		fillFixedState(s, std::forward<A>(a)...);
+
+		// optional tessellation state
+		auto ptes = Arg<vk::PipelineTessellationStateCreateInfo>::pget(std::forward<A>(a)...);
+
+		// grab the optional dynamic state, adding the groups left out of the pipeline
 		auto pdyn = Arg<vk::PipelineDynamicStateCreateInfo>::pget(std::forward<A>(a)...);
+		constexpr auto dynamic = dynamic_groups<A...>();
+		static_assert((dynamic & ~uint32_t(DynamicGroup::All)) == 0,
+			"a DynamicStates group needs an extension the vulkan headers don't declare");
+		auto pvis = &s.vis;
+		if (dynamic != 0) {
+			fillDynamicStates(s, dynamic, pdyn);
+			pdyn = &s.dyn;
+			if (dynamic & DynamicGroup::VertexInput)
+				pvis = nullptr;
+		}
 
 		// pipeline layout
 		auto lay = Arg<vk::PipelineLayout>::get(std::forward<A>(a)...);
 
-		// render and subpass
-		auto pas = Arg<vk::RenderPass>::get(std::forward<A>(a)...);
+		// render and subpass, or the attachment formats for dynamic rendering
+		auto prend = Arg<vk::PipelineRenderingCreateInfo>::pget(std::forward<A>(a)...);
+		auto pas = Arg<vk::RenderPass>::dget(vk::RenderPass(), std::forward<A>(a)...);
 		auto sub = Arg<SubPass>::dget(0, std::forward<A>(a)...);
 
 		// optional cache
-		auto cache = Arg<vk::PipelineCache>::dget(vk::PipelineCache{}, std::forward<A>(a)...);
+		s.cache = Arg<vk::PipelineCache>::dget(vk::PipelineCache{}, std::forward<A>(a)...);
 
 		// device to create pipeline
-		auto dev = Arg<vk::Device>::get(std::forward<A>(a)...);
-		assert(dev != vk::Device{});
+		s.device = Arg<vk::Device>::get(std::forward<A>(a)...);
+		assert(s.device != vk::Device{});
+
+		s.info = vk::GraphicsPipelineCreateInfo{ flags, uint32_t(s.stages.size()), s.stages.data(),
+			pvis, &s.ass, ptes, &s.vps, &s.ras, &s.mul, &s.dep, &s.col, pdyn, lay, pas, sub };
+		s.info.pNext = chainFeedback(s.feedback, getCreationFeedback(std::forward<A>(a)...),
+			s.stages.data(), uint32_t(s.stages.size()));
+
+		// the rendering info is copied to the front of the chain, ahead of the feedback
+		if (prend != nullptr) {
+			s.rendering = *prend;
+			if (s.info.pNext != nullptr) {
+				s.feedback.pNext = s.rendering.pNext;
+				s.rendering.pNext = s.info.pNext;
+			}
+			s.info.pNext = &s.rendering;
+		}
+		auto base = getBasePipeline(std::forward<A>(a)...);
+		s.info.basePipelineHandle = base.handle;
+		s.info.basePipelineIndex = base.index;
+	}
+
+
+	//----------------------------------------------------------------------------------------
+	//-- createGraphicsPipe - create a graphics pipeline
+	//--   required: vk::Device, vk::PipelineLayout, vk::RenderPass or for dynamic rendering
+	//--     vk::PipelineRenderingCreateInfo, and at least two vk::PipelineShaderStageCreateInfo
+	//--   options DynamicStates, to set state on the command buffer with setDynamicState,
+	//--     CreationFeedback*
+
+	template <typename... A>
+	vk::UniquePipeline createGraphicsPipe(A &&...a) {
+		GraphicsPipeStateFor<A...> s;
+		fillGraphicsPipe(s, std::forward<A>(a)...);
+		return s.device.createGraphicsPipelineUnique(s.cache, s.info).value;
+	}
+
+
+#ifdef VK_EXT_vertex_input_dynamic_state
+
+	//----------------------------------------------------------------------------------------
+	//-- setVertexInput - set the vertex input of a pipeline created with
+	//-- DynamicGroup::VertexInput on the command buffer. calls an extension command
+	//-- (AUTOSHADER_EXTENSION_DISPATCH), so it is a template that is only checked where it's called.
+
+	template <typename... T>
+	void setVertexInput(vk::CommandBuffer cb, const vk::PipelineVertexInputStateCreateInfo &vis) {
+		static_assert(extension_dispatch<T...>(),
+			"setVertexInput calls an extension command, see AUTOSHADER_EXTENSION_DISPATCH");
+		std::array<vk::VertexInputBindingDescription2EXT, 32> bindings;
+		std::array<vk::VertexInputAttributeDescription2EXT, 32> attributes;
+		assert(vis.vertexBindingDescriptionCount <= bindings.size());
+		assert(vis.vertexAttributeDescriptionCount <= attributes.size());
+		for (uint32_t i = 0; i < vis.vertexBindingDescriptionCount; ++i) {
+			auto &b = vis.pVertexBindingDescriptions[i];
+			bindings[i] = vk::VertexInputBindingDescription2EXT{ b.binding, b.stride, b.inputRate, 1 };
+		}
+		for (uint32_t i = 0; i < vis.vertexAttributeDescriptionCount; ++i) {
+			auto &a = vis.pVertexAttributeDescriptions[i];
+			attributes[i] = vk::VertexInputAttributeDescription2EXT{ a.location, a.binding, a.format,
+				a.offset };
+		}
+		cb.setVertexInputEXT({ vis.vertexBindingDescriptionCount, bindings.data() },
+			{ vis.vertexAttributeDescriptionCount, attributes.data() });
+	}
+
+#endif // VK_EXT_vertex_input_dynamic_state
+
+	//----------------------------------------------------------------------------------------
+	//-- set each group of state on the command buffer, or nothing for a group that isn't
+	//-- dynamic, so its commands aren't referenced
+
+	template <uint32_t Groups, uint32_t G>
+	using DynamicGroupTag = std::integral_constant<bool, (Groups & G) != 0>;
+
+	template <typename S>
+	void setExtendedState(vk::CommandBuffer, const S&, bool, std::false_type) {}
+
+	template <typename S>
+	void setExtendedState(vk::CommandBuffer cb, const S &s, bool withviewport, std::true_type) {
+		if (withviewport) {
+			cb.setViewportWithCount({ s.vps.viewportCount, s.vps.pViewports });
+			cb.setScissorWithCount({ s.vps.scissorCount, s.vps.pScissors });
+		}
+		cb.setPrimitiveTopology(s.ass.topology);
+		cb.setCullMode(s.ras.cullMode);
+		cb.setFrontFace(s.ras.frontFace);
+		cb.setDepthTestEnable(s.dep.depthTestEnable);
+		cb.setDepthWriteEnable(s.dep.depthWriteEnable);
+		cb.setDepthCompareOp(s.dep.depthCompareOp);
+	}
+
+	template <typename S>
+	void setExtended2State(vk::CommandBuffer, const S&, std::false_type) {}
+
+	template <typename S>
+	void setExtended2State(vk::CommandBuffer cb, const S &s, std::true_type) {
+		cb.setPrimitiveRestartEnable(s.ass.primitiveRestartEnable);
+		cb.setRasterizerDiscardEnable(s.ras.rasterizerDiscardEnable);
+		cb.setDepthBiasEnable(s.ras.depthBiasEnable);
+	}
+
+	template <typename S>
+	void setExtended3State(vk::CommandBuffer, const S&, std::false_type) {}
+
+#ifdef VK_EXT_extended_dynamic_state3
+	template <typename S>
+	void setExtended3State(vk::CommandBuffer cb, const S &s, std::true_type) {
+		static_assert(extension_dispatch<S>(),
+			"DynamicGroup::Extended3 calls extension commands, see AUTOSHADER_EXTENSION_DISPATCH");
+		cb.setPolygonModeEXT(s.ras.polygonMode);
+		for (uint32_t i = 0; i < s.col.attachmentCount; ++i) {
+			auto &b = s.col.pAttachments[i];
+			cb.setColorBlendEnableEXT(i, b.blendEnable);
+			cb.setColorBlendEquationEXT(i, vk::ColorBlendEquationEXT{ b.srcColorBlendFactor,
+				b.dstColorBlendFactor, b.colorBlendOp, b.srcAlphaBlendFactor,
+				b.dstAlphaBlendFactor, b.alphaBlendOp });
+			cb.setColorWriteMaskEXT(i, b.colorWriteMask);
+		}
+	}
+#endif
+
+	template <typename S>
+	void setVertexInputState(vk::CommandBuffer, const S&, std::false_type) {}
+
+#ifdef VK_EXT_vertex_input_dynamic_state
+	template <typename S>
+	void setVertexInputState(vk::CommandBuffer cb, const S &s, std::true_type) {
+		setVertexInput<S>(cb, s.vis);
+	}
+#endif
+
+	template <uint32_t Groups, typename S>
+	void setFixedState(vk::CommandBuffer cb, const S &s, bool withviewport) {
+		static_assert((Groups & ~uint32_t(DynamicGroup::All)) == 0,
+			"a DynamicStates group needs an extension the vulkan headers don't declare");
+		setExtendedState(cb, s, withviewport, DynamicGroupTag<Groups, DynamicGroup::Extended>());
+		setExtended2State(cb, s, DynamicGroupTag<Groups, DynamicGroup::Extended2>());
+		setExtended3State(cb, s, DynamicGroupTag<Groups, DynamicGroup::Extended3>());
+		setVertexInputState(cb, s, DynamicGroupTag<Groups, DynamicGroup::VertexInput>());
+	}
+
+	//----------------------------------------------------------------------------------------
+	//-- setDynamicState - set the state a pipeline created with DynamicStates left out, from
+	//-- the same arguments and defaults as createGraphicsPipe. the viewport and scissor are
+	//-- only set when one is given.
+
+	template <typename... A>
+	void setDynamicState(vk::CommandBuffer cb, A &&...a) {
+		static_assert(has_dynamic_states<A...>(),
+			"setDynamicState needs a DynamicStates argument");
+		GraphicsPipeStateFor<A...> s;
+		fillFixedState(s, std::forward<A>(a)...);
+		setFixedState<dynamic_groups<A...>()>(cb, s, has_viewport<A...>());
+	}
+
+
+#ifdef VK_EXT_shader_object
+
+	//----------------------------------------------------------------------------------------
+	//-- StageCode - the spirv and entry point of one stage, for creating shader objects
+
+	struct StageCode {
+		vk::ShaderStageFlagBits stage;
+		const char *entry;
+		const uint32_t *code;
+		size_t size;
+	};
+
+	//----------------------------------------------------------------------------------------
+	//-- stageOrder - where a graphics stage runs in a pipeline, from 1, or 0 for compute. the
+	//-- stage bits aren't in pipeline order: mesh shaders come after fragment.
+	inline uint32_t stageOrder(vk::ShaderStageFlagBits stage) {
+		static const vk::ShaderStageFlagBits order[] = { vk::ShaderStageFlagBits::eVertex,
+			vk::ShaderStageFlagBits::eTessellationControl,
+			vk::ShaderStageFlagBits::eTessellationEvaluation, vk::ShaderStageFlagBits::eGeometry,
+			vk::ShaderStageFlagBits::eTaskEXT, vk::ShaderStageFlagBits::eMeshEXT,
+			vk::ShaderStageFlagBits::eFragment };
+		for (uint32_t i = 0; i < sizeof(order) / sizeof(order[0]); ++i)
+			if (order[i] == stage)
+				return i + 1;
+		return 0;
+	}
+
+	//----------------------------------------------------------------------------------------
+	//-- createShaders - create shader objects (VK_EXT_shader_object) from the stages of a
+	//-- program, linked when there is more than one, with the layouts a pipeline would use.
+	//-- like bindShaders it calls extension commands (AUTOSHADER_EXTENSION_DISPATCH).
+	//--   options vk::ShaderCreateFlagsEXT, vk::SpecializationInfo or a stage/spec pair
+
+	template <size_t N, size_t Sets, size_t Ranges, typename... A>
+	vk::Result createShaders(std::array<vk::ShaderEXT, N> &shaders, vk::Device device,
+			const std::array<StageCode, N> &stages,
+			const std::array<vk::DescriptorSetLayout, Sets> &sets,
+			const std::array<vk::PushConstantRange, Ranges> &ranges, A &&...a) {
+		using anyarg::Arg;
+		static_assert(extension_dispatch<A...>(),
+			"shader objects are created with extension commands, see AUTOSHADER_EXTENSION_DISPATCH");
+		auto flags = Arg<vk::ShaderCreateFlagsEXT>::dget({}, std::forward<A>(a)...);
+		if (N > 1)
+			flags |= vk::ShaderCreateFlagBitsEXT::eLinkStage;
+
+		std::array<vk::ShaderCreateInfoEXT, N> infos;
+		for (size_t i = 0; i < N; ++i) {
+			// linked stages name the stage that follows them in the pipeline
+			auto order = stageOrder(stages[i].stage);
+			size_t next = N;
+			for (size_t j = 0; j < N; ++j) {
+				auto o = stageOrder(stages[j].stage);
+				if (order != 0 && o > order && (next == N || o < stageOrder(stages[next].stage)))
+					next = j;
+			}
+			auto &info = infos[i];
+			info.flags = flags;
+			info.stage = stages[i].stage;
+			info.nextStage = next != N ? vk::ShaderStageFlags(stages[next].stage) :
+				vk::ShaderStageFlags();
+			info.codeType = vk::ShaderCodeTypeEXT::eSpirv;
+			info.codeSize = stages[i].size * sizeof(uint32_t);
+			info.pCode = stages[i].code;
+			info.pName = stages[i].entry;
+			info.setLayoutCount = uint32_t(sets.size());
+			info.pSetLayouts = sets.data();
+			info.pushConstantRangeCount = uint32_t(ranges.size());
+			info.pPushConstantRanges = ranges.data();
+			info.pSpecializationInfo = getSpecialization(stages[i].stage, std::forward<A>(a)...);
+		}
+		return device.createShadersEXT(uint32_t(infos.size()), infos.data(), nullptr,
+			shaders.data());
+	}
+
+	//----------------------------------------------------------------------------------------
+	//-- NullStages - an argument to bindShaders with the stages enabled on the device that
+	//-- the shaders don't have, such as tessellation and geometry, which are bound to null
+
+	struct NullStages {
+		vk::ShaderStageFlags stages;
+	};
+
+	//----------------------------------------------------------------------------------------
+	//-- bindShaders - bind shader objects and, for graphics, set all the state a pipeline
+	//-- would have held, from the same arguments and defaults as createGraphicsPipe. a
+	//-- viewport, scissor or extent should be given. state that needs a feature to be set
+	//-- (depth clamp, alpha to one, logic op) is left to the caller.
+
+	template <typename S>
+	void setShaderObjectState(vk::CommandBuffer cb, const S &s, bool withviewport) {
+		setFixedState<DynamicGroup::All>(cb, s, withviewport);
+		cb.setRasterizationSamplesEXT(s.mul.rasterizationSamples);
+		vk::SampleMask all = ~0u;
+		auto samples = uint32_t(s.mul.rasterizationSamples);
+		cb.setSampleMaskEXT(s.mul.rasterizationSamples, s.mul.pSampleMask != nullptr ?
+			vk::ArrayProxy<const vk::SampleMask>((samples + 31) / 32, s.mul.pSampleMask) :
+			vk::ArrayProxy<const vk::SampleMask>(all));
+		cb.setAlphaToCoverageEnableEXT(s.mul.alphaToCoverageEnable);
+		cb.setLineWidth(s.ras.lineWidth);
+		if (s.ras.depthBiasEnable)
+			cb.setDepthBias(s.ras.depthBiasConstantFactor, s.ras.depthBiasClamp,
+				s.ras.depthBiasSlopeFactor);
+		cb.setDepthBoundsTestEnable(s.dep.depthBoundsTestEnable);
+		if (s.dep.depthBoundsTestEnable)
+			cb.setDepthBounds(s.dep.minDepthBounds, s.dep.maxDepthBounds);
+		cb.setStencilTestEnable(s.dep.stencilTestEnable);
+		if (s.dep.stencilTestEnable) {
+			for (auto face : { vk::StencilFaceFlagBits::eFront, vk::StencilFaceFlagBits::eBack }) {
+				auto &o = face == vk::StencilFaceFlagBits::eFront ? s.dep.front : s.dep.back;
+				cb.setStencilOp(face, o.failOp, o.passOp, o.depthFailOp, o.compareOp);
+				cb.setStencilCompareMask(face, o.compareMask);
+				cb.setStencilWriteMask(face, o.writeMask);
+				cb.setStencilReference(face, o.reference);
+			}
+		}
+	}
+
+	template <size_t N, typename... A>
+	void bindShaders(vk::CommandBuffer cb, const std::array<vk::ShaderStageFlagBits, N> &stages,
+			const std::array<vk::ShaderEXT, N> &shaders, A &&...a) {
+		using anyarg::Arg;
+		static_assert(extension_dispatch<A...>(),
+			"shader objects are bound with extension commands, see AUTOSHADER_EXTENSION_DISPATCH");
+		cb.bindShadersEXT({ uint32_t(stages.size()), stages.data() },
+			{ uint32_t(shaders.size()), shaders.data() });
+		if (N == 1 && stages[0] == vk::ShaderStageFlagBits::eCompute)
+			return;
+
+		auto nulls = Arg<NullStages>::dget({}, std::forward<A>(a)...).stages;
+		for (auto b : { vk::ShaderStageFlagBits::eTessellationControl,
+				vk::ShaderStageFlagBits::eTessellationEvaluation,
+				vk::ShaderStageFlagBits::eGeometry, vk::ShaderStageFlagBits::eTaskEXT,
+				vk::ShaderStageFlagBits::eMeshEXT }) {
+			if (nulls & b)
+				cb.bindShadersEXT(b, vk::ShaderEXT());
+		}
+
+		GraphicsPipeStateFor<A...> s;
+		fillFixedState(s, std::forward<A>(a)...);
+		setShaderObjectState(cb, s, has_viewport<A...>());
+	}
+
+#endif // VK_EXT_shader_object
+
+
+	//----------------------------------------------------------------------------------------
+	//-- PipeResult - a pipeline created in a batch, with vk::Result::eSuccess or the error the
+	//-- batch returned if this pipeline wasn't created
+
+	struct PipeResult {
+		vk::Result result;
+		vk::UniquePipeline pipeline;
+	};
+
+	template <size_t N>
+	std::array<PipeResult, N> pipeResults(vk::Device dev, vk::Result r,
+			const std::array<vk::Pipeline, N> &pipes) {
+		std::array<PipeResult, N> results;
+		for (size_t i = 0; i < N; ++i) {
+			if (pipes[i] == vk::Pipeline()) {
+				results[i].result = r == vk::Result::eSuccess ? vk::Result::eErrorUnknown : r;
+				continue;
+			}
+			results[i].result = vk::Result::eSuccess;
+			results[i].pipeline = vk::UniquePipeline(pipes[i],
+				vk::ObjectDestroy<vk::Device, VULKAN_HPP_DEFAULT_DISPATCHER_TYPE>(dev));
+		}
+		return results;
+	}
+
+	template <typename T> struct GraphicsPipeStateOf;
+
+	template <typename... A>
+	struct GraphicsPipeStateOf<std::tuple<A...>> { typedef GraphicsPipeStateFor<A...> type; };
+
+	template <typename S, typename... A>
+	void fillPipe(S &s, A &&...a) { fillGraphicsPipe(s, std::forward<A>(a)...); }
+
+	template <typename... A>
+	void fillPipe(ComputePipeState &s, A &&...a) { fillComputePipe(s, std::forward<A>(a)...); }
+
+	template <typename S, typename T, size_t... I>
+	void fillPipeTuple(S &s, T &t, std::index_sequence<I...>) {
+		fillPipe(s, std::get<I>(t)...);
+	}
+
+	template <typename T>
+	using PackSequence = std::make_index_sequence<std::tuple_size<std::decay_t<T>>::value>;
+
+
+	//----------------------------------------------------------------------------------------
+	//-- createPipes - create graphics pipelines with one vkCreateGraphicsPipelines call, so
+	//-- the driver sees the whole batch. each argument is a tuple of the arguments for
+	//-- createGraphicsPipe (std::forward_as_tuple, or pipeArgs of the generated components).
+	//-- the create infos and the state they point to are kept in one arena on the stack.
+	//-- the batch uses the device and cache of the first pack. the pipelines come back in
+	//-- the order of the packs.
+
+	template <typename States, typename Packs, size_t... I>
+	void fillGraphicsPipes(States &s, Packs &p, std::index_sequence<I...>) {
+		int x[] = { 0, (fillPipeTuple(std::get<I>(s), std::get<I>(p),
+			PackSequence<std::tuple_element_t<I, Packs>>()), 0)... };
+		(void)x;
+	}
+
+	template <typename States, size_t... I>
+	auto graphicsPipeInfos(States &s, std::index_sequence<I...>) {
+		return std::array<vk::GraphicsPipelineCreateInfo, sizeof...(I)>{{ std::get<I>(s).info... }};
+	}
+
+	template <typename... P>
+	std::array<PipeResult, sizeof...(P)> createPipes(P &&...packs) {
+		static_assert(sizeof...(P) > 0, "createPipes needs at least one pipeline");
+		std::tuple<typename GraphicsPipeStateOf<std::decay_t<P>>::type...> states;
+		auto p = std::forward_as_tuple(std::forward<P>(packs)...);
+		fillGraphicsPipes(states, p, std::index_sequence_for<P...>());
+		auto infos = graphicsPipeInfos(states, std::index_sequence_for<P...>());
+
+		auto &first = std::get<0>(states);
+		std::array<vk::Pipeline, sizeof...(P)> pipes;
+		auto r = first.device.createGraphicsPipelines(first.cache, uint32_t(infos.size()),
+			infos.data(), nullptr, pipes.data());
+		return pipeResults(first.device, r, pipes);
+	}
+
+
+	//----------------------------------------------------------------------------------------
+	//-- createComputePipes - create compute pipelines with one vkCreateComputePipelines call,
+	//-- like createPipes
+
+	template <size_t N, typename Packs, size_t... I>
+	void fillComputePipes(std::array<ComputePipeState, N> &s, Packs &p, std::index_sequence<I...>) {
+		int x[] = { 0, (fillPipeTuple(s[I], std::get<I>(p),
+			PackSequence<std::tuple_element_t<I, Packs>>()), 0)... };
+		(void)x;
+	}
+
+	template <typename... P>
+	std::array<PipeResult, sizeof...(P)> createComputePipes(P &&...packs) {
+		static_assert(sizeof...(P) > 0, "createComputePipes needs at least one pipeline");
+		std::array<ComputePipeState, sizeof...(P)> states;
+		auto p = std::forward_as_tuple(std::forward<P>(packs)...);
+		fillComputePipes(states, p, std::index_sequence_for<P...>());
+		std::array<vk::ComputePipelineCreateInfo, sizeof...(P)> infos;
+		for (size_t i = 0; i < infos.size(); ++i)
+			infos[i] = states[i].info;
 
-		return dev.createGraphicsPipelineUnique(cache, { flags, stages.size(), stages.data(),
-			&vis, &ass, ptes, &vps, &ras, &mul, &dep, &col, pdyn, lay, pas, sub }).value;
+		auto &first = states[0];
+		std::array<vk::Pipeline, sizeof...(P)> pipes;
+		auto r = first.device.createComputePipelines(first.cache, uint32_t(infos.size()),
+			infos.data(), nullptr, pipes.data());
+		return pipeResults(first.device, r, pipes);
 	}
 
 
@@ -0,0 +1,199 @@
+//
+//  File: layoutrules.h
+//
+//  Created by Jon Spencer on 2026-10-17 01:11:48
+//  Copyright (c) Jon Spencer. See LICENSE file.
+//
+#ifndef H_AUTOSHADER_LAYOUTRULES_H__
+#define H_AUTOSHADER_LAYOUTRULES_H__
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace autoshader {
+
+	//----------------------------------------------------------------------------------------
+	//-- the rules the generator and the runtime reflection library both build the layouts
+	//-- with, so the generated and reflected layouts agree. a stage is one bit of a stage
+	//-- mask: the vk::ShaderStageFlagBits at runtime, 1 << execution model in the generator.
+
+	namespace layoutrules {
+
+		//------------------------------------------------------------------------------------
+		//-- DescriptorShape - what every stage declaring a binding must agree on. the count
+		//-- is the innermost array length, one for a single descriptor and zero for a
+		//-- runtime sized array.
+
+		struct DescriptorShape {
+			uint32_t type;
+			uint32_t dim;
+			uint32_t count;
+		};
+
+		enum struct DescriptorConflict {
+			None,
+			Type,
+			ImageDim,
+			ArraySize,
+		};
+
+		//-- the difference between two declarations of a binding, a declaration without one
+		//-- adds its stages to the binding
+		inline DescriptorConflict descriptorConflict(const DescriptorShape &a,
+				const DescriptorShape &b) {
+			if (a.type != b.type)
+				return DescriptorConflict::Type;
+			if (a.dim != b.dim)
+				return DescriptorConflict::ImageDim;
+			if (a.count != b.count)
+				return DescriptorConflict::ArraySize;
+			return DescriptorConflict::None;
+		}
+
+		//------------------------------------------------------------------------------------
+		//-- StageRange - a contiguous range of the push constants of one stage
+
+		struct StageRange {
+			uint32_t stage, start, end;
+		};
+
+		//-- PushBlockRanges - the contiguous ranges of a stage's push constant block, from
+		//-- its members in offset order. the last range is added by finish().
+		struct PushBlockRanges {
+			PushBlockRanges(std::vector<StageRange> &r, uint32_t s) : ranges(r), stage(s) {}
+
+			void member(uint32_t offset, uint32_t size) {
+				if (offset != end) {
+					if (end != 0)
+						ranges.push_back(StageRange{ stage, start, end });
+					start = offset;
+				}
+				end = offset + size;
+			}
+
+			void finish() {
+				if (end != 0)
+					ranges.push_back(StageRange{ stage, start, end });
+				start = end = 0;
+			}
+
+			std::vector<StageRange> &ranges;
+			uint32_t stage;
+			uint32_t start = 0, end = 0;
+		};
+
+		//-- arrayMemberSize - the size of an array member of a block: the length of the outermost
+		//-- array times the member's array stride, which is the stride of the outermost array.
+		//-- the inner arrays are part of the element, so a float a[2][3] is 2 * 12 bytes.
+		inline uint32_t arrayMemberSize(uint32_t outerLength, uint32_t arrayStride) {
+			return outerLength * arrayStride;
+		}
+
+		//-- splitPushRanges - split the ranges of all the stages, those of each stage
+		//-- together and in offset order, into ranges used by the same stages. f is called
+		//-- with the stage mask, start and end of each in offset order.
+		template <typename F>
+		void splitPushRanges(const std::vector<StageRange> &ranges, F &&f) {
+			// the first start or end at or after a spot, over the stages
+			auto next = [&ranges] (uint32_t at) {
+				uint32_t a = ~0u;
+				for (size_t i = 0; i < ranges.size();) {
+					auto stage = ranges[i].stage;
+					uint32_t s = ~0u;
+					for (; i < ranges.size() && ranges[i].stage == stage; ++i) {
+						if (s != ~0u)
+							continue;
+						if (ranges[i].start >= at)
+							s = ranges[i].start;
+						else if (ranges[i].end >= at)
+							s = ranges[i].end;
+					}
+					a = std::min(a, s);
+				}
+				return a;
+			};
+
+			for (uint32_t rangeStart = next(0); rangeStart != ~0u;) {
+				auto rangeEnd = next(rangeStart + 1);
+				if (rangeEnd == ~0u)
+					break;
+
+				// grab the stages active here
+				uint32_t stages = 0;
+				for (size_t i = 0; i < ranges.size();) {
+					auto stage = ranges[i].stage;
+					bool checked = false;
+					for (; i < ranges.size() && ranges[i].stage == stage; ++i) {
+						if (checked || ranges[i].end <= rangeStart)
+							continue;
+						if (ranges[i].start <= rangeStart)
+							stages |= stage;
+						checked = true;
+					}
+				}
+
+				if (stages != 0)
+					f(stages, rangeStart, rangeEnd);
+
+				rangeStart = rangeEnd;
+			}
+		}
+
+		//------------------------------------------------------------------------------------
+		//-- the format of a vertex attribute: one to four components of 32 or 64 bits
+
+		enum struct VertexComponent : uint32_t {
+			Uint,
+			Sint,
+			Sfloat,
+		};
+
+		inline bool vertexFormatSupported(uint32_t width, uint32_t components) {
+			return (width == 32 || width == 64) && components >= 1 && components <= 4;
+		}
+
+		//-- the VkFormat value, the R32 and R64 formats run through uint, sint and sfloat for
+		//-- each component count
+		inline uint32_t vertexFormat(VertexComponent c, uint32_t width, uint32_t components) {
+			return (width == 64 ? 110 : 98) + (components - 1) * 3 + uint32_t(c);
+		}
+
+		//-- the name of the vk::Format enumerant without its leading e, such as R32G32Sfloat
+		inline std::string vertexFormatName(VertexComponent c, uint32_t width,
+				uint32_t components) {
+			static const char *names[] = { "Uint", "Sint", "Sfloat" };
+			std::string r;
+			for (uint32_t i = 0; i < components; ++i) {
+				r += "RGBA"[i];
+				r += std::to_string(width);
+			}
+			return r + names[uint32_t(c)];
+		}
+
+		//------------------------------------------------------------------------------------
+		//-- VertexPacker - the offsets of the attributes of the generated vertex structure,
+		//-- which has a member for each input in order. its types are tightly packed, so each
+		//-- attribute is aligned to the size of its components.
+
+		struct VertexPacker {
+			uint32_t add(uint32_t width, uint32_t components, uint32_t count = 1) {
+				uint32_t a = width / 8;
+				offset = (offset + a - 1) / a * a;
+				align = std::max(align, a);
+				auto r = offset;
+				offset += a * components * count;
+				return r;
+			}
+
+			uint32_t stride() const { return (offset + align - 1) / align * align; }
+
+			uint32_t offset = 0, align = 1;
+		};
+
+	} // namespace layoutrules
+
+} // namespace autoshader
+
+#endif // H_AUTOSHADER_LAYOUTRULES_H__
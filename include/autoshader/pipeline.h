@@ -8,10 +8,19 @@
 #define H_AUTOSHADER_PIPELINE_H__
 
 #include "createpipe.h"
+#include "spirvreflect.h"
 #include <memory>
 
 namespace autoshader {
 
+	//----------------------------------------------------------------------------------------
+	//-- StageModule - a replacement shader module for one stage of a pipeline
+
+	struct StageModule {
+		vk::ShaderStageFlagBits stage;
+		vk::ShaderModule module;
+	};
+
 	template <typename Components>
 	struct Pipeline {
 		Pipeline() {}
@@ -47,19 +56,113 @@ namespace autoshader {
 				components.device.destroyPipeline(pipeline);
 				pipeline = vk::Pipeline{};
 			}
-			auto x = components.createPipe(std::forward<A>(a)...);
+			auto x = components.createPipe(std::forward<A>(a)..., BasePipeline(parent));
 			pipeline = x.release();
 		}
 
+		//-- derive the pipelines created after this from a parent pipeline, so variants that
+		//-- differ in state or specialization needn't be compiled from scratch. the parent must
+		//-- allow derivatives (create it with AllowDerivatives) and outlive this pipeline's
+		//-- creation. a BasePipeline argument to createPipe takes precedence, and a null
+		//-- parent stops deriving.
+		void deriveFrom(vk::Pipeline p) { parent = p; }
+
+		//-- replace the modules of some stages and recreate the pipeline from the arguments,
+		//-- keeping the layouts so bound descriptor sets stay valid. the pipeline takes the
+		//-- modules on success and destroys the ones replaced. returns false, changing nothing,
+		//-- if a stage isn't in the pipeline or is given twice. the old pipeline is destroyed,
+		//-- so it must not be in use.
+		template <typename... A>
+		bool replaceModules(const StageModule *modules, size_t count, A &&...a) {
+			for (size_t i = 0; i < count; ++i) {
+				if (components.stageModule(modules[i].stage) == nullptr)
+					return false;
+				for (size_t j = 0; j < i; ++j) {
+					if (modules[j].stage == modules[i].stage)
+						return false;
+				}
+			}
+
+			std::vector<vk::ShaderModule> old(count);
+			for (size_t i = 0; i < count; ++i) {
+				auto m = components.stageModule(modules[i].stage);
+				old[i] = *m;
+				*m = modules[i].module;
+			}
+
+			// put the old modules back if the new pipeline can't be made
+			vk::UniquePipeline x;
+			try {
+				x = components.createPipe(std::forward<A>(a)..., BasePipeline(parent));
+			}
+			catch (...) {
+				for (size_t i = 0; i < count; ++i)
+					*components.stageModule(modules[i].stage) = old[i];
+				throw;
+			}
+
+			for (auto m : old)
+				components.device.destroyShaderModule(m);
+			if (pipeline != vk::Pipeline())
+				components.device.destroyPipeline(pipeline);
+			pipeline = x.release();
+			return true;
+		}
+
+		//-- reload the spirv of some stages, for shaders edited while the program runs. the
+		//-- code is checked against the layouts the pipeline was generated with, and the
+		//-- pipeline is left as it was if the code can't be reflected or needs a different
+		//-- layout (ReflectError::LayoutMismatch). needs the autoshader-reflect library.
+		template <typename... A>
+		ReflectError reload(const SpirvCode *code, size_t count, A &&...a) {
+			LayoutReflection r;
+			auto e = reflectLayouts(r, code, count);
+			if (e != ReflectError::None)
+				return e;
+
+			// the layouts come from the generated stages
+			auto stages = Components::stageFlags();
+			std::vector<std::vector<uint32_t>> scratch(stages.size());
+			std::vector<SpirvCode> generated(stages.size());
+			for (size_t i = 0; i < stages.size(); ++i)
+				generated[i].code = Components::stageSpirv(stages[i], scratch[i], generated[i].size);
+			LayoutReflection l;
+			e = reflectLayouts(l, generated.data(), generated.size());
+			if (e == ReflectError::None)
+				e = checkLayoutCompatible(l, r);
+			if (e != ReflectError::None)
+				return e;
+
+			std::vector<vk::UniqueShaderModule> m;
+			std::vector<StageModule> s;
+			for (size_t i = 0; i < count; ++i) {
+				m.push_back(components.device.createShaderModuleUnique({ {},
+					code[i].size * sizeof(uint32_t), code[i].code }));
+				s.push_back(StageModule{ r.stages[i], *m.back() });
+			}
+			if (!replaceModules(s.data(), s.size(), std::forward<A>(a)...))
+				return ReflectError::UnsupportedStage;
+			for (auto &i : m)
+				i.release();
+			return ReflectError::None;
+		}
+
+		template <typename... A>
+		ReflectError reload(std::initializer_list<SpirvCode> code, A &&...a) {
+			return reload(code.begin(), code.size(), std::forward<A>(a)...);
+		}
+
 		void swap(Pipeline<Components> &o) {
 			components.swap(o.components);
 			std::swap(pipeline, o.pipeline);
+			std::swap(parent, o.parent);
 		}
 
 		operator vk::Pipeline () { return pipeline; }
 
 		Components components;
 		vk::Pipeline pipeline;
+		vk::Pipeline parent;
 	};
 
 } // namespace autoshader
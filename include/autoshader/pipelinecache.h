@@ -0,0 +1,265 @@
+//
+//  File: pipelinecache.h
+//
+//  Created by Jon Spencer on 2026-10-17 00:25:32
+//  Copyright (c) Jon Spencer. See LICENSE file.
+//
+#ifndef H_AUTOSHADER_PIPELINECACHE_H__
+#define H_AUTOSHADER_PIPELINECACHE_H__
+
+#include "vulkan/vulkan.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace autoshader {
+
+	//----------------------------------------------------------------------------------------
+	//-- PipelineCacheStats - what a PipelineCacheFile loaded, handed out and saved. a hit is a
+	//-- cache asked for whose data was in the file.
+
+	struct PipelineCacheStats {
+		size_t hits = 0;
+		size_t misses = 0;
+		size_t rejected = 0;
+		size_t pruned = 0;
+		size_t loadedBytes = 0;
+		size_t savedBytes = 0;
+	};
+
+	enum struct CacheFileStatus {
+		Loaded,
+		Missing,
+		Invalid,
+	};
+
+	//----------------------------------------------------------------------------------------
+	//-- PipelineCacheFile - keeps a vk::PipelineCache per shader program in a file, so pipelines
+	//-- compiled in one run are cheap to create in the next. the caches are keyed by the
+	//-- contentHash() of the generated Components, so a program whose spirv has changed starts
+	//-- with an empty cache, and the data of the old spirv is pruned once it hasn't been used
+	//-- for keepSaves saves. the file name is keyed by the vendor, device and
+	//-- pipelineCacheUUID, and data whose vulkan header doesn't match the device is rejected.
+
+	struct PipelineCacheFile {
+		//-- load the file for the device from base + fileKey(properties). a missing or invalid
+		//-- file leaves the caches empty.
+		PipelineCacheFile(vk::Device d, const vk::PhysicalDeviceProperties &properties,
+				const std::string &base) : device(d), props(properties),
+				path(base + fileKey(properties)) {
+			load();
+		}
+
+		//-- saves the caches unless saveOnDestroy is cleared, so the device must outlive this
+		~PipelineCacheFile() {
+			if (saveOnDestroy)
+				save();
+		}
+
+		PipelineCacheFile(const PipelineCacheFile&) = delete;
+		PipelineCacheFile &operator = (const PipelineCacheFile&) = delete;
+
+		//-- the part of the file name that keys it to a device and driver
+		static std::string fileKey(const vk::PhysicalDeviceProperties &p) {
+			char s[64];
+			std::snprintf(s, sizeof(s), "-%04x-%04x-", p.vendorID, p.deviceID);
+			std::string k(s);
+			for (auto b : p.pipelineCacheUUID) {
+				std::snprintf(s, sizeof(s), "%02x", unsigned(b));
+				k += s;
+			}
+			return k + ".cache";
+		}
+
+		//-- the cache for a shader program, created from the file's data the first time
+		template <typename Components>
+		vk::PipelineCache cache() { return cache(Components::contentHash()); }
+
+		vk::PipelineCache cache(uint64_t contentHash) {
+			auto &e = entries[contentHash];
+			if (!e.cache) {
+				if (e.data.empty())
+					stat.misses += 1;
+				else
+					stat.hits += 1;
+				e.cache = device.createPipelineCacheUnique({ {}, e.data.size(), e.data.data() });
+			}
+			return *e.cache;
+		}
+
+		//-- write the caches to a temporary file, then rename it over the file so a crash never
+		//-- leaves a partial file. returns false if the file couldn't be written, leaving the
+		//-- caches and the data to prune as they were.
+		bool save() {
+			auto next = saves + 1;
+			std::string out;
+			put(out, uint32_t(fileMagic));
+			put(out, uint32_t(fileVersion));
+			put(out, next);
+			put(out, uint32_t(0));
+
+			uint32_t count = 0;
+			std::vector<uint64_t> used, pruned;
+			for (auto &i : entries) {
+				auto &e = i.second;
+				auto lastSave = e.lastSave;
+				std::string data;
+				if (e.cache) {
+					lastSave = next;
+					used.push_back(i.first);
+					size_t size = 0;
+					if (device.getPipelineCacheData(*e.cache, &size, nullptr) != vk::Result::eSuccess)
+						return false;
+					data.resize(size);
+					if (device.getPipelineCacheData(*e.cache, &size, &data[0]) != vk::Result::eSuccess)
+						return false;
+					data.resize(size);
+				}
+				else if (next - e.lastSave < keepSaves)
+					data = e.data;
+				else {
+					pruned.push_back(i.first);
+					continue;
+				}
+				if (data.empty())
+					continue;
+				put(out, i.first);
+				put(out, lastSave);
+				put(out, uint32_t(data.size()));
+				out += data;
+				count += 1;
+			}
+			std::memcpy(&out[12], &count, sizeof(count));
+
+			auto temp = path + ".tmp";
+			{
+				std::ofstream str(temp, std::ios::binary | std::ios::trunc);
+				str.write(out.data(), std::streamsize(out.size()));
+				if (!str.flush()) {
+					std::remove(temp.c_str());
+					return false;
+				}
+			}
+			// rename won't replace the file everywhere
+			if (std::rename(temp.c_str(), path.c_str()) != 0) {
+				std::remove(path.c_str());
+				if (std::rename(temp.c_str(), path.c_str()) != 0) {
+					std::remove(temp.c_str());
+					return false;
+				}
+			}
+
+			// the file has the new state, so it can be kept
+			for (auto h : used)
+				entries[h].lastSave = next;
+			for (auto h : pruned)
+				entries.erase(h);
+			saves = next;
+			stat.pruned = pruned.size();
+			stat.savedBytes = out.size();
+			return true;
+		}
+
+		CacheFileStatus status() const { return loadStatus; }
+		const PipelineCacheStats &stats() const { return stat; }
+		const std::string &fileName() const { return path; }
+
+		//-- the number of saves a program's data is kept for without being used
+		uint32_t keepSaves = 4;
+
+		//-- save the caches when this is destroyed
+		bool saveOnDestroy = true;
+
+	private:
+		static constexpr uint32_t fileMagic = 0x43505341;
+		static constexpr uint32_t fileVersion = 1;
+
+		struct Entry {
+			std::string data;
+			uint32_t lastSave = 0;
+			vk::UniquePipelineCache cache;
+		};
+
+		template <typename T>
+		static void put(std::string &s, const T &v) {
+			s.append(reinterpret_cast<const char*>(&v), sizeof(v));
+		}
+
+		template <typename T>
+		static bool get(const std::string &s, size_t &o, T &v) {
+			if (s.size() - o < sizeof(v))
+				return false;
+			std::memcpy(&v, s.data() + o, sizeof(v));
+			o += sizeof(v);
+			return true;
+		}
+
+		//-- check the header vulkan puts at the start of the data against the device
+		bool matchesDevice(const char *d, size_t size) const {
+			uint32_t h[4];
+			if (size < sizeof(h) + VK_UUID_SIZE)
+				return false;
+			std::memcpy(h, d, sizeof(h));
+			return h[0] >= sizeof(h) + VK_UUID_SIZE && h[0] <= size &&
+				h[1] == uint32_t(VK_PIPELINE_CACHE_HEADER_VERSION_ONE) &&
+				h[2] == props.vendorID && h[3] == props.deviceID &&
+				std::memcmp(d + sizeof(h), &props.pipelineCacheUUID[0], VK_UUID_SIZE) == 0;
+		}
+
+		void load() {
+			std::ifstream str(path, std::ios::binary);
+			if (!str) {
+				loadStatus = CacheFileStatus::Missing;
+				return;
+			}
+			std::string s((std::istreambuf_iterator<char>(str)), std::istreambuf_iterator<char>());
+
+			size_t o = 0;
+			uint32_t magic = 0, version = 0, count = 0;
+			if (!get(s, o, magic) || !get(s, o, version) || !get(s, o, saves) || !get(s, o, count) ||
+					magic != fileMagic || version != fileVersion) {
+				loadStatus = CacheFileStatus::Invalid;
+				saves = 0;
+				return;
+			}
+
+			for (uint32_t i = 0; i < count; ++i) {
+				uint64_t hash;
+				uint32_t lastSave, size;
+				if (!get(s, o, hash) || !get(s, o, lastSave) || !get(s, o, size) || s.size() - o < size) {
+					loadStatus = CacheFileStatus::Invalid;
+					entries.clear();
+					saves = 0;
+					stat = PipelineCacheStats();
+					return;
+				}
+				if (matchesDevice(s.data() + o, size)) {
+					auto &e = entries[hash];
+					e.data.assign(s, o, size);
+					e.lastSave = lastSave;
+					stat.loadedBytes += size;
+				}
+				else
+					stat.rejected += 1;
+				o += size;
+			}
+			loadStatus = CacheFileStatus::Loaded;
+		}
+
+		vk::Device device;
+		vk::PhysicalDeviceProperties props;
+		std::string path;
+		CacheFileStatus loadStatus = CacheFileStatus::Missing;
+		uint32_t saves = 0;
+		std::map<uint64_t, Entry> entries;
+		PipelineCacheStats stat;
+	};
+
+} // namespace autoshader
+
+#endif // H_AUTOSHADER_PIPELINECACHE_H__
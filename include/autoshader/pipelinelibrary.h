@@ -0,0 +1,308 @@
+//
+//  File: pipelinelibrary.h
+//
+//  Created by Jon Spencer on 2026-10-17 00:33:30
+//  Copyright (c) Jon Spencer. See LICENSE file.
+//
+#ifndef H_AUTOSHADER_PIPELINELIBRARY_H__
+#define H_AUTOSHADER_PIPELINELIBRARY_H__
+
+#include "pipelinevariants.h"
+#include "pipescheduler.h"
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+
+#ifdef VK_EXT_graphics_pipeline_library
+
+namespace autoshader {
+
+	//----------------------------------------------------------------------------------------
+	//-- the four parts of a pipeline split with VK_EXT_graphics_pipeline_library, in the order
+	//-- they are linked
+
+	constexpr size_t libraryPartCount = 4;
+
+	constexpr vk::GraphicsPipelineLibraryFlagBitsEXT libraryParts[libraryPartCount] = {
+		vk::GraphicsPipelineLibraryFlagBitsEXT::eVertexInputInterface,
+		vk::GraphicsPipelineLibraryFlagBitsEXT::ePreRasterizationShaders,
+		vk::GraphicsPipelineLibraryFlagBitsEXT::eFragmentShader,
+		vk::GraphicsPipelineLibraryFlagBitsEXT::eFragmentOutputInterface,
+	};
+
+	//----------------------------------------------------------------------------------------
+	//-- stageLibraryPart - the part a stage is built in, for packs without generated Components
+
+	inline vk::GraphicsPipelineLibraryFlagsEXT stageLibraryPart(vk::ShaderStageFlagBits s) {
+		if (s == vk::ShaderStageFlagBits::eFragment)
+			return vk::GraphicsPipelineLibraryFlagBitsEXT::eFragmentShader;
+		if (s == vk::ShaderStageFlagBits::eCompute)
+			return {};
+		return vk::GraphicsPipelineLibraryFlagBitsEXT::ePreRasterizationShaders;
+	}
+
+	//----------------------------------------------------------------------------------------
+	//-- LibraryPartState - the create info of one part, pointing into the create info of the
+	//-- whole pipeline it was filled from. the parts keep the link time optimization info so
+	//-- they can be linked fast or optimized.
+
+	struct LibraryPartState {
+		static constexpr size_t maxStages = 8;
+
+		std::array<vk::PipelineShaderStageCreateInfo, maxStages> stages;
+		vk::GraphicsPipelineLibraryCreateInfoEXT library;
+		vk::PipelineRenderingCreateInfo rendering;
+		vk::GraphicsPipelineCreateInfo info;
+	};
+
+	typedef vk::GraphicsPipelineLibraryFlagsEXT (*StagePartFunction)(vk::ShaderStageFlagBits);
+
+	inline void fillLibraryPart(LibraryPartState &p, const vk::GraphicsPipelineCreateInfo &full,
+			vk::GraphicsPipelineLibraryFlagBitsEXT part, StagePartFunction stagePart = stageLibraryPart) {
+		typedef vk::GraphicsPipelineLibraryFlagBitsEXT Part;
+		p.library = vk::GraphicsPipelineLibraryCreateInfoEXT{ part };
+		p.info = vk::GraphicsPipelineCreateInfo{};
+		p.info.pNext = &p.library;
+		p.info.flags = vk::PipelineCreateFlagBits::eLibraryKHR |
+			vk::PipelineCreateFlagBits::eRetainLinkTimeOptimizationInfoEXT;
+		p.info.flags |= full.flags & vk::PipelineCreateFlagBits::eFailOnPipelineCompileRequired;
+		p.info.pDynamicState = full.pDynamicState;
+
+		if (part == Part::ePreRasterizationShaders || part == Part::eFragmentShader) {
+			uint32_t n = 0;
+			for (uint32_t i = 0; i < full.stageCount; ++i) {
+				if (stagePart(full.pStages[i].stage) == part) {
+					assert(n < p.stages.size());
+					p.stages[n++] = full.pStages[i];
+				}
+			}
+			p.info.stageCount = n;
+			p.info.pStages = p.stages.data();
+			p.info.layout = full.layout;
+		}
+		if (part != Part::eVertexInputInterface) {
+			p.info.renderPass = full.renderPass;
+			p.info.subpass = full.subpass;
+
+			// without a render pass the parts after vertex input need the rendering formats
+			for (auto n = static_cast<const vk::BaseInStructure*>(full.pNext); n != nullptr &&
+					full.renderPass == vk::RenderPass(); n = n->pNext) {
+				if (n->sType == vk::StructureType::ePipelineRenderingCreateInfo) {
+					p.rendering = *reinterpret_cast<const vk::PipelineRenderingCreateInfo*>(n);
+					p.rendering.pNext = nullptr;
+					p.library.pNext = &p.rendering;
+					break;
+				}
+			}
+		}
+
+		switch (part) {
+			case Part::eVertexInputInterface:
+				p.info.pVertexInputState = full.pVertexInputState;
+				p.info.pInputAssemblyState = full.pInputAssemblyState;
+				break;
+			case Part::ePreRasterizationShaders:
+				p.info.pTessellationState = full.pTessellationState;
+				p.info.pViewportState = full.pViewportState;
+				p.info.pRasterizationState = full.pRasterizationState;
+				break;
+			case Part::eFragmentShader:
+				p.info.pMultisampleState = full.pMultisampleState;
+				p.info.pDepthStencilState = full.pDepthStencilState;
+				break;
+			case Part::eFragmentOutputInterface:
+				p.info.pMultisampleState = full.pMultisampleState;
+				p.info.pColorBlendState = full.pColorBlendState;
+				break;
+			default:
+				break;
+		}
+	}
+
+	//----------------------------------------------------------------------------------------
+	//-- linkPipeLibraries - link the parts into a pipeline. a fast link skips the link time
+	//-- optimization, so it returns quickly with a pipeline that may run slower.
+
+	inline vk::UniquePipeline linkPipeLibraries(vk::Device device, vk::PipelineCache cache,
+			vk::PipelineLayout layout, const std::array<vk::Pipeline, libraryPartCount> &parts,
+			bool optimize) {
+		vk::PipelineLibraryCreateInfoKHR link{ uint32_t(parts.size()), parts.data() };
+		vk::GraphicsPipelineCreateInfo info;
+		info.pNext = &link;
+		if (optimize)
+			info.flags = vk::PipelineCreateFlagBits::eLinkTimeOptimizationEXT;
+		info.layout = layout;
+		return device.createGraphicsPipelineUnique(cache, info).value;
+	}
+
+	//----------------------------------------------------------------------------------------
+	//-- LibraryStats - the parts created and found, and the links made
+
+	struct LibraryStats {
+		size_t partsCreated = 0;
+		size_t partsFound = 0;
+		size_t fastLinks = 0;
+		size_t optimizedLinks = 0;
+		size_t linksFound = 0;
+	};
+
+	//----------------------------------------------------------------------------------------
+	//-- PipelineLibraries - creates the pipelines of one set of Components as four library
+	//-- parts, each kept by its own state, so a new combination of vertex input, shaders and
+	//-- output state only builds the parts that are new. the stages are split by
+	//-- Components::stageLibrary. get() fast links the parts, and when there is a scheduler an
+	//-- optimized link is made on its workers and returned by get() once ready. the device
+	//-- needs graphicsPipelineLibrary enabled.
+
+	template <typename Components>
+	struct PipelineLibraries {
+		PipelineLibraries() {}
+		explicit PipelineLibraries(Components &&c, PipeScheduler *s = nullptr) : scheduler(s) {
+			components = std::move(c);
+		}
+
+		//-- waits for its own optimized links, so the scheduler must outlive this. other work
+		//-- on the scheduler and the errors wait() reports are left alone.
+		~PipelineLibraries() {
+			{
+				std::unique_lock<std::mutex> lock(linkMutex);
+				linked.wait(lock, [this] { return linking == 0; });
+			}
+			for (auto &l : links) {
+				components.device.destroyPipeline(l.second->fast);
+				if (l.second->optimized != vk::Pipeline())
+					components.device.destroyPipeline(l.second->optimized);
+			}
+			for (auto &p : parts) {
+				for (auto &l : p)
+					components.device.destroyPipeline(l.second);
+			}
+		}
+
+		PipelineLibraries(const PipelineLibraries&) = delete;
+		PipelineLibraries &operator = (const PipelineLibraries&) = delete;
+
+		//-- the pipeline for the arguments of Components::createPipe, optimized if it's ready.
+		//-- returns a null pipeline if a part couldn't be created without compiling
+		//-- (FailIfUncached).
+		template <typename... A>
+		vk::Pipeline get(A &&...a) {
+			auto args = components.pipeArgs(std::forward<A>(a)...);
+			typedef typename PipeStateOf<decltype(args)>::type State;
+			static_assert(!std::is_same<State, ComputePipeState>::value,
+				"compute pipelines can't be split into libraries");
+			State s;
+			fillPipeTuple(s, args, PackSequence<decltype(args)>());
+
+			std::array<vk::Pipeline, libraryPartCount> lib;
+			for (size_t i = 0; i < libraryPartCount; ++i) {
+				lib[i] = part(s.device, s.cache, s.info, i);
+				if (lib[i] == vk::Pipeline())
+					return vk::Pipeline();
+			}
+
+			std::string key(reinterpret_cast<const char*>(lib.data()), sizeof(lib));
+			key.append(reinterpret_cast<const char*>(&s.info.layout), sizeof(s.info.layout));
+			auto f = links.find(key);
+			if (f != links.end()) {
+				stat.linksFound += 1;
+				auto &l = *f->second;
+				return l.ready.load(std::memory_order_acquire) ? l.optimized : l.fast;
+			}
+
+			auto fast = linkPipeLibraries(s.device, s.cache, s.info.layout, lib, false);
+			if (!fast)
+				return vk::Pipeline();
+			stat.fastLinks += 1;
+			auto l = new Link;
+			l->fast = fast.release();
+			links.emplace(key, std::unique_ptr<Link>(l));
+
+			if (scheduler != nullptr) {
+				auto device = s.device;
+				auto layout = s.info.layout;
+				{
+					std::lock_guard<std::mutex> lock(linkMutex);
+					linking += 1;
+				}
+				scheduler->schedule(optimizePriority, [this, l, device, layout, lib] (vk::PipelineCache c) {
+					try {
+						l->optimized = linkPipeLibraries(device, c, layout, lib, true).release();
+					}
+					catch (...) {
+						linkDone();
+						throw;
+					}
+					l->ready.store(true, std::memory_order_release);
+					linkDone();
+				});
+				stat.optimizedLinks += 1;
+			}
+			return l->fast;
+		}
+
+		const LibraryStats &stats() const { return stat; }
+
+		Components components;
+
+		//-- the priority of the optimized links on the scheduler
+		int optimizePriority = -1;
+
+	private:
+		struct Link {
+			vk::Pipeline fast;
+			vk::Pipeline optimized;
+			std::atomic<bool> ready{ false };
+		};
+
+		void linkDone() {
+			std::lock_guard<std::mutex> lock(linkMutex);
+			if (--linking == 0)
+				linked.notify_all();
+		}
+
+		vk::Pipeline part(vk::Device device, vk::PipelineCache cache,
+				const vk::GraphicsPipelineCreateInfo &full, size_t i) {
+			LibraryPartState p;
+			fillLibraryPart(p, full, libraryParts[i], &Components::stageLibrary);
+
+			// the part's own create info is keyed, not where it's chained from, with the
+			// rendering formats chained after the library info. the key leaves out the
+			// FailIfUncached flag copied from the whole pipeline, so a probe finds the parts.
+			auto info = p.info;
+			info.pNext = p.library.pNext;
+			key.clear();
+			key.add(info);
+
+			auto f = parts[i].find(key.bytes);
+			if (f != parts[i].end()) {
+				stat.partsFound += 1;
+				return f->second;
+			}
+			auto l = device.createGraphicsPipelineUnique(cache, p.info).value;
+			if (!l)
+				return vk::Pipeline();
+			stat.partsCreated += 1;
+			parts[i].emplace(key.bytes, *l);
+			return l.release();
+		}
+
+		PipeScheduler *scheduler = nullptr;
+		std::array<std::unordered_map<std::string, vk::Pipeline>, libraryPartCount> parts;
+		std::unordered_map<std::string, std::unique_ptr<Link>> links;
+		PipeKey key;
+		LibraryStats stat;
+
+		// the optimized links still queued or running on the scheduler
+		std::mutex linkMutex;
+		std::condition_variable linked;
+		size_t linking = 0;
+	};
+
+} // namespace autoshader
+
+#endif // VK_EXT_graphics_pipeline_library
+
+#endif // H_AUTOSHADER_PIPELINELIBRARY_H__
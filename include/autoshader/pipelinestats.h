@@ -0,0 +1,312 @@
+//
+//  File: pipelinestats.h
+//
+//  Created by Jon Spencer on 2026-10-17 00:44:11
+//  Copyright (c) Jon Spencer. See LICENSE file.
+//
+#ifndef H_AUTOSHADER_PIPELINESTATS_H__
+#define H_AUTOSHADER_PIPELINESTATS_H__
+
+#include "createpipe.h"
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#ifdef VK_KHR_pipeline_executable_properties
+
+namespace autoshader {
+
+	//----------------------------------------------------------------------------------------
+	//-- StageFeedback - the creation feedback of one stage, durations are in nanoseconds
+
+	struct StageFeedback {
+		vk::ShaderStageFlagBits stage;
+		bool valid = false;
+		bool cacheHit = false;
+		uint64_t duration = 0;
+	};
+
+	//----------------------------------------------------------------------------------------
+	//-- ExecutableStats - the statistics the driver reports for one executable of a pipeline,
+	//-- such as its register and instruction counts
+
+	struct ExecutableStatistic {
+		std::string name;
+		vk::PipelineExecutableStatisticFormatKHR format;
+		vk::PipelineExecutableStatisticValueKHR value;
+	};
+
+	struct ExecutableStats {
+		std::string name;
+		vk::ShaderStageFlags stages;
+		uint32_t subgroupSize = 0;
+		std::vector<ExecutableStatistic> statistics;
+	};
+
+	//----------------------------------------------------------------------------------------
+	//-- getExecutableStats - the statistics of a pipeline created with
+	//-- CreationFeedback::captureStatistics. needs VK_KHR_pipeline_executable_properties, and
+	//-- its commands need a dispatcher that loads them: pass one, or see
+	//-- AUTOSHADER_EXTENSION_DISPATCH to use the default.
+
+	template <typename Dispatch = VULKAN_HPP_DEFAULT_DISPATCHER_TYPE>
+	std::vector<ExecutableStats> getExecutableStats(vk::Device device, vk::Pipeline p,
+			const Dispatch &d = VULKAN_HPP_DEFAULT_DISPATCHER) {
+		static_assert(extension_dispatch<Dispatch>() ||
+			!std::is_same<Dispatch, VULKAN_HPP_DEFAULT_DISPATCHER_TYPE>::value,
+			"the executable statistics are read with extension commands, see AUTOSHADER_EXTENSION_DISPATCH");
+		std::vector<ExecutableStats> r;
+		auto props = device.getPipelineExecutablePropertiesKHR(vk::PipelineInfoKHR{ p }, d);
+		for (uint32_t i = 0; i < uint32_t(props.size()); ++i) {
+			ExecutableStats e;
+			e.name = props[i].name.data();
+			e.stages = props[i].stages;
+			e.subgroupSize = props[i].subgroupSize;
+			auto stats = device.getPipelineExecutableStatisticsKHR(
+				vk::PipelineExecutableInfoKHR{ p, i }, d);
+			for (auto &s : stats)
+				e.statistics.push_back(ExecutableStatistic{ s.name.data(), s.format, s.value });
+			r.push_back(std::move(e));
+		}
+		return r;
+	}
+
+	//----------------------------------------------------------------------------------------
+	//-- PipelineRecord - the feedback and statistics of one pipeline
+
+	struct PipelineRecord {
+		std::string label;
+		bool valid = false;
+		bool cacheHit = false;
+		uint64_t duration = 0;
+		std::vector<StageFeedback> stages;
+		std::vector<ExecutableStats> executables;
+	};
+
+	//----------------------------------------------------------------------------------------
+	//-- PipelineStats - the creation feedback of the pipelines made from one set of
+	//-- Components, to find the pipelines that are slow to create and see why. records can be
+	//-- added from any thread, and are written out as json.
+
+	struct PipelineStats {
+		explicit PipelineStats(uint64_t hash = 0) : contentHash(hash) {}
+
+		PipelineStats(const PipelineStats&) = delete;
+		PipelineStats &operator = (const PipelineStats&) = delete;
+
+		//-- record a pipeline created with the feedback, and its executable statistics if they
+		//-- were read. makes no vulkan calls.
+		void add(const CreationFeedback &f, const std::string &label = std::string(),
+				std::vector<ExecutableStats> executables = std::vector<ExecutableStats>()) {
+			typedef vk::PipelineCreationFeedbackFlagBits Bits;
+			PipelineRecord r;
+			r.label = label;
+			r.valid = bool(f.pipeline.flags & Bits::eValid);
+			r.cacheHit = bool(f.pipeline.flags & Bits::eApplicationPipelineCacheHit);
+			r.duration = f.pipeline.duration;
+			for (uint32_t i = 0; i < f.stageCount; ++i) {
+				auto &s = f.stages[i];
+				r.stages.push_back(StageFeedback{ f.stageFlags[i], bool(s.flags & Bits::eValid),
+					bool(s.flags & Bits::eApplicationPipelineCacheHit), s.duration });
+			}
+			r.executables = std::move(executables);
+
+			std::lock_guard<std::mutex> l(lock);
+			records.push_back(std::move(r));
+		}
+
+		std::vector<PipelineRecord> pipelines() const {
+			std::lock_guard<std::mutex> l(lock);
+			return records;
+		}
+
+		size_t size() const {
+			std::lock_guard<std::mutex> l(lock);
+			return records.size();
+		}
+
+		void clear() {
+			std::lock_guard<std::mutex> l(lock);
+			records.clear();
+		}
+
+		//-- the records as a json document, durations in nanoseconds
+		std::string json() const {
+			std::lock_guard<std::mutex> l(lock);
+			std::string o;
+			char b[64];
+			std::snprintf(b, sizeof(b), "{\n  \"contentHash\": \"%016llx\",\n  \"pipelines\": [",
+				static_cast<unsigned long long>(contentHash));
+			o += b;
+			for (size_t i = 0; i < records.size(); ++i) {
+				auto &r = records[i];
+				o += i == 0 ? "\n    {\n      \"label\": " : ",\n    {\n      \"label\": ";
+				jsonString(o, r.label);
+				feedback(o, r.valid, r.cacheHit, r.duration, ",\n      ");
+				o += ",\n      \"stages\": [";
+				for (size_t s = 0; s < r.stages.size(); ++s) {
+					o += s == 0 ? "\n        { \"stage\": " : ",\n        { \"stage\": ";
+					jsonString(o, stageName(r.stages[s].stage));
+					feedback(o, r.stages[s].valid, r.stages[s].cacheHit, r.stages[s].duration, ", ");
+					o += " }";
+				}
+				o += r.stages.empty() ? "]" : "\n      ]";
+				o += ",\n      \"executables\": [";
+				for (size_t e = 0; e < r.executables.size(); ++e)
+					executable(o, r.executables[e], e == 0);
+				o += r.executables.empty() ? "]\n    }" : "\n      ]\n    }";
+			}
+			o += records.empty() ? "]\n}\n" : "\n  ]\n}\n";
+			return o;
+		}
+
+		//-- write the json to a file, returns false if it couldn't be written
+		bool save(const std::string &path) const {
+			std::ofstream str(path, std::ios::binary);
+			str << json();
+			return bool(str);
+		}
+
+		uint64_t contentHash;
+
+	private:
+		static const char *stageName(vk::ShaderStageFlagBits s) {
+			switch (s) {
+				case vk::ShaderStageFlagBits::eVertex: return "vertex";
+				case vk::ShaderStageFlagBits::eTessellationControl: return "tessellationControl";
+				case vk::ShaderStageFlagBits::eTessellationEvaluation: return "tessellationEvaluation";
+				case vk::ShaderStageFlagBits::eGeometry: return "geometry";
+				case vk::ShaderStageFlagBits::eFragment: return "fragment";
+				case vk::ShaderStageFlagBits::eCompute: return "compute";
+#ifdef VK_EXT_mesh_shader
+				case vk::ShaderStageFlagBits::eTaskEXT: return "task";
+				case vk::ShaderStageFlagBits::eMeshEXT: return "mesh";
+#endif
+				default: return "other";
+			}
+		}
+
+		static void jsonString(std::string &o, const std::string &s) {
+			o += '"';
+			for (char c : s) {
+				if (c == '"' || c == '\\') {
+					o += '\\';
+					o += c;
+				}
+				else if (static_cast<unsigned char>(c) < 0x20) {
+					char b[8];
+					std::snprintf(b, sizeof(b), "\\u%04x", unsigned(c));
+					o += b;
+				}
+				else
+					o += c;
+			}
+			o += '"';
+		}
+
+		static void feedback(std::string &o, bool valid, bool cacheHit, uint64_t duration,
+				const char *sep) {
+			char b[32];
+			std::snprintf(b, sizeof(b), "%llu", static_cast<unsigned long long>(duration));
+			o += sep;
+			o += valid ? "\"valid\": true" : "\"valid\": false";
+			o += sep;
+			o += cacheHit ? "\"cacheHit\": true" : "\"cacheHit\": false";
+			o += sep;
+			o += "\"duration\": ";
+			o += b;
+		}
+
+		static void executable(std::string &o, const ExecutableStats &e, bool first) {
+			typedef vk::PipelineExecutableStatisticFormatKHR Format;
+			o += first ? "\n        {\n          \"name\": " : ",\n        {\n          \"name\": ";
+			jsonString(o, e.name);
+			o += ",\n          \"stages\": [";
+			bool c = false;
+			for (uint32_t bit = 1; bit != 0; bit <<= 1) {
+				if (e.stages & vk::ShaderStageFlagBits(bit)) {
+					o += c ? ", " : " ";
+					jsonString(o, stageName(vk::ShaderStageFlagBits(bit)));
+					c = true;
+				}
+			}
+			char b[48];
+			std::snprintf(b, sizeof(b), " ],\n          \"subgroupSize\": %u", e.subgroupSize);
+			o += b;
+			o += ",\n          \"statistics\": {";
+			for (size_t i = 0; i < e.statistics.size(); ++i) {
+				auto &s = e.statistics[i];
+				o += i == 0 ? "\n            " : ",\n            ";
+				jsonString(o, s.name);
+				switch (s.format) {
+					case Format::eBool32:
+						std::snprintf(b, sizeof(b), ": %s", s.value.b32 ? "true" : "false");
+						break;
+					case Format::eInt64:
+						std::snprintf(b, sizeof(b), ": %lld", static_cast<long long>(s.value.i64));
+						break;
+					case Format::eUint64:
+						std::snprintf(b, sizeof(b), ": %llu",
+							static_cast<unsigned long long>(s.value.u64));
+						break;
+					default:
+						if (std::isfinite(s.value.f64))
+							std::snprintf(b, sizeof(b), ": %.17g", s.value.f64);
+						else
+							std::snprintf(b, sizeof(b), ": null");
+						break;
+				}
+				o += b;
+			}
+			o += e.statistics.empty() ? "}\n        }" : "\n          }\n        }";
+		}
+
+		mutable std::mutex lock;
+		std::vector<PipelineRecord> records;
+	};
+
+	//----------------------------------------------------------------------------------------
+	//-- pipelineStats - the record of the pipelines of one set of Components
+
+	template <typename Components>
+	PipelineStats &pipelineStats() {
+		static PipelineStats stats(Components::contentHash());
+		return stats;
+	}
+
+	//----------------------------------------------------------------------------------------
+	//-- createPipeProfiled - create a pipeline from the Components with creation feedback, and
+	//-- add it to pipelineStats<Components>()
+
+	template <typename Components, typename... A>
+	vk::UniquePipeline createPipeProfiled(Components &c, A &&...a) {
+		CreationFeedback f;
+		auto p = c.createPipe(std::forward<A>(a)..., &f);
+		if (p)
+			pipelineStats<Components>().add(f);
+		return p;
+	}
+
+	//----------------------------------------------------------------------------------------
+	//-- createPipeWithStatistics - createPipeProfiled that also captures and records the
+	//-- executable statistics, see getExecutableStats for what it needs
+
+	template <typename Components, typename... A>
+	vk::UniquePipeline createPipeWithStatistics(Components &c, A &&...a) {
+		CreationFeedback f;
+		f.captureStatistics = true;
+		auto p = c.createPipe(std::forward<A>(a)..., &f);
+		if (p)
+			pipelineStats<Components>().add(f, std::string(), getExecutableStats(c.device, *p));
+		return p;
+	}
+
+} // namespace autoshader
+
+#endif // VK_KHR_pipeline_executable_properties
+
+#endif // H_AUTOSHADER_PIPELINESTATS_H__
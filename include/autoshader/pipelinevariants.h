@@ -0,0 +1,343 @@
+//
+//  File: pipelinevariants.h
+//
+//  Created by Jon Spencer on 2026-10-17 00:30:33
+//  Copyright (c) Jon Spencer. See LICENSE file.
+//
+#ifndef H_AUTOSHADER_PIPELINEVARIANTS_H__
+#define H_AUTOSHADER_PIPELINEVARIANTS_H__
+
+#include "createpipe.h"
+#include <list>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace autoshader {
+
+	//----------------------------------------------------------------------------------------
+	//-- PipeKey - the resolved state of a create info as bytes, following its pointers, so two
+	//-- create infos with the same key make the same pipeline. the specialization data is
+	//-- included, pNext chains are keyed by address past the dynamic rendering formats and
+	//-- required subgroup sizes, which are keyed by value, and the pipeline cache, creation
+	//-- feedback and the flags that only change how the pipeline is asked for are left out.
+
+	struct PipeKey {
+		std::string bytes;
+
+		void clear() { bytes.clear(); }
+
+		template <typename T>
+		void add(const T &v) {
+			static_assert(std::is_trivially_copyable<T>::value, "keys are made of plain values");
+			bytes.append(reinterpret_cast<const char*>(&v), sizeof(v));
+		}
+
+		// the count, then the elements, which must be plain values without padding
+		template <typename T>
+		void add(const T *p, uint32_t count) {
+			add(count);
+			if (p != nullptr)
+				bytes.append(reinterpret_cast<const char*>(p), sizeof(T) * count);
+		}
+
+		void add(const char *s) {
+			if (s != nullptr)
+				bytes.append(s);
+			bytes.push_back(0);
+		}
+
+		// creation feedback is written by the driver, so it is left out of a chain. the
+		// rendering formats and subgroup size are copied into the create state, so they are
+		// keyed by value.
+		void addNext(const void *p) {
+			for (; p != nullptr; p = static_cast<const vk::BaseInStructure*>(p)->pNext) {
+				auto type = static_cast<const vk::BaseInStructure*>(p)->sType;
+				if (type == vk::StructureType::ePipelineCreationFeedbackCreateInfo)
+					continue;
+				if (type == vk::StructureType::ePipelineRenderingCreateInfo) {
+					auto r = static_cast<const vk::PipelineRenderingCreateInfo*>(p);
+					add(type);
+					add(r->viewMask);
+					add(r->pColorAttachmentFormats, r->colorAttachmentCount);
+					add(r->depthAttachmentFormat);
+					add(r->stencilAttachmentFormat);
+				}
+				else if (type == vk::StructureType::ePipelineShaderStageRequiredSubgroupSizeCreateInfo) {
+					add(type);
+					add(static_cast<const vk::PipelineShaderStageRequiredSubgroupSizeCreateInfo*>(p)->
+						requiredSubgroupSize);
+				}
+				else
+					break;
+			}
+			add(p);
+		}
+
+		// the flags that ask for no compile or for statistics make the same pipeline, so a
+		// probe with FailIfUncached finds the pipeline created without it
+		static vk::PipelineCreateFlags requestFlags() {
+			vk::PipelineCreateFlags f = vk::PipelineCreateFlagBits::eFailOnPipelineCompileRequired |
+				vk::PipelineCreateFlagBits::eEarlyReturnOnFailure;
+#ifdef VK_KHR_pipeline_executable_properties
+			f |= vk::PipelineCreateFlagBits::eCaptureStatisticsKHR |
+				vk::PipelineCreateFlagBits::eCaptureInternalRepresentationsKHR;
+#endif
+			return f;
+		}
+
+		void addFlags(vk::PipelineCreateFlags f) {
+			add(f & ~requestFlags());
+		}
+
+		// a flag for whether an optional state is present
+		template <typename T>
+		bool present(const T *p) {
+			add(uint8_t(p != nullptr));
+			return p != nullptr;
+		}
+
+		void add(const vk::PipelineShaderStageCreateInfo &s) {
+			addNext(s.pNext);
+			add(s.flags);
+			add(s.stage);
+			add(s.module);
+			add(s.pName);
+			if (present(s.pSpecializationInfo)) {
+				auto &i = *s.pSpecializationInfo;
+				add(i.pMapEntries, i.mapEntryCount);
+				add(static_cast<const uint8_t*>(i.pData), uint32_t(i.dataSize));
+			}
+		}
+
+		void add(const vk::ComputePipelineCreateInfo &i) {
+			addNext(i.pNext);
+			addFlags(i.flags);
+			add(i.stage);
+			add(i.layout);
+			add(i.basePipelineHandle);
+			add(i.basePipelineIndex);
+		}
+
+		void add(const vk::GraphicsPipelineCreateInfo &i) {
+			addNext(i.pNext);
+			addFlags(i.flags);
+			add(i.stageCount);
+			for (uint32_t s = 0; s < i.stageCount; ++s)
+				add(i.pStages[s]);
+
+			if (present(i.pVertexInputState)) {
+				auto v = i.pVertexInputState;
+				add(v->pNext);
+				add(v->pVertexBindingDescriptions, v->vertexBindingDescriptionCount);
+				add(v->pVertexAttributeDescriptions, v->vertexAttributeDescriptionCount);
+			}
+			if (present(i.pInputAssemblyState)) {
+				add(i.pInputAssemblyState->topology);
+				add(i.pInputAssemblyState->primitiveRestartEnable);
+			}
+			if (present(i.pTessellationState))
+				add(i.pTessellationState->patchControlPoints);
+			if (present(i.pViewportState)) {
+				auto v = i.pViewportState;
+				add(v->pNext);
+				add(v->pViewports, v->viewportCount);
+				add(v->pScissors, v->scissorCount);
+			}
+			if (present(i.pRasterizationState)) {
+				auto r = i.pRasterizationState;
+				add(r->pNext);
+				add(r->depthClampEnable);
+				add(r->rasterizerDiscardEnable);
+				add(r->polygonMode);
+				add(r->cullMode);
+				add(r->frontFace);
+				add(r->depthBiasEnable);
+				add(r->depthBiasConstantFactor);
+				add(r->depthBiasClamp);
+				add(r->depthBiasSlopeFactor);
+				add(r->lineWidth);
+			}
+			if (present(i.pMultisampleState)) {
+				auto m = i.pMultisampleState;
+				add(m->pNext);
+				add(m->rasterizationSamples);
+				add(m->sampleShadingEnable);
+				add(m->minSampleShading);
+				add(m->pSampleMask, m->pSampleMask != nullptr ?
+					(uint32_t(m->rasterizationSamples) + 31) / 32 : 0);
+				add(m->alphaToCoverageEnable);
+				add(m->alphaToOneEnable);
+			}
+			if (present(i.pDepthStencilState)) {
+				auto d = i.pDepthStencilState;
+				add(d->pNext);
+				add(d->depthTestEnable);
+				add(d->depthWriteEnable);
+				add(d->depthCompareOp);
+				add(d->depthBoundsTestEnable);
+				add(d->stencilTestEnable);
+				add(d->front);
+				add(d->back);
+				add(d->minDepthBounds);
+				add(d->maxDepthBounds);
+			}
+			if (present(i.pColorBlendState)) {
+				auto c = i.pColorBlendState;
+				add(c->pNext);
+				add(c->logicOpEnable);
+				add(c->logicOp);
+				add(c->pAttachments, c->attachmentCount);
+				add(&c->blendConstants[0], 4);
+			}
+			if (present(i.pDynamicState))
+				add(i.pDynamicState->pDynamicStates, i.pDynamicState->dynamicStateCount);
+
+			add(i.layout);
+			add(i.renderPass);
+			add(i.subpass);
+			add(i.basePipelineHandle);
+			add(i.basePipelineIndex);
+		}
+	};
+
+	//----------------------------------------------------------------------------------------
+	//-- the create state of an argument tuple, and creating a pipeline from a filled state
+
+	template <typename T> struct PipeStateOf;
+
+	template <typename... A>
+	struct PipeStateOf<std::tuple<A...>> {
+		typedef std::conditional_t<is_compute_pack<A...>(), ComputePipeState,
+			GraphicsPipeStateFor<A...>> type;
+	};
+
+	inline vk::UniquePipeline createPipeFromState(ComputePipeState &s) {
+		return s.device.createComputePipelineUnique(s.cache, s.info).value;
+	}
+
+	template <typename S>
+	vk::UniquePipeline createPipeFromState(S &s) {
+		return s.device.createGraphicsPipelineUnique(s.cache, s.info).value;
+	}
+
+	//----------------------------------------------------------------------------------------
+	//-- VariantStats - lookups that found a pipeline, those that created one, and pipelines
+	//-- evicted to stay in the budget
+
+	struct VariantStats {
+		size_t hits = 0;
+		size_t misses = 0;
+		size_t evictions = 0;
+
+		double hitRate() const {
+			auto n = hits + misses;
+			return n == 0 ? 0.0 : double(hits) / double(n);
+		}
+	};
+
+	//----------------------------------------------------------------------------------------
+	//-- PipelineVariants - the pipelines of one set of Components, kept by the state they were
+	//-- created with. get() resolves its arguments as createPipe would and returns the pipeline
+	//-- made from the same state before, or creates one. past maxPipelines the least recently
+	//-- used are evicted; they are retired rather than destroyed, as command buffers in flight
+	//-- may still use them, until destroyRetired() is called.
+
+	template <typename Components>
+	struct PipelineVariants {
+		PipelineVariants() {}
+		explicit PipelineVariants(Components &&c, size_t budget = 64) : maxPipelines(budget) {
+			components = std::move(c);
+		}
+
+		~PipelineVariants() {
+			clear();
+			destroyRetired();
+		}
+
+		PipelineVariants(const PipelineVariants&) = delete;
+		PipelineVariants &operator = (const PipelineVariants&) = delete;
+
+		//-- the pipeline for the arguments of Components::createPipe, or a null pipeline if it
+		//-- couldn't be created without compiling (FailIfUncached)
+		template <typename... A>
+		vk::Pipeline get(A &&...a) {
+			auto args = components.pipeArgs(std::forward<A>(a)...);
+			typename PipeStateOf<decltype(args)>::type s;
+			fillPipeTuple(s, args, PackSequence<decltype(args)>());
+			key.clear();
+			key.add(s.info);
+
+			auto f = index.find(key.bytes);
+			if (f != index.end()) {
+				stat.hits += 1;
+				lru.splice(lru.begin(), lru, f->second);
+				return f->second->pipeline;
+			}
+
+			stat.misses += 1;
+			auto p = createPipeFromState(s);
+			if (!p)
+				return vk::Pipeline();
+			lru.push_front(Entry{ key.bytes, p.release() });
+			index.emplace(key.bytes, lru.begin());
+			trim();
+			return lru.front().pipeline;
+		}
+
+		//-- change the budget, evicting down to it
+		void setBudget(size_t budget) {
+			maxPipelines = budget;
+			trim();
+		}
+
+		//-- destroy the pipelines evicted since the last call, once the gpu is done with them
+		void destroyRetired() {
+			for (auto p : retired)
+				components.device.destroyPipeline(p);
+			retired.clear();
+		}
+
+		//-- retire every pipeline
+		void clear() {
+			for (auto &e : lru)
+				retired.push_back(e.pipeline);
+			lru.clear();
+			index.clear();
+		}
+
+		size_t size() const { return lru.size(); }
+		size_t budget() const { return maxPipelines; }
+		const VariantStats &stats() const { return stat; }
+		void resetStats() { stat = VariantStats(); }
+
+		Components components;
+
+	private:
+		struct Entry {
+			std::string key;
+			vk::Pipeline pipeline;
+		};
+
+		void trim() {
+			while (lru.size() > maxPipelines) {
+				auto &e = lru.back();
+				retired.push_back(e.pipeline);
+				index.erase(e.key);
+				lru.pop_back();
+				stat.evictions += 1;
+			}
+		}
+
+		size_t maxPipelines = 64;
+		std::list<Entry> lru;
+		std::unordered_map<std::string, typename std::list<Entry>::iterator> index;
+		std::vector<vk::Pipeline> retired;
+		PipeKey key;
+		VariantStats stat;
+	};
+
+} // namespace autoshader
+
+#endif // H_AUTOSHADER_PIPELINEVARIANTS_H__
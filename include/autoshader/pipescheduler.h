@@ -0,0 +1,235 @@
+//
+//  File: pipescheduler.h
+//
+//  Created by Jon Spencer on 2026-10-17 00:22:42
+//  Copyright (c) Jon Spencer. See LICENSE file.
+//
+#ifndef H_AUTOSHADER_PIPESCHEDULER_H__
+#define H_AUTOSHADER_PIPESCHEDULER_H__
+
+#include "pipeline.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace autoshader {
+
+	//----------------------------------------------------------------------------------------
+	//-- AsyncPipe - a pipeline created in the background, and the pipeline to draw with until
+	//-- it's ready. get() can be called on any thread while the pipeline is being created.
+
+	template <typename Components>
+	struct AsyncPipe {
+		AsyncPipe() {}
+		explicit AsyncPipe(Components &&c, vk::Pipeline f = {}) : fallback(f) {
+			pipeline.components = std::move(c);
+		}
+
+		AsyncPipe(const AsyncPipe&) = delete;
+		AsyncPipe &operator = (const AsyncPipe&) = delete;
+
+		//-- the pipeline if it's ready, otherwise the fallback
+		vk::Pipeline get() const { return ready() ? pipeline.pipeline : fallback; }
+
+		bool ready() const { return isReady.load(std::memory_order_acquire); }
+
+		//-- true if the pipeline couldn't be created, after which get() keeps the fallback
+		bool failed() const { return isFailed.load(std::memory_order_acquire); }
+
+		Pipeline<Components> pipeline;
+		vk::Pipeline fallback;
+		std::atomic<bool> isReady{ false };
+		std::atomic<bool> isFailed{ false };
+	};
+
+	//----------------------------------------------------------------------------------------
+	//-- PipeScheduler - spreads pipeline creation across a pool of worker threads, so the
+	//-- driver compiles many pipelines at once. each worker creates its pipelines with its own
+	//-- vk::PipelineCache, and merge() folds the worker caches into the master cache. queued
+	//-- pipelines are created highest priority first, in the order queued within a priority.
+
+	struct PipeScheduler {
+		//-- start the workers. the master cache is created if one isn't given.
+		PipeScheduler(vk::Device d, vk::PipelineCache master = {}, size_t threads = 0) : device(d) {
+			if (threads == 0)
+				threads = std::max(1u, std::thread::hardware_concurrency());
+			if (master == vk::PipelineCache()) {
+				ownCache = device.createPipelineCacheUnique({});
+				master = *ownCache;
+			}
+			cache = master;
+			caches.resize(threads);
+			for (auto &c : caches)
+				c = device.createPipelineCacheUnique({});
+			for (size_t i = 0; i < threads; ++i)
+				workers.emplace_back([this, i] { work(*caches[i]); });
+		}
+
+		//-- finish the queued pipelines and stop. call merge() first to keep what the workers
+		//-- compiled.
+		~PipeScheduler() {
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				stopping = true;
+			}
+			wake.notify_all();
+			for (auto &w : workers)
+				w.join();
+		}
+
+		PipeScheduler(const PipeScheduler&) = delete;
+		PipeScheduler &operator = (const PipeScheduler&) = delete;
+
+		//-- queue the creation of a pipeline into p, whose components must be created. the
+		//-- arguments are copied and passed to p.createPipe on a worker with the worker's
+		//-- cache. anything they point to must outlive the request, and p must not be used
+		//-- until wait() returns.
+		template <typename Components, typename... A>
+		void createPipe(Pipeline<Components> &p, A &&...a) {
+			createPipeAt(0, p, std::forward<A>(a)...);
+		}
+
+		template <typename Components, typename... A>
+		void createPipeAt(int priority, Pipeline<Components> &p, A &&...a) {
+			auto args = std::make_tuple(std::forward<A>(a)...);
+			schedule(priority, [&p, args] (vk::PipelineCache c) mutable {
+				createFromTuple(p, c, args, std::index_sequence_for<A...>());
+			});
+		}
+
+		//-- create a pipeline into p without blocking, returning true if it's ready now. when
+		//-- probeCache is set the master cache is tried first with FailIfUncached, otherwise
+		//-- or on a miss the pipeline is queued at the priority, and p.get() returns p's
+		//-- fallback until a worker has created it. errors are rethrown by wait() as for
+		//-- createPipe, and set p.failed(). p's components must be created, and p must not be
+		//-- destroyed until it's ready or failed.
+		template <typename Components, typename... A>
+		bool createPipeAsync(AsyncPipe<Components> &p, int priority, A &&...a) {
+			p.isReady.store(false, std::memory_order_relaxed);
+			p.isFailed.store(false, std::memory_order_relaxed);
+			if (probeCache) {
+				// the master cache is externally synchronized, and merge() writes to it
+				std::lock_guard<std::mutex> lock(cacheMutex);
+				p.pipeline.createPipe(cache, FailIfUncached(), a...);
+				if (p.pipeline.pipeline != vk::Pipeline()) {
+					p.isReady.store(true, std::memory_order_release);
+					return true;
+				}
+			}
+
+			auto args = std::make_tuple(std::forward<A>(a)...);
+			schedule(priority, [&p, args] (vk::PipelineCache c) mutable {
+				try {
+					createFromTuple(p.pipeline, c, args, std::index_sequence_for<A...>());
+				}
+				catch (...) {
+					p.isFailed.store(true, std::memory_order_release);
+					throw;
+				}
+				p.isReady.store(true, std::memory_order_release);
+			});
+			return false;
+		}
+
+		//-- wait for the queued pipelines, rethrowing the first error a worker hit
+		void wait() {
+			std::unique_lock<std::mutex> lock(mutex);
+			done.wait(lock, [this] { return pending == 0; });
+			if (error) {
+				auto e = error;
+				error = nullptr;
+				std::rethrow_exception(e);
+			}
+		}
+
+		//-- wait for the queued pipelines, then merge the worker caches into the master cache.
+		//-- a createPipeAsync probe on another thread waits for the merge.
+		vk::Result merge() {
+			wait();
+			std::vector<vk::PipelineCache> c(caches.size());
+			for (size_t i = 0; i < c.size(); ++i)
+				c[i] = *caches[i];
+			std::lock_guard<std::mutex> lock(cacheMutex);
+			return device.mergePipelineCaches(cache, uint32_t(c.size()), c.data());
+		}
+
+		//-- queue any work that creates pipelines, to be called on a worker with its cache
+		typedef std::function<void(vk::PipelineCache)> Task;
+
+		void schedule(int priority, Task t) {
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				// equal keys go after those already queued
+				queue.emplace(priority, std::move(t));
+				pending += 1;
+			}
+			wake.notify_one();
+		}
+
+		//-- the master cache, to save once the caches are merged. don't use it while
+		//-- createPipeAsync may probe it or merge() may run on another thread.
+		vk::PipelineCache masterCache() const { return cache; }
+
+		//-- probe the master cache in createPipeAsync. only set it if the device has
+		//-- pipelineCreationCacheControl enabled.
+		bool probeCache = false;
+
+	private:
+		template <typename Components, typename Tuple, size_t... I>
+		static void createFromTuple(Pipeline<Components> &p, vk::PipelineCache c, Tuple &t,
+				std::index_sequence<I...>) {
+			p.createPipe(c, std::get<I>(t)...);
+		}
+
+		void work(vk::PipelineCache c) {
+			std::unique_lock<std::mutex> lock(mutex);
+			for (;;) {
+				wake.wait(lock, [this] { return stopping || !queue.empty(); });
+				if (queue.empty())
+					return;
+				auto t = std::move(queue.begin()->second);
+				queue.erase(queue.begin());
+
+				lock.unlock();
+				std::exception_ptr e;
+				try {
+					t(c);
+				}
+				catch (...) {
+					e = std::current_exception();
+				}
+				lock.lock();
+
+				if (e && !error)
+					error = e;
+				if (--pending == 0)
+					done.notify_all();
+			}
+		}
+
+		vk::Device device;
+		vk::PipelineCache cache;
+		vk::UniquePipelineCache ownCache;
+		std::vector<vk::UniquePipelineCache> caches;
+		std::vector<std::thread> workers;
+
+		std::mutex mutex;
+		std::condition_variable wake, done;
+		std::multimap<int, Task, std::greater<int>> queue;
+		size_t pending = 0;
+		bool stopping = false;
+		std::exception_ptr error;
+
+		// guards the master cache between createPipeAsync probes and merge()
+		std::mutex cacheMutex;
+	};
+
+} // namespace autoshader
+
+#endif // H_AUTOSHADER_PIPESCHEDULER_H__
@@ -0,0 +1,224 @@
+//
+//  File: reflectformat.h
+//
+//  Created by Jon Spencer on 2026-10-17 00:08:55
+//  Copyright (c) Jon Spencer. See LICENSE file.
+//
+#ifndef H_AUTOSHADER_REFLECTFORMAT_H__
+#define H_AUTOSHADER_REFLECTFORMAT_H__
+
+#include <cstdint>
+#include <cstddef>
+
+namespace autoshader {
+
+	//----------------------------------------------------------------------------------------
+	//-- the binary reflection written by autoshader --reflect-binary. the file is a header
+	//-- followed by tables of fixed size records and a string table, all little endian 32 bit
+	//-- words so a mapped file can be used in place. sections are located by byte offset from
+	//-- the start of the file and strings by byte offset into the string table, with offset
+	//-- zero the empty string. enumerations hold the vulkan (VkShaderStageFlagBits,
+	//-- VkDescriptorType, VkFormat) or spirv (Dim) values.
+
+	namespace reflectformat {
+
+		constexpr uint32_t magic = 0x46525341;  // "ASRF"
+		constexpr uint32_t version = 1;
+		constexpr uint32_t noIndex = ~0u;
+
+		struct Section {
+			uint32_t offset;
+			uint32_t count;
+		};
+
+		struct Header {
+			uint32_t magic;
+			uint32_t version;
+			uint32_t size;
+			uint32_t stageFlags;
+			uint32_t vertexName;
+			uint32_t vertexStride;
+			Section stages;
+			Section structs;
+			Section members;
+			Section dimensions;
+			Section descriptors;
+			Section pushRanges;
+			Section attributes;
+			Section specConstants;
+			Section strings;
+		};
+
+		//-- a shader stage in pipeline order
+		struct Stage {
+			uint32_t stage;
+			uint32_t entryPoint;
+		};
+
+		//-- a buffer structure, with its members contiguous in the member table
+		struct Struct {
+			uint32_t name;
+			uint32_t size;
+			uint32_t firstMember;
+			uint32_t memberCount;
+		};
+
+		//-- a structure member. size is that of one element, structure members refer to the
+		//-- structure table and the array dimensions are outermost first.
+		struct Member {
+			uint32_t name;
+			uint32_t type;
+			uint32_t structIndex;
+			uint32_t offset;
+			uint32_t size;
+			uint32_t matrixStride;
+			uint32_t arrayStride;
+			uint32_t firstDimension;
+			uint32_t dimensionCount;
+		};
+
+		//-- a descriptor binding, count is zero for a runtime sized array
+		struct Descriptor {
+			uint32_t set;
+			uint32_t binding;
+			uint32_t descriptorType;
+			uint32_t count;
+			uint32_t stageFlags;
+			uint32_t imageDim;
+			uint32_t name;
+		};
+
+		struct PushRange {
+			uint32_t stageFlags;
+			uint32_t offset;
+			uint32_t size;
+		};
+
+		//-- a vertex attribute, at its offset in the tightly packed vertex structure
+		struct Attribute {
+			uint32_t location;
+			uint32_t format;
+			uint32_t offset;
+			uint32_t size;
+			uint32_t type;
+			uint32_t name;
+		};
+
+		struct SpecConstant {
+			uint32_t stage;
+			uint32_t constantId;
+			uint32_t type;
+			uint32_t name;
+		};
+
+		//-- a view of one of the tables
+		template <typename T>
+		struct Table {
+			const T *first = nullptr;
+			uint32_t count = 0;
+
+			const T *begin() const { return first; }
+			const T *end() const { return first + count; }
+			uint32_t size() const { return count; }
+			bool empty() const { return count == 0; }
+			const T &operator [] (size_t i) const { return first[i]; }
+		};
+
+	} // namespace reflectformat
+
+	//----------------------------------------------------------------------------------------
+	//-- ReflectView - checks the header and section bounds of a binary reflection once, then
+	//-- reads the records in place. nothing is copied or parsed.
+
+	struct ReflectView {
+		const uint8_t *data = nullptr;
+		const reflectformat::Header *header = nullptr;
+
+		ReflectView() {}
+		ReflectView(const void *p, size_t size) { open(p, size); }
+
+		bool open(const void *p, size_t size) {
+			using namespace reflectformat;
+			data = nullptr;
+			header = nullptr;
+			auto h = static_cast<const Header*>(p);
+			if (p == nullptr || reinterpret_cast<uintptr_t>(p) % 4 != 0 || size < sizeof(Header))
+				return false;
+			if (h->magic != magic || h->version != version || h->size > size)
+				return false;
+
+			auto d = static_cast<const uint8_t*>(p);
+			if (!fits<Stage>(h->stages, h->size) || !fits<Struct>(h->structs, h->size) ||
+					!fits<Member>(h->members, h->size) || !fits<uint32_t>(h->dimensions, h->size) ||
+					!fits<Descriptor>(h->descriptors, h->size) ||
+					!fits<reflectformat::PushRange>(h->pushRanges, h->size) ||
+					!fits<Attribute>(h->attributes, h->size) ||
+					!fits<SpecConstant>(h->specConstants, h->size) || !fits<char>(h->strings, h->size))
+				return false;
+
+			// the string table starts with the empty string and every string is terminated
+			if (h->strings.count == 0 || d[h->strings.offset] != 0 ||
+					d[h->strings.offset + h->strings.count - 1] != 0)
+				return false;
+
+			data = d;
+			header = h;
+			return true;
+		}
+
+		bool valid() const { return header != nullptr; }
+
+		reflectformat::Table<reflectformat::Stage> stages() const {
+			return table<reflectformat::Stage>(header->stages); }
+		reflectformat::Table<reflectformat::Struct> structs() const {
+			return table<reflectformat::Struct>(header->structs); }
+		reflectformat::Table<reflectformat::Descriptor> descriptors() const {
+			return table<reflectformat::Descriptor>(header->descriptors); }
+		reflectformat::Table<reflectformat::PushRange> pushRanges() const {
+			return table<reflectformat::PushRange>(header->pushRanges); }
+		reflectformat::Table<reflectformat::Attribute> attributes() const {
+			return table<reflectformat::Attribute>(header->attributes); }
+		reflectformat::Table<reflectformat::SpecConstant> specConstants() const {
+			return table<reflectformat::SpecConstant>(header->specConstants); }
+
+		reflectformat::Table<reflectformat::Member> members(const reflectformat::Struct &s) const {
+			return slice(table<reflectformat::Member>(header->members), s.firstMember,
+				s.memberCount); }
+		reflectformat::Table<uint32_t> dimensions(const reflectformat::Member &m) const {
+			return slice(table<uint32_t>(header->dimensions), m.firstDimension, m.dimensionCount); }
+
+		//-- a string from the table, empty when the offset is out of range
+		const char *string(uint32_t offset) const {
+			auto s = reinterpret_cast<const char*>(data + header->strings.offset);
+			return offset < header->strings.count ? s + offset : s;
+		}
+
+	private:
+		template <typename T>
+		static bool fits(const reflectformat::Section &s, uint32_t size) {
+			return s.offset % alignof(uint32_t) == 0 && s.offset <= size &&
+				uint64_t(s.count) * sizeof(T) <= size - s.offset;
+		}
+
+		template <typename T>
+		reflectformat::Table<T> table(const reflectformat::Section &s) const {
+			reflectformat::Table<T> r;
+			r.first = reinterpret_cast<const T*>(data + s.offset);
+			r.count = s.count;
+			return r;
+		}
+
+		template <typename T>
+		static reflectformat::Table<T> slice(reflectformat::Table<T> t, uint32_t first,
+				uint32_t count) {
+			if (first > t.count || count > t.count - first)
+				return reflectformat::Table<T>();
+			t.first += first;
+			t.count = count;
+			return t;
+		}
+	};
+
+} // namespace autoshader
+
+#endif // H_AUTOSHADER_REFLECTFORMAT_H__
@@ -0,0 +1,77 @@
+//
+//  File: shaderobjects.h
+//
+//  Created by Jon Spencer on 2026-10-17 00:40:31
+//  Copyright (c) Jon Spencer. See LICENSE file.
+//
+#ifndef H_AUTOSHADER_SHADEROBJECTS_H__
+#define H_AUTOSHADER_SHADEROBJECTS_H__
+
+#include "createpipe.h"
+
+#ifdef VK_EXT_shader_object
+
+namespace autoshader {
+
+	//----------------------------------------------------------------------------------------
+	//-- ShaderObjects - the stages of one set of Components as linked shader objects, for
+	//-- drawing without a vk::Pipeline. there is nothing to compile when a new combination of
+	//-- state is first drawn, as all of it is set by bind(). the device needs shaderObject
+	//-- enabled, and the extension commands need AUTOSHADER_EXTENSION_DISPATCH.
+
+	template <typename Components>
+	struct ShaderObjects {
+		static constexpr size_t stageCount =
+			std::tuple_size<decltype(Components::stageFlags())>::value;
+
+		ShaderObjects() {}
+		ShaderObjects(ShaderObjects &&o) noexcept { swap(o); }
+		ShaderObjects &operator = (ShaderObjects &&o) noexcept { swap(o); return *this; }
+
+		template <typename... A>
+		ShaderObjects(vk::Device d, A &&...a) : components(d) { createShaders(std::forward<A>(a)...); }
+
+		~ShaderObjects() { destroy(); }
+
+		//-- create the shaders, destroying any there were. returns the error if they couldn't be
+		//-- created, leaving no shaders.
+		template <typename... A>
+		vk::Result createShaders(A &&...a) {
+			destroy();
+			auto r = components.createShaders(shaders, std::forward<A>(a)...);
+			if (r != vk::Result::eSuccess)
+				shaders.fill(vk::ShaderEXT());
+			return r;
+		}
+
+		//-- bind the shaders and set the state, from the arguments a pipeline would be created
+		//-- with (see autoshader::bindShaders)
+		template <typename... A>
+		void bind(vk::CommandBuffer cb, A &&...a) const {
+			Components::cmdBindShaders(cb, shaders, std::forward<A>(a)...);
+		}
+
+		bool valid() const { return shaders[0] != vk::ShaderEXT(); }
+
+		void destroy() {
+			for (auto &s : shaders) {
+				if (s != vk::ShaderEXT())
+					components.device.destroyShaderEXT(s);
+				s = vk::ShaderEXT();
+			}
+		}
+
+		void swap(ShaderObjects<Components> &o) {
+			components.swap(o.components);
+			std::swap(shaders, o.shaders);
+		}
+
+		Components components;
+		std::array<vk::ShaderEXT, stageCount> shaders;
+	};
+
+} // namespace autoshader
+
+#endif // VK_EXT_shader_object
+
+#endif // H_AUTOSHADER_SHADEROBJECTS_H__
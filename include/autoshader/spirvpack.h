@@ -0,0 +1,75 @@
+//
+//  File: spirvpack.h
+//
+//  Created by Jon Spencer on 2026-10-16 13:41:52
+//  Copyright (c) Jon Spencer. See LICENSE file.
+//
+#ifndef H_AUTOSHADER_SPIRVPACK_H__
+#define H_AUTOSHADER_SPIRVPACK_H__
+
+#include <cstdint>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+namespace autoshader {
+
+	//----------------------------------------------------------------------------------------
+	//-- the packed spirv format written by autoshader --compress. every value is a
+	//-- little endian base 128 varint. the stream starts with the word count followed by
+	//-- tokens until all the words are produced:
+	//--   (n - 1) << 1      followed by n literal words
+	//--   (n - 2) << 1 | 1  followed by a distance, copy n words from that many words back
+
+	namespace spirvpack {
+
+		inline uint32_t read(const uint8_t *&p, const uint8_t *e) {
+			uint64_t v = 0;
+			for (unsigned s = 0; s < 35; s += 7) {
+				if (p == e)
+					break;
+				uint8_t b = *p++;
+				v |= uint64_t(b & 0x7f) << s;
+				if ((b & 0x80) == 0) {
+					if (v > 0xffffffff)
+						break;
+					return uint32_t(v);
+				}
+			}
+			throw std::runtime_error("corrupt packed spirv");
+		}
+
+	} // namespace spirvpack
+
+	//----------------------------------------------------------------------------------------
+	//-- unpackSpirv - decode packed spirv into a scratch buffer, returning the words
+
+	inline const uint32_t *unpackSpirv(std::vector<uint32_t> &r, const uint8_t *p, size_t n) {
+		using spirvpack::read;
+		auto e = p + n;
+		size_t count = read(p, e);
+		r.resize(count);
+		for (size_t i = 0; i < count;) {
+			uint32_t t = read(p, e);
+			size_t l = (t >> 1) + 1 + (t & 1);
+			if (l > count - i)
+				throw std::runtime_error("corrupt packed spirv");
+			if ((t & 1) == 0) {
+				for (size_t j = 0; j < l; ++j)
+					r[i++] = read(p, e);
+			}
+			else {
+				size_t d = read(p, e);
+				if (d == 0 || d > i)
+					throw std::runtime_error("corrupt packed spirv");
+				// copy a word at a time, the source may overlap what's being written
+				for (size_t j = 0; j < l; ++j, ++i)
+					r[i] = r[i - d];
+			}
+		}
+		return r.data();
+	}
+
+} // namespace autoshader
+
+#endif // H_AUTOSHADER_SPIRVPACK_H__
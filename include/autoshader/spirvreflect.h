@@ -0,0 +1,107 @@
+//
+//  File: spirvreflect.h
+//
+//  Created by Jon Spencer on 2026-10-17 00:14:10
+//  Copyright (c) Jon Spencer. See LICENSE file.
+//
+#ifndef H_AUTOSHADER_SPIRVREFLECT_H__
+#define H_AUTOSHADER_SPIRVREFLECT_H__
+
+#include "vulkan/vulkan.hpp"
+#include <cstdint>
+#include <cstddef>
+#include <initializer_list>
+#include <vector>
+
+namespace autoshader {
+
+	//----------------------------------------------------------------------------------------
+	//-- the runtime reflection library (autoshader-reflect) builds the same descriptor set
+	//-- layout bindings, push constant ranges and vertex input as the generated
+	//-- get...LayoutBindings(), getPushConstantRanges() and getVertex...() functions, from
+	//-- spirv loaded at runtime. the vertex attributes are at their offsets in a tightly
+	//-- packed vertex structure and runtime sized descriptor arrays have a count of zero.
+	//-- set numbers are limited to maxReflectSets.
+
+	constexpr uint32_t maxReflectSets = 32;
+
+	enum struct ReflectError {
+		None,
+		InvalidSpirv,
+		NoEntryPoint,
+		UnsupportedStage,
+		UnsupportedType,
+		UnsupportedSet,
+		DescriptorMismatch,
+		LayoutMismatch,
+	};
+
+	//----------------------------------------------------------------------------------------
+	//-- SpirvCode - the words of one shader stage
+
+	struct SpirvCode {
+		const uint32_t *code;
+		size_t size;
+	};
+
+	//----------------------------------------------------------------------------------------
+	//-- LayoutReflection - the layouts of a pipeline. sets holds the bindings of each set
+	//-- number, sorted by binding, with an empty vector for unused set numbers.
+
+	struct LayoutReflection {
+		std::vector<vk::ShaderStageFlagBits> stages;
+		std::vector<std::vector<vk::DescriptorSetLayoutBinding>> sets;
+		std::vector<vk::PushConstantRange> pushRanges;
+		vk::VertexInputBindingDescription vertexBinding;
+		std::vector<vk::VertexInputAttributeDescription> vertexAttributes;
+
+		void clear();
+	};
+
+	//----------------------------------------------------------------------------------------
+	//-- LayoutReflector - reflects pipelines, keeping its scratch space between calls so
+	//-- reflecting on the load path doesn't allocate once it has warmed up
+
+	struct LayoutReflector {
+		struct Scratch;
+
+		LayoutReflector();
+		~LayoutReflector();
+		LayoutReflector(const LayoutReflector&) = delete;
+		LayoutReflector &operator = (const LayoutReflector&) = delete;
+
+		//-- reflect the stages into r, returning ReflectError::None on success. r is cleared
+		//-- first and its storage reused.
+		ReflectError reflect(LayoutReflection &r, const SpirvCode *stages, size_t count);
+
+		ReflectError reflect(LayoutReflection &r, std::initializer_list<SpirvCode> stages) {
+			return reflect(r, stages.begin(), stages.size()); }
+
+		Scratch *scratch;
+	};
+
+	//----------------------------------------------------------------------------------------
+	//-- reflectLayouts - reflect the stages with a temporary reflector
+
+	ReflectError reflectLayouts(LayoutReflection &r, const SpirvCode *stages, size_t count);
+
+	inline ReflectError reflectLayouts(LayoutReflection &r, std::initializer_list<SpirvCode> stages) {
+		return reflectLayouts(r, stages.begin(), stages.size()); }
+
+	//----------------------------------------------------------------------------------------
+	//-- checkLayoutCompatible - check that stages reflected into code can run with the
+	//-- layouts of a pipeline, returning ReflectError::LayoutMismatch if they can't. each
+	//-- descriptor must be in the layout with the same type, its stages and at least its count
+	//-- (any count for a runtime sized layout binding), the push constants must be in ranges
+	//-- of their stages, and the vertex attributes must have the same locations and formats.
+
+	ReflectError checkLayoutCompatible(const LayoutReflection &layout, const LayoutReflection &code);
+
+	//----------------------------------------------------------------------------------------
+	//-- reflectErrorString - a description of a reflection error
+
+	const char *reflectErrorString(ReflectError e);
+
+} // namespace autoshader
+
+#endif // H_AUTOSHADER_SPIRVREFLECT_H__
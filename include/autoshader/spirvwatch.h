@@ -0,0 +1,49 @@
+//
+//  File: spirvwatch.h
+//
+//  Created by Jon Spencer on 2026-10-17 00:18:07
+//  Copyright (c) Jon Spencer. See LICENSE file.
+//
+#ifndef H_AUTOSHADER_SPIRVWATCH_H__
+#define H_AUTOSHADER_SPIRVWATCH_H__
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace autoshader {
+
+	//----------------------------------------------------------------------------------------
+	//-- SpirvWatcher - watches spirv files so a running program can reload its shaders. on
+	//-- linux the directories of the files are watched with inotify, so a file written or
+	//-- renamed into place is seen as soon as it's closed. elsewhere the modification times
+	//-- are polled.
+
+	struct SpirvWatcher {
+		struct State;
+
+		SpirvWatcher();
+		~SpirvWatcher();
+		SpirvWatcher(const SpirvWatcher&) = delete;
+		SpirvWatcher &operator = (const SpirvWatcher&) = delete;
+
+		//-- watch a file, setting index to the value poll reports for it. returns false if the
+		//-- file's directory can't be watched.
+		bool watch(const std::string &path, size_t &index);
+
+		//-- wait up to timeout milliseconds (forever if negative) for watched files to change,
+		//-- appending the index of each changed file to changed once. returns the number added.
+		size_t poll(std::vector<size_t> &changed, int timeout = 0);
+
+		State *state;
+	};
+
+	//----------------------------------------------------------------------------------------
+	//-- readSpirv - read a spirv file, returning false if it can't be read or isn't spirv
+
+	bool readSpirv(const std::string &path, std::vector<uint32_t> &words);
+
+} // namespace autoshader
+
+#endif // H_AUTOSHADER_SPIRVWATCH_H__
@@ -0,0 +1,729 @@
+//
+//  File: spirvreflect.cpp
+//
+//  Created by Jon Spencer on 2026-10-17 00:14:10
+//  Copyright (c) Jon Spencer. See LICENSE file.
+//
+
+#include "autoshader/spirvreflect.h"
+#include "autoshader/layoutrules.h"
+#include <algorithm>
+
+namespace autoshader {
+
+	using std::vector;
+
+	namespace {
+
+		//------------------------------------------------------------------------------------------
+		//-- the parts of the spirv grammar the layouts are built from
+
+		enum : uint32_t {
+			spirvMagic = 0x07230203,
+		};
+
+		// the depth of the arrays and structures followed into a type, past which a type
+		// containing itself is taken as invalid
+		constexpr uint32_t maxTypeDepth = 64;
+
+		enum : uint32_t {
+			OpEntryPoint = 15,
+			OpTypeInt = 21,
+			OpTypeFloat = 22,
+			OpTypeVector = 23,
+			OpTypeMatrix = 24,
+			OpTypeImage = 25,
+			OpTypeSampler = 26,
+			OpTypeSampledImage = 27,
+			OpTypeArray = 28,
+			OpTypeRuntimeArray = 29,
+			OpTypeStruct = 30,
+			OpTypePointer = 32,
+			OpConstant = 43,
+			OpSpecConstant = 50,
+			OpFunction = 54,
+			OpVariable = 59,
+			OpDecorate = 71,
+			OpMemberDecorate = 72,
+		};
+
+		enum : uint32_t {
+			DecorationBlock = 2,
+			DecorationBufferBlock = 3,
+			DecorationRowMajor = 4,
+			DecorationArrayStride = 6,
+			DecorationMatrixStride = 7,
+			DecorationBuiltIn = 11,
+			DecorationLocation = 30,
+			DecorationBinding = 33,
+			DecorationDescriptorSet = 34,
+			DecorationOffset = 35,
+		};
+
+		enum : uint32_t {
+			StorageUniformConstant = 0,
+			StorageInput = 1,
+			StorageUniform = 2,
+			StoragePushConstant = 9,
+			StorageStorageBuffer = 12,
+		};
+
+		enum : uint32_t {
+			DimBuffer = 5,
+			DimSubpassData = 6,
+		};
+
+		enum : uint32_t {
+			FlagBlock = 1,
+			FlagBufferBlock = 2,
+			FlagBuiltIn = 4,
+			FlagRowMajor = 8,
+		};
+
+		//------------------------------------------------------------------------------------------
+		//-- Id: the definition and decorations of a spirv id. the operands depend on the opcode:
+		//--   OpTypeInt (width, signed), OpTypeFloat (width), OpTypeVector (component, count),
+		//--   OpTypeMatrix (column, count), OpTypeImage (dim, sampled), OpTypeSampledImage (image),
+		//--   OpTypeArray (element, length), OpTypeRuntimeArray (element),
+		//--   OpTypeStruct (first member, member count), OpTypePointer (storage, type),
+		//--   OpConstant (type, value), OpVariable (type, storage)
+
+		struct Id {
+			uint32_t op;
+			uint32_t a, b;
+			uint32_t set, binding, location, arrayStride;
+			uint32_t flags;
+		};
+
+		struct Member {
+			uint32_t type, offset, matrixStride, flags;
+		};
+
+		struct MemberDecoration {
+			uint32_t type, member, decoration, value;
+		};
+
+		struct Binding {
+			uint32_t set, binding;
+			layoutrules::DescriptorShape shape;
+			vk::ShaderStageFlags stages;
+		};
+
+		bool stage_flag(uint32_t model, vk::ShaderStageFlagBits &r) {
+			static const vk::ShaderStageFlagBits stages[] = {
+				vk::ShaderStageFlagBits::eVertex,
+				vk::ShaderStageFlagBits::eTessellationControl,
+				vk::ShaderStageFlagBits::eTessellationEvaluation,
+				vk::ShaderStageFlagBits::eGeometry,
+				vk::ShaderStageFlagBits::eFragment,
+				vk::ShaderStageFlagBits::eCompute,
+			};
+			if (model >= sizeof(stages) / sizeof(stages[0]))
+				return false;
+			r = stages[model];
+			return true;
+		}
+
+	} // namespace
+
+
+	//------------------------------------------------------------------------------------------
+	//-- Scratch: the parse of the current stage and the resources gathered from all the stages
+
+	struct LayoutReflector::Scratch {
+		const uint32_t *code = nullptr;
+		vector<Id> ids;
+		vector<Member> members;
+		vector<MemberDecoration> memberDecorations;
+		bool entry = false;
+		uint32_t model = 0;
+		size_t interfaceBegin = 0, interfaceEnd = 0;
+
+		vector<Binding> bindings;
+		vector<layoutrules::StageRange> ranges;
+
+		ReflectError parse(const SpirvCode &s);
+		ReflectError array_length(const Id &t, uint32_t &length) const;
+		ReflectError declared_size(uint32_t type, const Member *m, uint32_t &size,
+			uint32_t depth = 0) const;
+		ReflectError push_size(const Member &m, uint32_t &size) const;
+		ReflectError add_descriptors(uint32_t stage);
+		ReflectError add_push_ranges(uint32_t stage);
+		ReflectError add_vertex_input(LayoutReflection &r) const;
+		bool in_interface(uint32_t id) const;
+		void push_constant_ranges(LayoutReflection &r) const;
+	};
+
+
+	//------------------------------------------------------------------------------------------
+	//-- parse the types, constants, variables and decorations of a stage
+
+	ReflectError LayoutReflector::Scratch::parse(const SpirvCode &s) {
+		if (s.code == nullptr || s.size < 5 || s.code[0] != spirvMagic)
+			return ReflectError::InvalidSpirv;
+
+		// every id is defined by an instruction of at least two words
+		uint32_t bound = s.code[3];
+		if (bound > s.size)
+			return ReflectError::InvalidSpirv;
+
+		code = s.code;
+		ids.assign(bound, Id{});
+		members.clear();
+		memberDecorations.clear();
+		entry = false;
+
+		for (size_t i = 5; i < s.size;) {
+			auto w = s.code + i;
+			uint32_t n = w[0] >> 16, op = w[0] & 0xffff;
+			if (n == 0 || n > s.size - i)
+				return ReflectError::InvalidSpirv;
+
+			// the types and variables are all declared before the first function
+			if (op == OpFunction)
+				break;
+
+			// the result id of a type is the first operand, others have the type first
+			uint32_t rid = 0, min = 0;
+			switch (op) {
+				case OpTypeInt: case OpTypeVector: case OpTypeMatrix: case OpTypeArray:
+				case OpTypePointer:
+					rid = w[1], min = 4;
+					break;
+				case OpTypeFloat: case OpTypeRuntimeArray: case OpTypeSampledImage:
+					rid = w[1], min = 3;
+					break;
+				case OpTypeSampler: case OpTypeStruct:
+					rid = w[1], min = 2;
+					break;
+				case OpTypeImage:
+					rid = w[1], min = 9;
+					break;
+				case OpConstant: case OpSpecConstant: case OpVariable:
+					rid = n > 2 ? w[2] : 0, min = 4;
+					break;
+				case OpEntryPoint: case OpDecorate:
+					min = 3;
+					break;
+				case OpMemberDecorate:
+					min = 4;
+					break;
+				default:
+					break;
+			}
+			if (n < min || rid >= bound)
+				return ReflectError::InvalidSpirv;
+
+			auto &id = ids[rid];
+			switch (op) {
+				case OpTypeInt: case OpTypeVector: case OpTypeMatrix: case OpTypeArray:
+				case OpTypePointer:
+					id.op = op, id.a = w[2], id.b = w[3];
+					break;
+				case OpTypeFloat: case OpTypeRuntimeArray: case OpTypeSampledImage:
+					id.op = op, id.a = w[2];
+					break;
+				case OpTypeSampler:
+					id.op = op;
+					break;
+				case OpTypeImage:
+					id.op = op, id.a = w[3], id.b = w[7];
+					break;
+				case OpTypeStruct:
+					id.op = op, id.a = uint32_t(members.size()), id.b = n - 2;
+					for (uint32_t m = 2; m < n; ++m)
+						members.push_back(Member{ w[m], 0, 0, 0 });
+					break;
+				case OpConstant: case OpSpecConstant: case OpVariable:
+					id.op = op, id.a = w[1], id.b = w[3];
+					break;
+
+				case OpEntryPoint: {
+					// the pipeline stages use the first entry point, the interface follows the name
+					if (entry)
+						break;
+					size_t e = 3;
+					while (e < n && (w[e] >> 24) != 0)
+						++e;
+					if (e == n)
+						return ReflectError::InvalidSpirv;
+					entry = true;
+					model = w[1];
+					interfaceBegin = i + e + 1;
+					interfaceEnd = i + n;
+					break;
+				}
+
+				case OpDecorate: {
+					if (w[1] >= bound)
+						return ReflectError::InvalidSpirv;
+					auto &t = ids[w[1]];
+					uint32_t v = n > 3 ? w[3] : 0;
+					switch (w[2]) {
+						case DecorationBlock: t.flags |= FlagBlock; break;
+						case DecorationBufferBlock: t.flags |= FlagBufferBlock; break;
+						case DecorationBuiltIn: t.flags |= FlagBuiltIn; break;
+						case DecorationArrayStride: t.arrayStride = v; break;
+						case DecorationLocation: t.location = v; break;
+						case DecorationBinding: t.binding = v; break;
+						case DecorationDescriptorSet: t.set = v; break;
+						default: break;
+					}
+					break;
+				}
+
+				case OpMemberDecorate:
+					// the structure may not be declared yet
+					memberDecorations.push_back(MemberDecoration{ w[1], w[2], w[3], n > 4 ? w[4] : 0 });
+					break;
+
+				default:
+					break;
+			}
+
+			i += n;
+		}
+
+		if (!entry)
+			return ReflectError::NoEntryPoint;
+
+		for (auto &d : memberDecorations) {
+			if (d.type >= bound || ids[d.type].op != OpTypeStruct || d.member >= ids[d.type].b)
+				return ReflectError::InvalidSpirv;
+			auto &m = members[ids[d.type].a + d.member];
+			switch (d.decoration) {
+				case DecorationOffset: m.offset = d.value; break;
+				case DecorationMatrixStride: m.matrixStride = d.value; break;
+				case DecorationBuiltIn: m.flags |= FlagBuiltIn; break;
+				case DecorationRowMajor: m.flags |= FlagRowMajor; break;
+				default: break;
+			}
+		}
+
+		return ReflectError::None;
+	}
+
+
+	//------------------------------------------------------------------------------------------
+	//-- the length of an array type, zero for a runtime array
+
+	ReflectError LayoutReflector::Scratch::array_length(const Id &t, uint32_t &length) const {
+		if (t.op == OpTypeRuntimeArray) {
+			length = 0;
+			return ReflectError::None;
+		}
+		if (t.b >= ids.size())
+			return ReflectError::InvalidSpirv;
+		auto &c = ids[t.b];
+		if (c.op != OpConstant && c.op != OpSpecConstant)
+			return ReflectError::UnsupportedType;
+		length = c.b;
+		return ReflectError::None;
+	}
+
+
+	//------------------------------------------------------------------------------------------
+	//-- the declared size of a type, with the strides of the member holding it. depth is the
+	//-- number of structures the type is nested in.
+
+	ReflectError LayoutReflector::Scratch::declared_size(uint32_t type, const Member *m,
+			uint32_t &size, uint32_t depth) const {
+		if (type >= ids.size())
+			return ReflectError::InvalidSpirv;
+		auto &t = ids[type];
+		switch (t.op) {
+			case OpTypeInt: case OpTypeFloat:
+				size = t.a / 8;
+				return ReflectError::None;
+
+			case OpTypeVector: {
+				if (t.a >= ids.size())
+					return ReflectError::InvalidSpirv;
+				size = ids[t.a].a / 8 * t.b;
+				return ReflectError::None;
+			}
+
+			case OpTypeMatrix: {
+				if (t.a >= ids.size())
+					return ReflectError::InvalidSpirv;
+				auto rows = ids[t.a].b;
+				if (m == nullptr || m->matrixStride == 0)
+					return ReflectError::UnsupportedType;
+				size = ((m->flags & FlagRowMajor) != 0 ? rows : t.b) * m->matrixStride;
+				return ReflectError::None;
+			}
+
+			case OpTypeArray: case OpTypeRuntimeArray: {
+				uint32_t length;
+				auto e = array_length(t, length);
+				size = layoutrules::arrayMemberSize(length, t.arrayStride);
+				return e;
+			}
+
+			case OpTypeStruct: {
+				size = 0;
+				if (t.b == 0)
+					return ReflectError::None;
+				if (depth == maxTypeDepth)
+					return ReflectError::InvalidSpirv;
+				auto &last = members[t.a + t.b - 1];
+				auto e = declared_size(last.type, &last, size, depth + 1);
+				size += last.offset;
+				return e;
+			}
+
+			default:
+				break;
+		}
+		return ReflectError::UnsupportedType;
+	}
+
+
+	//------------------------------------------------------------------------------------------
+	//-- the size of a push constant member as the generator sees it - matrices are the size of
+	//-- their components
+
+	ReflectError LayoutReflector::Scratch::push_size(const Member &m, uint32_t &size) const {
+		if (m.type >= ids.size())
+			return ReflectError::InvalidSpirv;
+		auto &t = ids[m.type];
+		if (t.op == OpTypeMatrix) {
+			if (t.a >= ids.size())
+				return ReflectError::InvalidSpirv;
+			uint32_t column;
+			auto e = declared_size(t.a, nullptr, column);
+			size = column * t.b;
+			return e;
+		}
+		return declared_size(m.type, &m, size);
+	}
+
+
+	//------------------------------------------------------------------------------------------
+	//-- gather the descriptors of the current stage
+
+	ReflectError LayoutReflector::Scratch::add_descriptors(uint32_t stage) {
+		for (uint32_t v = 0; size_t(v) < ids.size(); ++v) {
+			auto &var = ids[v];
+			if (var.op != OpVariable)
+				continue;
+			if (var.b != StorageUniformConstant && var.b != StorageUniform &&
+					var.b != StorageStorageBuffer)
+				continue;
+			if (var.a >= ids.size() || ids[var.a].op != OpTypePointer || ids[var.a].b >= ids.size())
+				return ReflectError::InvalidSpirv;
+
+			// the descriptor count is the innermost array length
+			uint32_t count = 1;
+			auto *base = &ids[ids[var.a].b];
+			for (uint32_t depth = 0; base->op == OpTypeArray || base->op == OpTypeRuntimeArray;
+					++depth) {
+				if (depth == maxTypeDepth)
+					return ReflectError::InvalidSpirv;
+				auto e = array_length(*base, count);
+				if (e != ReflectError::None)
+					return e;
+				if (base->a >= ids.size())
+					return ReflectError::InvalidSpirv;
+				base = &ids[base->a];
+			}
+
+			vk::DescriptorType type;
+			uint32_t dim = 0;
+			if (var.b == StorageStorageBuffer) {
+				type = vk::DescriptorType::eStorageBuffer;
+			}
+			else if (var.b == StorageUniform) {
+				if ((base->flags & FlagBufferBlock) != 0)
+					type = vk::DescriptorType::eStorageBuffer;
+				else if ((base->flags & FlagBlock) != 0)
+					type = vk::DescriptorType::eUniformBuffer;
+				else
+					continue;
+			}
+			else if (base->op == OpTypeSampler) {
+				type = vk::DescriptorType::eSampler;
+			}
+			else if (base->op == OpTypeImage || base->op == OpTypeSampledImage) {
+				auto *image = base;
+				if (base->op == OpTypeSampledImage) {
+					if (base->a >= ids.size() || ids[base->a].op != OpTypeImage)
+						return ReflectError::InvalidSpirv;
+					image = &ids[base->a];
+				}
+				dim = image->a;
+				if (dim == DimBuffer || dim == DimSubpassData)
+					return ReflectError::UnsupportedType;
+				if (base->op == OpTypeSampledImage)
+					type = vk::DescriptorType::eCombinedImageSampler;
+				else if (image->b == 2)
+					type = vk::DescriptorType::eStorageImage;
+				else
+					type = vk::DescriptorType::eSampledImage;
+			}
+			else {
+				continue;
+			}
+
+			if (var.set >= maxReflectSets)
+				return ReflectError::UnsupportedSet;
+
+			// merge with a previous stage's declaration
+			layoutrules::DescriptorShape shape{ uint32_t(type), dim, count };
+			auto b = std::find_if(bindings.begin(), bindings.end(), [&var] (const Binding &b) {
+				return b.set == var.set && b.binding == var.binding; });
+			if (b == bindings.end()) {
+				bindings.push_back(Binding{ var.set, var.binding, shape,
+					vk::ShaderStageFlagBits(stage) });
+			}
+			else {
+				if (layoutrules::descriptorConflict(b->shape, shape) !=
+						layoutrules::DescriptorConflict::None)
+					return ReflectError::DescriptorMismatch;
+				b->stages |= vk::ShaderStageFlagBits(stage);
+			}
+		}
+		return ReflectError::None;
+	}
+
+
+	//------------------------------------------------------------------------------------------
+	//-- gather the contiguous ranges of the push constants used by the current stage
+
+	ReflectError LayoutReflector::Scratch::add_push_ranges(uint32_t stage) {
+		for (uint32_t v = 0; size_t(v) < ids.size(); ++v) {
+			auto &var = ids[v];
+			if (var.op != OpVariable || var.b != StoragePushConstant)
+				continue;
+			if (var.a >= ids.size() || ids[var.a].op != OpTypePointer || ids[var.a].b >= ids.size())
+				return ReflectError::InvalidSpirv;
+			auto &type = ids[ids[var.a].b];
+			if (type.op != OpTypeStruct)
+				return ReflectError::UnsupportedType;
+
+			layoutrules::PushBlockRanges block(ranges, stage);
+			for (uint32_t i = 0; i < type.b; ++i) {
+				auto &m = members[type.a + i];
+				uint32_t size;
+				auto e = push_size(m, size);
+				if (e != ReflectError::None)
+					return e;
+				block.member(m.offset, size);
+			}
+			block.finish();
+
+			// a stage has one push constant block
+			break;
+		}
+		return ReflectError::None;
+	}
+
+
+	//------------------------------------------------------------------------------------------
+	//-- check if a variable is in the entry point's interface
+
+	bool LayoutReflector::Scratch::in_interface(uint32_t id) const {
+		return std::find(code + interfaceBegin, code + interfaceEnd, id) != code + interfaceEnd;
+	}
+
+
+	//------------------------------------------------------------------------------------------
+	//-- the vertex attributes of the current stage, in a tightly packed structure
+
+	ReflectError LayoutReflector::Scratch::add_vertex_input(LayoutReflection &r) const {
+		layoutrules::VertexPacker packer;
+		r.vertexAttributes.clear();
+		for (uint32_t v = 0; size_t(v) < ids.size(); ++v) {
+			auto &var = ids[v];
+			if (var.op != OpVariable || var.b != StorageInput || (var.flags & FlagBuiltIn) != 0)
+				continue;
+			if (var.a >= ids.size() || ids[var.a].op != OpTypePointer || ids[var.a].b >= ids.size())
+				return ReflectError::InvalidSpirv;
+			if (!in_interface(v))
+				continue;
+
+			uint32_t count = 1;
+			auto *base = &ids[ids[var.a].b];
+			for (uint32_t depth = 0; base->op == OpTypeArray; ++depth) {
+				if (depth == maxTypeDepth)
+					return ReflectError::InvalidSpirv;
+				uint32_t length;
+				auto e = array_length(*base, length);
+				if (e != ReflectError::None)
+					return e;
+				count *= length;
+				if (base->a >= ids.size())
+					return ReflectError::InvalidSpirv;
+				base = &ids[base->a];
+			}
+
+			uint32_t components = 1;
+			auto *scalar = base;
+			if (base->op == OpTypeVector) {
+				if (base->a >= ids.size())
+					return ReflectError::InvalidSpirv;
+				components = base->b;
+				scalar = &ids[base->a];
+			}
+			if (scalar->op != OpTypeInt && scalar->op != OpTypeFloat)
+				return ReflectError::UnsupportedType;
+			uint32_t width = scalar->a;
+			if (!layoutrules::vertexFormatSupported(width, components))
+				return ReflectError::UnsupportedType;
+			auto c = scalar->op == OpTypeFloat ? layoutrules::VertexComponent::Sfloat :
+				scalar->b != 0 ? layoutrules::VertexComponent::Sint : layoutrules::VertexComponent::Uint;
+			auto format = vk::Format(layoutrules::vertexFormat(c, width, components));
+			r.vertexAttributes.push_back(vk::VertexInputAttributeDescription{ var.location, 0,
+				format, packer.add(width, components, count) });
+		}
+
+		if (!r.vertexAttributes.empty()) {
+			r.vertexBinding = vk::VertexInputBindingDescription{ 0, packer.stride(),
+				vk::VertexInputRate::eVertex };
+		}
+		return ReflectError::None;
+	}
+
+
+	//------------------------------------------------------------------------------------------
+	//-- split the push constants of all the stages into ranges used by the same stages
+
+	void LayoutReflector::Scratch::push_constant_ranges(LayoutReflection &r) const {
+		layoutrules::splitPushRanges(ranges, [&r] (uint32_t stages, uint32_t start, uint32_t end) {
+			r.pushRanges.push_back(vk::PushConstantRange{ vk::ShaderStageFlags(stages), start,
+				end - start });
+		});
+	}
+
+
+	//------------------------------------------------------------------------------------------
+	//-- clear the layouts, keeping their storage
+
+	void LayoutReflection::clear() {
+		stages.clear();
+		for (auto &s : sets)
+			s.clear();
+		pushRanges.clear();
+		vertexBinding = vk::VertexInputBindingDescription{};
+		vertexAttributes.clear();
+	}
+
+
+	LayoutReflector::LayoutReflector() : scratch(new Scratch) {}
+
+	LayoutReflector::~LayoutReflector() { delete scratch; }
+
+
+	//------------------------------------------------------------------------------------------
+	//-- reflect the layouts of the stages
+
+	ReflectError LayoutReflector::reflect(LayoutReflection &r, const SpirvCode *stages,
+			size_t count) {
+		auto &s = *scratch;
+		r.clear();
+		s.bindings.clear();
+		s.ranges.clear();
+
+		for (size_t i = 0; i < count; ++i) {
+			auto e = s.parse(stages[i]);
+			vk::ShaderStageFlagBits stage;
+			if (e == ReflectError::None && !stage_flag(s.model, stage))
+				e = ReflectError::UnsupportedStage;
+			if (e == ReflectError::None)
+				e = s.add_descriptors(uint32_t(stage));
+			if (e == ReflectError::None)
+				e = s.add_push_ranges(uint32_t(stage));
+			if (e == ReflectError::None && stage == vk::ShaderStageFlagBits::eVertex)
+				e = s.add_vertex_input(r);
+			if (e != ReflectError::None) {
+				r.clear();
+				return e;
+			}
+			r.stages.push_back(stage);
+		}
+
+		// the bindings of each set in binding order, like the generated layouts
+		std::sort(s.bindings.begin(), s.bindings.end(), [] (const Binding &a, const Binding &b) {
+			return a.set != b.set ? a.set < b.set : a.binding < b.binding; });
+		r.sets.resize(s.bindings.empty() ? 0 : s.bindings.back().set + 1);
+		for (auto &b : s.bindings) {
+			r.sets[b.set].push_back(vk::DescriptorSetLayoutBinding{ b.binding,
+				vk::DescriptorType(b.shape.type), b.shape.count, b.stages });
+		}
+
+		s.push_constant_ranges(r);
+		return ReflectError::None;
+	}
+
+
+	//------------------------------------------------------------------------------------------
+	//-- reflect the stages with a temporary reflector
+
+	ReflectError reflectLayouts(LayoutReflection &r, const SpirvCode *stages, size_t count) {
+		LayoutReflector reflector;
+		return reflector.reflect(r, stages, count);
+	}
+
+
+	//------------------------------------------------------------------------------------------
+	//-- check the code's interface is in the layout
+
+	ReflectError checkLayoutCompatible(const LayoutReflection &layout, const LayoutReflection &code) {
+		for (size_t s = 0; s < code.sets.size(); ++s) {
+			for (auto &b : code.sets[s]) {
+				if (s >= layout.sets.size())
+					return ReflectError::LayoutMismatch;
+				auto &ls = layout.sets[s];
+				auto l = std::find_if(ls.begin(), ls.end(), [&b] (const vk::DescriptorSetLayoutBinding &l) {
+					return l.binding == b.binding; });
+				if (l == ls.end() || l->descriptorType != b.descriptorType ||
+						(b.stageFlags & ~l->stageFlags) ||
+						(l->descriptorCount != 0 && (b.descriptorCount == 0 ||
+						b.descriptorCount > l->descriptorCount)))
+					return ReflectError::LayoutMismatch;
+			}
+		}
+
+		// every byte of a push constant range must be in layout ranges with its stages
+		for (auto &p : code.pushRanges) {
+			uint32_t at = p.offset, end = p.offset + p.size;
+			while (at < end) {
+				auto l = std::find_if(layout.pushRanges.begin(), layout.pushRanges.end(),
+					[&p, at] (const vk::PushConstantRange &l) {
+						return l.offset <= at && at < l.offset + l.size &&
+							(p.stageFlags & ~l.stageFlags) == vk::ShaderStageFlags(); });
+				if (l == layout.pushRanges.end())
+					return ReflectError::LayoutMismatch;
+				at = l->offset + l->size;
+			}
+		}
+
+		for (auto &a : code.vertexAttributes) {
+			auto l = std::find_if(layout.vertexAttributes.begin(), layout.vertexAttributes.end(),
+				[&a] (const vk::VertexInputAttributeDescription &l) { return l.location == a.location; });
+			if (l == layout.vertexAttributes.end() || l->format != a.format)
+				return ReflectError::LayoutMismatch;
+		}
+
+		return ReflectError::None;
+	}
+
+
+	//------------------------------------------------------------------------------------------
+	//-- a description of a reflection error
+
+	const char *reflectErrorString(ReflectError e) {
+		switch (e) {
+			case ReflectError::None: return "success";
+			case ReflectError::InvalidSpirv: return "invalid spirv";
+			case ReflectError::NoEntryPoint: return "shader stage has no entry point";
+			case ReflectError::UnsupportedStage: return "unsupported shader stage";
+			case ReflectError::UnsupportedType: return "unsupported type in the shader interface";
+			case ReflectError::UnsupportedSet: return "descriptor set number out of range";
+			case ReflectError::DescriptorMismatch: return "descriptor declared differently by two stages";
+			case ReflectError::LayoutMismatch: return "shader is not compatible with the pipeline layout";
+		}
+		return "unknown reflection error";
+	}
+
+} // namespace autoshader
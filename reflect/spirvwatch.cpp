@@ -0,0 +1,204 @@
+//
+//  File: spirvwatch.cpp
+//
+//  Created by Jon Spencer on 2026-10-17 00:18:07
+//  Copyright (c) Jon Spencer. See LICENSE file.
+//
+
+#include "autoshader/spirvwatch.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <thread>
+
+#ifdef __linux__
+#include <cerrno>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#else
+#include <sys/types.h>
+#include <sys/stat.h>
+#endif
+
+namespace autoshader {
+
+	namespace {
+
+		//------------------------------------------------------------------------------------------
+		//-- append an index once
+
+		void add_change(std::vector<size_t> &changed, size_t begin, size_t index) {
+			if (std::find(changed.begin() + begin, changed.end(), index) == changed.end())
+				changed.push_back(index);
+		}
+
+	} // namespace
+
+	#ifdef __linux__
+
+	//------------------------------------------------------------------------------------------
+	//-- State: the inotify instance and the watched files by directory watch and name
+
+	struct SpirvWatcher::State {
+		typedef std::pair<int, std::string> WatchName;
+
+		int fd = -1;
+		size_t count = 0;
+		std::map<WatchName, std::vector<size_t>> files;
+		std::vector<char> buf = std::vector<char>(16 * 1024);
+	};
+
+
+	SpirvWatcher::SpirvWatcher() : state(new State) {
+		state->fd = inotify_init1(IN_CLOEXEC | IN_NONBLOCK);
+	}
+
+	SpirvWatcher::~SpirvWatcher() {
+		if (state->fd >= 0)
+			close(state->fd);
+		delete state;
+	}
+
+
+	//------------------------------------------------------------------------------------------
+	//-- watch the directory of the file, so files replaced by a rename are seen
+
+	bool SpirvWatcher::watch(const std::string &path, size_t &index) {
+		if (state->fd < 0)
+			return false;
+		auto s = path.rfind('/');
+		auto dir = s == std::string::npos ? std::string(".") : s == 0 ? std::string("/") : path.substr(0, s);
+		auto name = s == std::string::npos ? path : path.substr(s + 1);
+		int wd = inotify_add_watch(state->fd, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+		if (wd < 0)
+			return false;
+		index = state->count++;
+		state->files[State::WatchName(wd, name)].push_back(index);
+		return true;
+	}
+
+
+	//------------------------------------------------------------------------------------------
+	//-- wait for events, then take all that are queued
+
+	size_t SpirvWatcher::poll(std::vector<size_t> &changed, int timeout) {
+		auto begin = changed.size();
+		if (state->fd < 0)
+			return 0;
+
+		for (;;) {
+			pollfd pfd{ state->fd, POLLIN, 0 };
+			int n = ::poll(&pfd, 1, timeout);
+			if (n < 0 && errno == EINTR)
+				continue;
+			if (n <= 0)
+				break;
+
+			auto l = read(state->fd, state->buf.data(), state->buf.size());
+			if (l <= 0)
+				break;
+			for (ssize_t o = 0; o < l;) {
+				auto e = reinterpret_cast<const inotify_event*>(state->buf.data() + o);
+				o += sizeof(inotify_event) + e->len;
+				if (e->len == 0)
+					continue;
+				auto f = state->files.find(State::WatchName(e->wd, e->name));
+				if (f == state->files.end())
+					continue;
+				for (auto i : f->second)
+					add_change(changed, begin, i);
+			}
+
+			// events for other files in the directories don't end the wait
+			if (changed.size() != begin)
+				timeout = 0;
+		}
+
+		return changed.size() - begin;
+	}
+
+	#else
+
+	//------------------------------------------------------------------------------------------
+	//-- State: the watched files with their last modification time and size
+
+	struct SpirvWatcher::State {
+		struct File {
+			std::string path;
+			time_t mtime;
+			off_t size;
+		};
+
+		std::vector<File> files;
+	};
+
+	namespace {
+
+		void file_stat(SpirvWatcher::State::File &f) {
+			struct stat s;
+			if (stat(f.path.c_str(), &s) != 0) {
+				f.mtime = 0, f.size = -1;
+				return;
+			}
+			f.mtime = s.st_mtime, f.size = s.st_size;
+		}
+
+	} // namespace
+
+
+	SpirvWatcher::SpirvWatcher() : state(new State) {}
+
+	SpirvWatcher::~SpirvWatcher() { delete state; }
+
+
+	bool SpirvWatcher::watch(const std::string &path, size_t &index) {
+		State::File f{ path, 0, -1 };
+		file_stat(f);
+		index = state->files.size();
+		state->files.push_back(f);
+		return true;
+	}
+
+
+	//------------------------------------------------------------------------------------------
+	//-- check the files every few milliseconds until one changes or the time is up
+
+	size_t SpirvWatcher::poll(std::vector<size_t> &changed, int timeout) {
+		auto begin = changed.size();
+		auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout);
+		for (;;) {
+			for (size_t i = 0; i < state->files.size(); ++i) {
+				auto f = state->files[i];
+				file_stat(state->files[i]);
+				if (f.mtime != state->files[i].mtime || f.size != state->files[i].size)
+					add_change(changed, begin, i);
+			}
+			if (changed.size() != begin || (timeout >= 0 && std::chrono::steady_clock::now() >= end))
+				break;
+			std::this_thread::sleep_for(std::chrono::milliseconds(5));
+		}
+		return changed.size() - begin;
+	}
+
+	#endif
+
+
+	//------------------------------------------------------------------------------------------
+	//-- read the words of a spirv file
+
+	bool readSpirv(const std::string &path, std::vector<uint32_t> &words) {
+		std::ifstream str(path, std::ios::binary);
+		if (!str)
+			return false;
+		std::string s((std::istreambuf_iterator<char>(str)), std::istreambuf_iterator<char>());
+		if (s.size() < 20 || s.size() % 4 != 0)
+			return false;
+		words.resize(s.size() / 4);
+		std::copy(s.begin(), s.end(), reinterpret_cast<char*>(words.data()));
+		return words[0] == 0x07230203;
+	}
+
+} // namespace autoshader
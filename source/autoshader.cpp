@@ -6,106 +6,186 @@
 //
 
 #include "autoshader.h"
-#include "shadersource.h"
-#include "descriptorset.h"
-#include "descriptorwrite.h"
-#include "specializer.h"
-#include "typereflect.h"
-#include "vertexinput.h"
-#include "pushranges.h"
-#include "component.h"
-#include "namemap.h"
+#include "generate.h"
+#include "cache.h"
+#include "watch.h"
 #include <cxxopts.hpp>
 #include <iostream>
 #include <fstream>
-#include <set>
+#include <cctype>
+#include <cstring>
+#include <thread>
 
 namespace autoshader {
 
 	namespace {
 
-		vector<uint32_t> load_spirv(const std::string &f, std::istream &str) {
-			vector<uint32_t> r(64 * 1024);
-			for (size_t s = 0;;) {
-				str.read(reinterpret_cast<char*>(r.data()) + s, 4 * r.size() - s);
-				if (str.bad())
-					throw std::runtime_error("error loading spriv from " + f);
-				s += str.gcount();
-				if (str.eof()) {
-					if (s & 3)
-						throw std::runtime_error("invalid spirv file length for " + f);
-					r.resize(s / 4);
-					return r;
+		auto path_filename(const char *p) {
+			int s = '/';
+			#ifdef WIN32
+			s = '\\';
+			#endif
+			auto t = strrchr(p, s);
+			return t == nullptr ? p : t + 1;
+		}
+
+		PipelineOptions pipeline_options(const cxxopts::ParseResult &options) {
+			PipelineOptions r;
+			if (options.count("input") != 0)
+				r.input = options["input"].as<vector<string>>();
+			if (options.count("output") != 0)
+				r.output = options["output"].as<string>();
+			if (options.count("data") != 0)
+				r.data = options["data"].as<string>();
+			if (options.count("namespace") != 0)
+				r.namespaces = options["namespace"].as<vector<string>>();
+			r.vertex = options["vertex"].as<string>();
+			r.noVertex = options["no-vertex"].as<bool>();
+			r.noSource = options["no-source"].as<bool>();
+			r.strip = options["strip"].as<bool>();
+			r.compress = options["compress"].as<bool>();
+			r.subgroupSize = options["subgroup-size"].as<unsigned>();
+			if ((r.subgroupSize & (r.subgroupSize - 1)) != 0)
+				throw std::runtime_error(fmt::format("the subgroup size must be a power of two: {}",
+					r.subgroupSize));
+			if (options.count("reflect-json") != 0)
+				r.reflectJson = options["reflect-json"].as<string>();
+			if (options.count("reflect-binary") != 0)
+				r.reflectBinary = options["reflect-binary"].as<string>();
+
+			auto format = options["data-format"].as<string>();
+			if (format == "incbin")
+				r.dataFormat = DataFormat::Incbin;
+			else if (format != "source")
+				throw std::runtime_error("unknown data format: " + format);
+			if (r.dataFormat == DataFormat::Incbin && r.data.empty())
+				throw std::runtime_error("the incbin data format needs a --data file");
+			return r;
+		}
+
+		//------------------------------------------------------------------------------------------
+		//-- generate and write one pipeline, using the cache when there is one
+
+		void run_pipeline(const string &prog, const PipelineOptions &p, size_t jobs,
+				OutputCache &cache, bool stats) {
+			auto shaders = load_shaders(p);
+
+			PipelineOutput out;
+			if (cache.dir.empty()) {
+				out = generate_pipeline(prog, p, shaders, jobs);
+			}
+			else {
+				// a hit never constructs a compiler
+				auto key = cache_key(prog, p, shaders);
+				if (!cache_lookup(cache, key, out)) {
+					out = generate_pipeline(prog, p, shaders, jobs);
+					cache_store(cache, key, out);
 				}
+			}
 
+			write_output(p, out);
+
+			if (stats) {
+				auto name = p.output.empty() ? "stdout" : p.output;
+				for (auto &z : out.sizes)
+					std::cerr << fmt::format("{}: {} {} {} -> {} bytes\n", prog, name, z.stage,
+						z.original, z.emitted);
 			}
 		}
 
-		vector<uint32_t> load_spirv(const string &f) {
-			std::ifstream str(f);
-			if (!str.good())
-				throw std::runtime_error("failed to open file: " + f);
-			return load_spirv("file " + f, str);
-		}
+		//------------------------------------------------------------------------------------------
+		//-- split a manifest line into arguments. arguments are separated by white space and
+		//-- may be double quoted, with backslash escaping a quote or backslash.
 
-		void get_dependant_structs(vector<uint32_t> &r, spirv_cross::Compiler &comp, uint32_t b) {
-			if (std::any_of(r.begin(), r.end(), [b] (auto r) { return r == b; }))
-				return;
-			auto type = comp.get_type(b);
-			if (type.basetype != spirv_cross::SPIRType::Struct)
-				throw std::runtime_error(fmt::format(
-					"get_dependant_structs called with non struct type {}", type.basetype));
-			for (uint32_t i = 0; size_t(i) < type.member_types.size(); ++i) {
-				uint32_t t = type.member_types[i];
-				auto mtype = comp.get_type(t);
-				auto s = comp.get_type(mtype.self);
-				if (s.basetype == spirv_cross::SPIRType::Struct) {
-					get_dependant_structs(r, comp, mtype.self);
+		vector<string> manifest_args(const string &line) {
+			vector<string> r;
+			for (size_t i = 0; i < line.size();) {
+				if (isspace(line[i])) {
+					i += 1;
+					continue;
 				}
+				string a;
+				bool quoted = false;
+				for (; i < line.size() && (quoted || !isspace(line[i])); ++i) {
+					if (line[i] == '"')
+						quoted = !quoted;
+					else if (line[i] == '\\' && quoted && i + 1 < line.size())
+						a += line[++i];
+					else
+						a += line[i];
+				}
+				if (quoted)
+					throw std::runtime_error("unterminated quote");
+				r.push_back(move(a));
 			}
-			r.push_back(b);
+			return r;
 		}
 
-		void find_buffer_structs(vector<uint32_t> &r, spirv_cross::Compiler &comp) {
-			spirv_cross::ShaderResources res = comp.get_shader_resources();
-			for (auto &v : res.uniform_buffers)
-				get_dependant_structs(r, comp, v.base_type_id);
-			for (auto &v : res.storage_buffers)
-				get_dependant_structs(r, comp, v.base_type_id);
-			for (auto &v : res.push_constant_buffers)
-				get_dependant_structs(r, comp, v.base_type_id);
-		}
+		//------------------------------------------------------------------------------------------
+		//-- ManifestEntry: the options for one pipeline and where they came from
 
-		auto path_filename(const char *p) {
-			int s = '/';
-			#ifdef WIN32
-			s = '\\';
-			#endif
-			auto t = strrchr(p, s);
-			return t == nullptr ? p : t + 1;
-		}
+		struct ManifestEntry {
+			size_t line;
+			PipelineOptions options;
+		};
+
+		//------------------------------------------------------------------------------------------
+		//-- parse the pipeline options from every line of a manifest
 
-		bool is_file_match(const string &name, const string &data) {
-			std::ifstream str(name);
-			str.seekg(0, str.end);
-			size_t l = str.tellg();
-			if (l != data.size())
-				return false;
-			str.seekg(0, str.beg);
-			vector<char> t(l);
-			str.read(t.data(), t.size());
+		vector<ManifestEntry> read_manifest(const char *prog, cxxopts::Options &opts,
+				const string &manifest) {
+			std::ifstream str(manifest);
 			if (!str.good())
-				return false;
-			return std::equal(t.begin(), t.end(), data.begin());
+				throw std::runtime_error("failed to open manifest: " + manifest);
+
+			string line;
+			vector<ManifestEntry> r;
+			for (size_t n = 1; std::getline(str, line); ++n) {
+				try {
+					auto args = manifest_args(line);
+					if (args.empty() || args[0][0] == '#')
+						continue;
+
+					vector<const char*> argv{ prog };
+					for (auto &a : args)
+						argv.push_back(a.c_str());
+					auto options = opts.parse(int(argv.size()), argv.data());
+					if (options.count("manifest") != 0 || options.count("watch") != 0)
+						throw std::runtime_error("manifests can't be nested");
+					// these apply to the whole command, so they go on its command line
+					for (auto name : { "jobs", "cache-dir", "stats", "help" }) {
+						if (options.count(name) != 0)
+							throw std::runtime_error(fmt::format("--{} can't be set per pipeline, "
+								"give it with --manifest", name));
+					}
+
+					auto p = pipeline_options(options);
+					if (p.input.empty() || p.output.empty())
+						throw std::runtime_error("a manifest entry needs inputs and an output");
+					r.push_back(ManifestEntry{ n, std::move(p) });
+				}
+				catch (std::exception &err) {
+					throw std::runtime_error(fmt::format("{}:{}: {}", manifest, n, err.what()));
+				}
+			}
+			if (str.bad())
+				throw std::runtime_error("error reading manifest: " + manifest);
+			return r;
 		}
 
-		void write_file(const string &name, const string &data) {
-			if (is_file_match(name, data))
-				return;
-			std::ofstream str(name);
-			str.write(data.data(), data.size());
-			if (!str.good())
-				throw std::runtime_error("error writing output to: " + name);
+		//------------------------------------------------------------------------------------------
+		//-- generate every pipeline in a manifest, one at a time
+
+		void generate_manifest(const char *prog, cxxopts::Options &opts, const string &manifest,
+				size_t jobs, OutputCache &cache, bool stats) {
+			for (auto &e : read_manifest(prog, opts, manifest)) {
+				try {
+					run_pipeline(prog, e.options, jobs, cache, stats);
+				}
+				catch (std::exception &err) {
+					throw std::runtime_error(fmt::format("{}:{}: {}", manifest, e.line, err.what()));
+				}
+			}
 		}
 
 	} // namespace
@@ -125,7 +205,25 @@ namespace autoshader {
 			("no-vertex", "suppress the generation of vertex structures")
 			("no-source", "suppress the generation of static shader data variables")
 			("namespace", "enclose the output in a namespace", cxxopts::value<vector<string>>())
+			("strip", "remove debug names, source and line information from the shader data")
+			("compress", "compress the shader data, it is unpacked when the shader modules are created")
+			("subgroup-size", "preferred subgroup size of the compute stage, required when the device "
+				"supports it (0 leaves it to the driver)", cxxopts::value<unsigned>()->default_value("0"))
 			("d,data", "output shader data to a separate file", cxxopts::value<string>())
+			("reflect-json", "also write the reflected layouts to a json file", cxxopts::value<string>())
+			("reflect-binary", "also write the reflected layouts to a binary file (see "
+				"autoshader/reflectformat.h)", cxxopts::value<string>())
+			("data-format", "format of the shader data: source (c++ arrays) or incbin (binary files "
+				"included by an assembler data file)", cxxopts::value<string>()->default_value("source"))
+			("j,jobs", "number of threads used to reflect and emit the shaders (0 for all cores)",
+				cxxopts::value<unsigned>()->default_value("1"))
+			("cache-dir", "reuse outputs stored in a directory keyed by the inputs and options",
+				cxxopts::value<string>())
+			("stats", "print generation statistics to stderr")
+			("m,manifest", "generate each pipeline listed in a manifest file, one set of options per line",
+				cxxopts::value<string>())
+			("watch", "generate the pipelines in a manifest and regenerate them as their inputs change",
+				cxxopts::value<string>())
 			("o,output", "output source file (stdout if missing)", cxxopts::value<string>());
 		opts.parse_positional({ "input" });
 
@@ -136,116 +234,37 @@ namespace autoshader {
 			return 0;
 		}
 
-		// load all the shader stages and find all public structure definitions
-		auto input = options["input"].as<vector<string>>();
-		vector<ShaderRecord> shaders;
-		std::map<uint32_t, DescriptorSet> descriptorSets;
-		if (input.empty()) {
-			shaders.emplace_back();
-			auto &sh = shaders.back();
-			sh.source = load_spirv("stdin", std::cin);
-			sh.comp.reset(new spirv_cross::Compiler(sh.source));
-			find_buffer_structs(sh.structs, *sh.comp);
-			get_descriptor_sets(descriptorSets, *sh.comp);
-		}
-		for (auto i : input) {
-			shaders.emplace_back();
-			auto &sh = shaders.back();
-			sh.source = load_spirv(i);
-			sh.comp.reset(new spirv_cross::Compiler(sh.source));
-			find_buffer_structs(sh.structs, *sh.comp);
-			get_descriptor_sets(descriptorSets, *sh.comp);
-		}
+		// figure out how many threads to use
+		size_t jobs = options["jobs"].as<unsigned>();
+		if (jobs == 0)
+			jobs = std::max(std::thread::hardware_concurrency(), 1u);
 
-		// re-map potential name collisions
-		map_struct_names(shaders);
-
-		// Generate the output
-		fmt::memory_buffer r;
-		fmt::memory_buffer dr;
-		format_to(std::back_inserter(r), "// generated with {}\n\n", prog);
-
-		// figure out the namespace
-		vector<string> namespaces;
-		if (options.count("namespace") != 0)
-			namespaces = options["namespace"].as<vector<string>>();
-		auto indent = namespaces.empty() ? string() : "  ";
-
-		if (!namespaces.empty()) {
-			for (size_t i = 0; i < namespaces.size(); ++i)
-				format_to(std::back_inserter(r), "{}namespace {} {{", i == 0 ? "" : " ", namespaces[i]);
-			format_to(std::back_inserter(r), "\n\n");
-
-			if (options.count("data")) {
-				for (size_t i = 0; i < namespaces.size(); ++i)
-					format_to(std::back_inserter(dr), "{}namespace {} {{", i == 0 ? "" : " ", namespaces[i]);
-				format_to(std::back_inserter(dr), "\n\n");
-			}
-		}
+		OutputCache cache;
+		if (options.count("cache-dir") != 0)
+			cache.dir = options["cache-dir"].as<string>();
 
-		for (auto &sh : shaders) {
-			for (auto t : sh.structs) {
-				struct_definition(r, sh, t, indent);
-				format_to(std::back_inserter(r), ";\n\n");
-			}
-		}
+		bool stats = options["stats"].as<bool>();
 
-		bool withVertex = false;
-		if (!options["no-vertex"].as<bool>()) {
-			string vertname = options["vertex"].as<string>();
-			for (auto &sh : shaders) {
-				if (get_execution_model(*sh.comp) != spv::ExecutionModelVertex)
-					continue;
-				withVertex = get_vertex_definition(r, *sh.comp, vertname, indent);
-			}
-		}
-
-		for (auto &s : descriptorSets) {
-			descriptor_layout(r, s.second, descriptorSets.size() == 1 ? "DescriptorSet" :
-				fmt::format("DescriptorSet{}", s.first), indent);
-		}
-
-		bool withPush = push_ranges(r, shaders, indent);
-
-		descriptor_writer(r, descriptorSets, indent);
-
-		specializers(r, shaders, indent);
-
-		if (!options["no-source"].as<bool>()) {
-			shader_source_decl(r, shaders, indent);
-
-			generate_components(r, descriptorSets, shaders, withVertex, withPush, indent);
-
-			if (options.count("data") != 0)
-				shader_source(dr, shaders, indent, false);
-			else
-				shader_source(r, shaders, indent, true);
-		}
-
-		if (!namespaces.empty()) {
-			for (size_t i = 0; i < namespaces.size(); ++i)
-				format_to(std::back_inserter(r), "{}}}", i == 0 ? "" : " ");
-			format_to(std::back_inserter(r), "\n");
-
-			if (options.count("data")) {
-				for (size_t i = 0; i < namespaces.size(); ++i)
-					format_to(std::back_inserter(dr), "{}}}", i == 0 ? "" : " ");
-				format_to(std::back_inserter(dr), "\n");
-			}
+		// watching keeps the pipelines resident and never returns
+		if (options.count("watch") != 0) {
+			vector<PipelineOptions> pipelines;
+			for (auto &e : read_manifest(prog, opts, options["watch"].as<string>()))
+				pipelines.push_back(std::move(e.options));
+			watch_pipelines(prog, pipelines, jobs);
+			return 0;
 		}
 
-		// wrte the output to the intended destination
-		string out = to_string(r);
-		string dout = to_string(dr);
-		if (options.count("output") == 0) {
-			std::cout.write(out.data(), out.size());
+		// a manifest streams through its pipelines to keep the memory bounded
+		if (options.count("manifest") != 0) {
+			generate_manifest(prog, opts, options["manifest"].as<string>(), jobs, cache, stats);
 		}
 		else {
-			write_file(options["output"].as<string>(), out);
+			run_pipeline(prog, pipeline_options(options), jobs, cache, stats);
 		}
 
-		if (options.count("data")) {
-			write_file(options["data"].as<string>(), dout);
+		if (stats && !cache.dir.empty()) {
+			std::cerr << fmt::format("{}: cache {} hits, {} misses\n", prog, cache.hits,
+				cache.misses);
 		}
 
 		return 0;
@@ -0,0 +1,172 @@
+//
+//  File: cache.cpp
+//
+//  Created by Jon Spencer on 2026-10-16 11:48:27
+//  Copyright (c) Jon Spencer. See LICENSE file.
+//
+
+#include "cache.h"
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+#ifdef WIN32
+#include <direct.h>
+#include <process.h>
+#define getpid _getpid
+#else
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifndef AUTOSHADER_VERSION
+#define AUTOSHADER_VERSION "unknown"
+#endif
+
+namespace autoshader {
+
+	namespace {
+
+		// cache entries start with a tag, the sizes of the two outputs, the number of extra
+		// files and the number of stage sizes. each extra file has the sizes of its name and
+		// contents, each stage size has the size of its name and the two sizes.
+		constexpr char entryTag[8] = { 'a', 's', 'c', 'a', 'c', 'h', 'e', '3' };
+
+		bool read_string(std::istream &str, string &s, uint64_t size) {
+			s.assign(size, '\0');
+			return size == 0 || str.read(&s[0], size);
+		}
+
+		string entry_name(const OutputCache &c, const Hash128 &key) {
+			return c.dir + "/" + key.hex();
+		}
+
+		void make_directory(const string &d) {
+			#ifdef WIN32
+			_mkdir(d.c_str());
+			#else
+			mkdir(d.c_str(), 0777);
+			#endif
+		}
+
+	} // namespace
+
+
+	//------------------------------------------------------------------------------------------
+	//-- the key for a pipeline
+
+	Hash128 cache_key(const string &prog, const PipelineOptions &opts,
+			const vector<ShaderRecord> &shaders) {
+		Hasher h;
+		h.add(string(AUTOSHADER_VERSION));
+		h.add(uint64_t(outputFormatVersion));
+		h.add(prog);
+		h.add(uint64_t(opts.namespaces.size()));
+		for (auto &n : opts.namespaces)
+			h.add(n);
+		h.add(opts.vertex);
+		h.add(uint64_t(opts.noVertex));
+		h.add(uint64_t(opts.noSource));
+		h.add(uint64_t(!opts.data.empty()));
+		h.add(uint64_t(opts.dataFormat));
+		h.add(uint64_t(opts.strip));
+		h.add(uint64_t(opts.compress));
+		h.add(uint64_t(opts.subgroupSize));
+		// the reflection files are extra outputs, stored under their names
+		h.add(opts.reflectJson);
+		h.add(opts.reflectBinary);
+		// the stub refers to the binaries by their absolute path
+		if (opts.dataFormat == DataFormat::Incbin)
+			h.add(absolute_path(opts.data));
+		h.add(uint64_t(shaders.size()));
+		for (auto &s : shaders) {
+			h.add(uint64_t(s.source.size()));
+			h.add(s.source.data(), sizeof(uint32_t) * s.source.size());
+		}
+		return h.result();
+	}
+
+
+	//------------------------------------------------------------------------------------------
+	//-- look for a stored output
+
+	bool cache_lookup(OutputCache &c, const Hash128 &key, PipelineOutput &out) {
+		std::ifstream str(entry_name(c, key), std::ios::binary);
+		char tag[sizeof(entryTag)];
+		uint64_t sizes[4];
+		if (str.read(tag, sizeof(tag)) && std::equal(tag, tag + sizeof(tag), entryTag) &&
+				str.read(reinterpret_cast<char*>(sizes), sizeof(sizes))) {
+			PipelineOutput r;
+			bool good = read_string(str, r.header, sizes[0]) && read_string(str, r.data, sizes[1]);
+			for (uint64_t i = 0; good && i < sizes[2]; ++i) {
+				uint64_t fsizes[2];
+				OutputFile f;
+				good = str.read(reinterpret_cast<char*>(fsizes), sizeof(fsizes)) &&
+					read_string(str, f.name, fsizes[0]) && read_string(str, f.contents, fsizes[1]);
+				r.extra.push_back(std::move(f));
+			}
+			for (uint64_t i = 0; good && i < sizes[3]; ++i) {
+				uint64_t ssizes[3];
+				StageSize z;
+				good = str.read(reinterpret_cast<char*>(ssizes), sizeof(ssizes)) &&
+					read_string(str, z.stage, ssizes[0]);
+				z.original = ssizes[1];
+				z.emitted = ssizes[2];
+				r.sizes.push_back(std::move(z));
+			}
+			if (good) {
+				out = std::move(r);
+				c.hits += 1;
+				return true;
+			}
+		}
+		c.misses += 1;
+		return false;
+	}
+
+
+	//------------------------------------------------------------------------------------------
+	//-- store a generated output. failing to store is only a warning, the output is still good
+
+	void cache_store(OutputCache &c, const Hash128 &key, const PipelineOutput &out) {
+		make_directory(c.dir);
+
+		// write to a private name then move it into place so readers never see a partial entry
+		auto name = entry_name(c, key);
+		auto temp = fmt::format("{}.{}.tmp", name, getpid());
+		{
+			std::ofstream str(temp, std::ios::binary);
+			uint64_t sizes[4] = { out.header.size(), out.data.size(), out.extra.size(),
+				out.sizes.size() };
+			str.write(entryTag, sizeof(entryTag));
+			str.write(reinterpret_cast<const char*>(sizes), sizeof(sizes));
+			str.write(out.header.data(), out.header.size());
+			str.write(out.data.data(), out.data.size());
+			for (auto &f : out.extra) {
+				uint64_t fsizes[2] = { f.name.size(), f.contents.size() };
+				str.write(reinterpret_cast<const char*>(fsizes), sizeof(fsizes));
+				str.write(f.name.data(), f.name.size());
+				str.write(f.contents.data(), f.contents.size());
+			}
+			for (auto &z : out.sizes) {
+				uint64_t ssizes[3] = { z.stage.size(), z.original, z.emitted };
+				str.write(reinterpret_cast<const char*>(ssizes), sizeof(ssizes));
+				str.write(z.stage.data(), z.stage.size());
+			}
+			if (!str.good()) {
+				str.close();
+				std::remove(temp.c_str());
+				std::cerr << "warning: error writing cache entry: " << temp << std::endl;
+				return;
+			}
+		}
+		#ifdef WIN32
+		std::remove(name.c_str());
+		#endif
+		if (std::rename(temp.c_str(), name.c_str()) != 0) {
+			std::remove(temp.c_str());
+			std::cerr << "warning: error storing cache entry: " << name << std::endl;
+		}
+	}
+
+} // namespace autoshader
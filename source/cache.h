@@ -0,0 +1,40 @@
+//
+//  File: cache.h
+//
+//  Created by Jon Spencer on 2026-10-16 11:48:12
+//  Copyright (c) Jon Spencer. See LICENSE file.
+//
+#ifndef H_SOURCE_CACHE_H__
+#define H_SOURCE_CACHE_H__
+
+#include "generate.h"
+#include "hash.h"
+
+namespace autoshader {
+
+	//------------------------------------------------------------------------------------------
+	//-- OutputCache: a directory of generated outputs keyed by the content that produced them
+
+	struct OutputCache {
+		string dir;
+		size_t hits = 0;
+		size_t misses = 0;
+	};
+
+	//------------------------------------------------------------------------------------------
+	//-- the key for a pipeline - the generator and output format versions, the options that
+	//-- affect the output and the spirv words of each stage
+	Hash128 cache_key(const string &prog, const PipelineOptions &opts,
+		const vector<ShaderRecord> &shaders);
+
+	//------------------------------------------------------------------------------------------
+	//-- look for a stored output, counting the hit or miss
+	bool cache_lookup(OutputCache &c, const Hash128 &key, PipelineOutput &out);
+
+	//------------------------------------------------------------------------------------------
+	//-- store a generated output (failures are reported as warnings)
+	void cache_store(OutputCache &c, const Hash128 &key, const PipelineOutput &out);
+
+} // namespace autoshader
+
+#endif // H_SOURCE_CACHE_H__
@@ -7,12 +7,53 @@
 
 #include "component.h"
 #include "shadersource.h"
+#include <algorithm>
 
 namespace autoshader {
 
+	namespace {
+
+		//------------------------------------------------------------------------------------------
+		//-- the graphics pipeline library part that holds a stage, empty for compute
+
+		const char *library_part_string(spv::ExecutionModel e) {
+			switch (e) {
+				case spv::ExecutionModelFragment:
+					return "vk::GraphicsPipelineLibraryFlagBitsEXT::eFragmentShader";
+				case spv::ExecutionModelGLCompute:
+					return "{}";
+				default:
+					return "vk::GraphicsPipelineLibraryFlagBitsEXT::ePreRasterizationShaders";
+			}
+		}
+
+		//------------------------------------------------------------------------------------------
+		//-- the color attachments written by the fragment shader, one past its highest output
+		//-- location, or -1 without a fragment shader
+
+		int color_attachment_count(const vector<ShaderRecord> &sh) {
+			for (auto &s : sh) {
+				auto &ir = *s.reflection;
+				if (get_execution_model(ir) != spv::ExecutionModelFragment)
+					continue;
+				uint32_t count = 0;
+				for (auto &v : ir.resources(ResourceKind::StageOutput)) {
+					uint32_t n = 1;
+					for (auto d : ir.array(ir.type(v.type)))
+						n *= d;
+					count = std::max(count, v.location + n);
+				}
+				return int(count);
+			}
+			return -1;
+		}
+
+	} // namespace
+
 	void generate_components(fmt::memory_buffer &r,
 		std::map<uint32_t, DescriptorSet> &sets, vector<ShaderRecord> &sh,
-		bool withVertex, bool withPush, const string &indent) {
+		bool withVertex, bool withPush, bool packed, uint32_t subgroup_size, uint64_t content_hash,
+		const string &indent) {
 
 		size_t arity = 0;
 		fmt::memory_buffer a;
@@ -72,9 +113,17 @@ namespace autoshader {
 		else {
 			format_to(std::back_inserter(r), "{}    auto pl = d.createPipelineLayoutUnique({{}});\n", indent);
 		}
+		if (packed) {
+			format_to(std::back_inserter(r), "{}    std::vector<uint32_t> spirv;\n", indent);
+		}
 		for (auto &s : sh) {
-			auto sn = get_execution_string(*s.comp);
-			format_to(std::back_inserter(r), "{0}    auto {1}_ = d.createShaderModuleUnique({{ {{}}, {1}_size, {1}_data }});\n", indent, sn);
+			auto sn = get_execution_string(*s.reflection);
+			if (packed) {
+				format_to(std::back_inserter(r), "{0}    auto {1}_ = d.createShaderModuleUnique({{ {{}}, {1}_size, autoshader::unpackSpirv(spirv, {1}_packed, {1}_packed_size) }});\n", indent, sn);
+			}
+			else {
+				format_to(std::back_inserter(r), "{0}    auto {1}_ = d.createShaderModuleUnique({{ {{}}, {1}_size, {1}_data }});\n", indent, sn);
+			}
 		}
 		format_to(std::back_inserter(r), "{}    device = d;\n", indent);
 		for (auto &s : sets) {
@@ -83,7 +132,7 @@ namespace autoshader {
 		}
 		format_to(std::back_inserter(r), "{}    layout = pl.release();\n", indent);
 		for (auto &s : sh) {
-			auto sn = get_execution_string(*s.comp);
+			auto sn = get_execution_string(*s.reflection);
 			format_to(std::back_inserter(r), "{0}    {1} = {1}_.release();\n", indent, sn);
 		}
 		format_to(std::back_inserter(r), "{}  }}\n", indent);
@@ -93,7 +142,7 @@ namespace autoshader {
 		format_to(std::back_inserter(r), "{}    if (device == vk::Device())\n", indent);
 		format_to(std::back_inserter(r), "{}      return;\n", indent);
 		for (auto &s : sh) {
-			auto sn = get_execution_string(*s.comp);
+			auto sn = get_execution_string(*s.reflection);
 			format_to(std::back_inserter(r), "{}    device.destroyShaderModule({});\n", indent, sn);
 		}
 		format_to(std::back_inserter(r), "{}    device.destroyPipelineLayout(layout);\n", indent);
@@ -103,22 +152,171 @@ namespace autoshader {
 		}
 		format_to(std::back_inserter(r), "{}  }}\n", indent);
 
+		// the arguments the components add to a pipeline
+		fmt::memory_buffer pa;
+		format_to(std::back_inserter(pa), "std::forward<A>(a)..., device, layout");
+		for (auto &s : sh) {
+			auto sn = get_execution_string(*s.reflection);
+			format_to(std::back_inserter(pa), ",\n{0}      vk::PipelineShaderStageCreateInfo({{}}, {2}, {1}, \"{3}\")",
+				indent, sn, get_shader_stage_flags(*s.reflection), get_first_entry_point_name(*s.reflection));
+		}
+		if (withVertex) {
+			format_to(std::back_inserter(pa), ",\n{}      getVertexBindingDescription(), getVertexAttributeDescriptions()",
+				indent);
+		}
+
+		// the default blend attachments, for the color outputs of the fragment shader
+		auto colors = color_attachment_count(sh);
+		auto stateArgs = string(withVertex ? ", getVertexBindingDescription(), getVertexAttributeDescriptions()" : "");
+		if (colors >= 0) {
+			format_to(std::back_inserter(pa), ", autoshader::ColorAttachmentCount(colorAttachmentCount)");
+			stateArgs += ", autoshader::ColorAttachmentCount(colorAttachmentCount)";
+			format_to(std::back_inserter(r), "\n");
+			format_to(std::back_inserter(r), "{}  static constexpr uint32_t colorAttachmentCount = {};\n", indent, colors);
+		}
+
+		// the preferred subgroup size, as the device supports it
+		if (subgroup_size != 0) {
+			format_to(std::back_inserter(r), "\n");
+			format_to(std::back_inserter(r), "{}  static constexpr uint32_t subgroupSize = {};\n", indent, subgroup_size);
+			format_to(std::back_inserter(r), "{}  static vk::PipelineShaderStageRequiredSubgroupSizeCreateInfo requiredSubgroupSize(vk::PhysicalDevice p) {{\n", indent);
+			format_to(std::back_inserter(r), "{}    return autoshader::requiredSubgroupSize(p, subgroupSize, vk::ShaderStageFlagBits::eCompute);\n", indent);
+			format_to(std::back_inserter(r), "{}  }}\n", indent);
+		}
+
 		format_to(std::back_inserter(r), "\n");
 		format_to(std::back_inserter(r), "{}  template <typename... A>\n", indent);
 		format_to(std::back_inserter(r), "{}  vk::UniquePipeline createPipe(A &&...a)  {{\n", indent);
-		format_to(std::back_inserter(r), "{}    return autoshader::createPipe(std::forward<A>(a)..., device, layout", indent);
+		format_to(std::back_inserter(r), "{}    return autoshader::createPipe({});\n", indent, to_string(pa));
+		format_to(std::back_inserter(r), "{}  }}\n", indent);
+
+		// the same arguments as a pack for autoshader::createPipes
+		format_to(std::back_inserter(r), "\n");
+		format_to(std::back_inserter(r), "{}  template <typename... A>\n", indent);
+		format_to(std::back_inserter(r), "{}  auto pipeArgs(A &&...a)  {{\n", indent);
+		format_to(std::back_inserter(r), "{}    return std::make_tuple({});\n", indent, to_string(pa));
+		format_to(std::back_inserter(r), "{}  }}\n", indent);
+
+		// set the state of a pipeline created with autoshader::DynamicStates
+		format_to(std::back_inserter(r), "\n");
+		format_to(std::back_inserter(r), "{}  template <typename... A>\n", indent);
+		format_to(std::back_inserter(r), "{}  static void cmdSetDynamicState(vk::CommandBuffer cb, A &&...a)  {{\n", indent);
+		format_to(std::back_inserter(r), "{}    autoshader::setDynamicState(cb, std::forward<A>(a)...{});\n", indent,
+			stateArgs);
+		format_to(std::back_inserter(r), "{}  }}\n", indent);
+		if (withVertex) {
+			format_to(std::back_inserter(r), "\n");
+			format_to(std::back_inserter(r), "#ifdef VK_EXT_vertex_input_dynamic_state\n");
+			format_to(std::back_inserter(r), "{}  template <typename... T>\n", indent);
+			format_to(std::back_inserter(r), "{}  static void cmdSetVertexInput(vk::CommandBuffer cb)  {{\n", indent);
+			format_to(std::back_inserter(r), "{}    auto b = getVertexBindingDescription();\n", indent);
+			format_to(std::back_inserter(r), "{}    auto a = getVertexAttributeDescriptions();\n", indent);
+			format_to(std::back_inserter(r), "{}    autoshader::setVertexInput<T...>(cb, {{ {{}}, uint32_t(b.size()), b.data(), uint32_t(a.size()), a.data() }});\n", indent);
+			format_to(std::back_inserter(r), "{}  }}\n", indent);
+			format_to(std::back_inserter(r), "#endif\n");
+		}
+
+		// the stages, their modules and their code, for replacing the modules at runtime
+		format_to(std::back_inserter(r), "\n");
+		format_to(std::back_inserter(r), "{}  static std::array<vk::ShaderStageFlagBits, {}> stageFlags() {{\n",
+			indent, sh.size());
+		format_to(std::back_inserter(r), "{}    return {{{{", indent);
+		for (size_t i = 0; i < sh.size(); ++i) {
+			format_to(std::back_inserter(r), "{} {}", i == 0 ? "" : ",",
+				get_shader_stage_flags(*sh[i].reflection));
+		}
+		format_to(std::back_inserter(r), " }}}};\n");
+		format_to(std::back_inserter(r), "{}  }}\n", indent);
+
+		// which part of a split pipeline each stage is built in
+		format_to(std::back_inserter(r), "\n");
+		format_to(std::back_inserter(r), "#ifdef VK_EXT_graphics_pipeline_library\n");
+		format_to(std::back_inserter(r), "{}  static vk::GraphicsPipelineLibraryFlagsEXT stageLibrary(vk::ShaderStageFlagBits s) {{\n", indent);
+		format_to(std::back_inserter(r), "{}    switch (s) {{\n", indent);
 		for (auto &s : sh) {
-			auto sn = get_execution_string(*s.comp);
-			format_to(std::back_inserter(r), ",\n{0}      vk::PipelineShaderStageCreateInfo({{}}, {2}, {1}, \"{3}\")",
-				indent, sn, get_shader_stage_flags(*s.comp), get_first_entry_point_name(*s.comp));
+			format_to(std::back_inserter(r), "{}      case {}: return {};\n", indent,
+				get_shader_stage_flags(*s.reflection), library_part_string(get_execution_model(*s.reflection)));
 		}
-		if (withVertex) {
-			format_to(std::back_inserter(r), ",\n{}      getVertexBindingDescription(), getVertexAttributeDescriptions()",
-				indent);
+		format_to(std::back_inserter(r), "{}      default: return {{}};\n", indent);
+		format_to(std::back_inserter(r), "{}    }}\n", indent);
+		format_to(std::back_inserter(r), "{}  }}\n", indent);
+		format_to(std::back_inserter(r), "#endif\n");
+
+		// linked shader objects with the same layouts, instead of a pipeline
+		format_to(std::back_inserter(r), "\n");
+		format_to(std::back_inserter(r), "#ifdef VK_EXT_shader_object\n");
+		format_to(std::back_inserter(r), "{}  template <typename... A>\n", indent);
+		format_to(std::back_inserter(r), "{}  vk::Result createShaders(std::array<vk::ShaderEXT, {}> &shaders, A &&...a)  {{\n",
+			indent, sh.size());
+		format_to(std::back_inserter(r), "{}    std::array<vk::DescriptorSetLayout, {}> sl = {{{{", indent, sets.size());
+		for (auto &s : sets) {
+			auto sn = sets.size() == 1 ? "" : fmt::format("{}", s.first);
+			format_to(std::back_inserter(r), "{} set{}Layout", s.first == sets.begin()->first ? "" : ",", sn);
+		}
+		format_to(std::back_inserter(r), " }}}};\n");
+		if (withPush) {
+			format_to(std::back_inserter(r), "{}    auto pr = getPushConstantRanges();\n", indent);
+		}
+		else {
+			format_to(std::back_inserter(r), "{}    std::array<vk::PushConstantRange, 0> pr;\n", indent);
+		}
+		format_to(std::back_inserter(r), "{}    std::array<std::vector<uint32_t>, {}> spirv;\n", indent, sh.size());
+		format_to(std::back_inserter(r), "{}    std::array<autoshader::StageCode, {}> code = {{{{\n", indent, sh.size());
+		for (size_t i = 0; i < sh.size(); ++i) {
+			format_to(std::back_inserter(r), "{}      {{ {}, \"{}\", nullptr, 0 }}{}\n", indent,
+				get_shader_stage_flags(*sh[i].reflection), get_first_entry_point_name(*sh[i].reflection),
+				i + 1 == sh.size() ? "" : ",");
 		}
-		format_to(std::back_inserter(r), ");\n");
+		format_to(std::back_inserter(r), "{}    }}}};\n", indent);
+		format_to(std::back_inserter(r), "{}    for (size_t i = 0; i < code.size(); ++i)\n", indent);
+		format_to(std::back_inserter(r), "{}      code[i].code = stageSpirv(code[i].stage, spirv[i], code[i].size);\n", indent);
+		format_to(std::back_inserter(r), "{}    return autoshader::createShaders(shaders, device, code, sl, pr, std::forward<A>(a)...);\n", indent);
 		format_to(std::back_inserter(r), "{}  }}\n", indent);
 
+		format_to(std::back_inserter(r), "\n");
+		format_to(std::back_inserter(r), "{}  template <typename... A>\n", indent);
+		format_to(std::back_inserter(r), "{}  static void cmdBindShaders(vk::CommandBuffer cb, const std::array<vk::ShaderEXT, {}> &shaders, A &&...a)  {{\n",
+			indent, sh.size());
+		format_to(std::back_inserter(r), "{}    autoshader::bindShaders(cb, stageFlags(), shaders, std::forward<A>(a)...{});\n", indent,
+			stateArgs);
+		format_to(std::back_inserter(r), "{}  }}\n", indent);
+		format_to(std::back_inserter(r), "#endif\n");
+
+		format_to(std::back_inserter(r), "\n");
+		format_to(std::back_inserter(r), "{}  vk::ShaderModule *stageModule(vk::ShaderStageFlagBits s) {{\n", indent);
+		format_to(std::back_inserter(r), "{}    switch (s) {{\n", indent);
+		for (auto &s : sh) {
+			format_to(std::back_inserter(r), "{}      case {}: return &{};\n", indent,
+				get_shader_stage_flags(*s.reflection), get_execution_string(*s.reflection));
+		}
+		format_to(std::back_inserter(r), "{}      default: return nullptr;\n", indent);
+		format_to(std::back_inserter(r), "{}    }}\n", indent);
+		format_to(std::back_inserter(r), "{}  }}\n", indent);
+
+		format_to(std::back_inserter(r), "\n");
+		format_to(std::back_inserter(r), "{}  static const uint32_t *stageSpirv(vk::ShaderStageFlagBits s, std::vector<uint32_t> &{}, size_t &size) {{\n",
+			indent, packed ? "spirv" : "");
+		format_to(std::back_inserter(r), "{}    switch (s) {{\n", indent);
+		for (auto &s : sh) {
+			auto sn = get_execution_string(*s.reflection);
+			if (packed) {
+				format_to(std::back_inserter(r), "{0}      case {1}: size = {2}_size / 4; return autoshader::unpackSpirv(spirv, {2}_packed, {2}_packed_size);\n",
+					indent, get_shader_stage_flags(*s.reflection), sn);
+			}
+			else {
+				format_to(std::back_inserter(r), "{0}      case {1}: size = {2}_size / 4; return {2}_data;\n",
+					indent, get_shader_stage_flags(*s.reflection), sn);
+			}
+		}
+		format_to(std::back_inserter(r), "{}      default: size = 0; return nullptr;\n", indent);
+		format_to(std::back_inserter(r), "{}    }}\n", indent);
+		format_to(std::back_inserter(r), "{}  }}\n", indent);
+
+		// a stable hash of the stage code, for keeping pipeline caches by program
+		format_to(std::back_inserter(r), "\n");
+		format_to(std::back_inserter(r), "{}  static constexpr uint64_t contentHash() {{ return 0x{:016x}ull; }}\n",
+			indent, content_hash);
+
 		format_to(std::back_inserter(r), "\n");
 		format_to(std::back_inserter(r), "{}  void swap(Components &o) noexcept {{\n", indent);
 		format_to(std::back_inserter(r), "{}    std::swap(device, o.device);\n", indent);
@@ -128,7 +326,7 @@ namespace autoshader {
 		}
 		format_to(std::back_inserter(r), "{}    std::swap(layout, o.layout);\n", indent);
 		for (auto &s : sh) {
-			auto sn = get_execution_string(*s.comp);
+			auto sn = get_execution_string(*s.reflection);
 			format_to(std::back_inserter(r), "{0}    std::swap({1}, o.{1});\n", indent, sn);
 		}
 		format_to(std::back_inserter(r), "{}  }}\n", indent);
@@ -141,7 +339,7 @@ namespace autoshader {
 		}
 		format_to(std::back_inserter(r), "{}  vk::PipelineLayout layout;\n", indent);
 		for (size_t i = 0; i < sh.size(); ++i) {
-			auto sn = get_execution_string(*sh[i].comp);
+			auto sn = get_execution_string(*sh[i].reflection);
 			format_to(std::back_inserter(r), "{0}  vk::ShaderModule {1};\n", indent, sn);
 		}
 		format_to(std::back_inserter(r), "{}}};\n\n", indent);
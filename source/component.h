@@ -13,11 +13,15 @@
 namespace autoshader {
 
 	//------------------------------------------------------------------------------------------
-	//-- generate the shader component structure
+	//-- generate the shader component structure. packed shader data is unpacked into a
+	//-- scratch buffer while the shader modules are created. a subgroup_size other than zero is
+	//-- the preferred subgroup size of the compute stage. content_hash is returned by
+	//-- contentHash(), to key pipeline caches to the stage code.
 
 	void generate_components(fmt::memory_buffer &r,
 		std::map<uint32_t, DescriptorSet> &sets, vector<ShaderRecord> &sh, bool withVertex,
-		bool withPush, const string &indent);
+		bool withPush, bool packed, uint32_t subgroup_size, uint64_t content_hash,
+		const string &indent);
 
 } // namespace autoshader
 
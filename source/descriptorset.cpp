@@ -6,6 +6,7 @@
 //
 
 #include "descriptorset.h"
+#include "autoshader/layoutrules.h"
 
 namespace autoshader {
 
@@ -36,32 +37,54 @@ namespace autoshader {
 
 
 		//-------------------------------------------------------------------------------------------
-		// get descriptor sets for the given resource type
+		// what the declarations of a descriptor must agree on, as the runtime reflection checks
+
+		layoutrules::DescriptorShape descriptor_shape(const DescriptorRecord &d) {
+			return layoutrules::DescriptorShape{ uint32_t(d.type), uint32_t(d.imagedim),
+				uint32_t(d.arraysize) };
+		}
 
-		void get_descriptor_sets(std::map<uint32_t, DescriptorSet> &ds, spirv_cross::Compiler &comp,
-				spv::ExecutionModel em, spirv_cross::SmallVector<spirv_cross::Resource> &res,
-				DescriptorType d) {
-
-			for (auto &v : res) {
-				auto set = comp.get_decoration(v.id, spv::DecorationDescriptorSet);
-				auto bin = comp.get_decoration(v.id, spv::DecorationBinding);
-				auto type = comp.get_type(v.base_type_id);
-				auto var = comp.get_type(v.type_id);
-				int as = var.array.empty() ? 1 : var.array.front();
-				auto t = ds[set].descriptors.emplace(bin,
-					DescriptorRecord{ {}, d, type.image.dim, as });
-				if (t.first->second.type != d)
+
+		//-------------------------------------------------------------------------------------------
+		// add a descriptor to the sets, checking it matches any previous declaration
+
+		void add_descriptor(std::map<uint32_t, DescriptorSet> &ds, uint32_t set, uint32_t bin,
+				const DescriptorRecord &d) {
+			using layoutrules::DescriptorConflict;
+			auto t = ds[set].descriptors.emplace(bin,
+				DescriptorRecord{ {}, d.type, d.imagedim, d.arraysize });
+			switch (layoutrules::descriptorConflict(descriptor_shape(t.first->second),
+					descriptor_shape(d))) {
+				case DescriptorConflict::Type:
 					throw std::runtime_error(fmt::format(
 						"type mismatch for descriptor(set={} binding={})", set, bin));
-				if (t.first->second.imagedim != type.image.dim)
+				case DescriptorConflict::ImageDim:
 					throw std::runtime_error(fmt::format(
 						"image dimension mismatch for descriptor(set={} binding={})", set, bin));
-				if (t.first->second.arraysize != as)
+				case DescriptorConflict::ArraySize:
 					throw std::runtime_error(fmt::format(
 						"array size mismatch for descriptor(set={} binding={})", set, bin));
-				t.first->second.stages.insert(em);
-				if (t.first->second.name.empty())
-					t.first->second.name = v.name;
+				case DescriptorConflict::None:
+					break;
+			}
+			t.first->second.stages.insert(d.stages.begin(), d.stages.end());
+			if (t.first->second.name.empty())
+				t.first->second.name = d.name;
+		}
+
+
+		//-------------------------------------------------------------------------------------------
+		// get descriptor sets for the given resource type
+
+		void get_descriptor_sets(std::map<uint32_t, DescriptorSet> &ds, const Reflection &ir,
+				spv::ExecutionModel em, ResourceKind kind, DescriptorType d) {
+
+			for (auto &v : ir.resources(kind)) {
+				auto &type = ir.type(v.baseType);
+				auto array = ir.array(ir.type(v.type));
+				int as = array.empty() ? 1 : array.front();
+				add_descriptor(ds, v.set, v.binding, DescriptorRecord{ { em }, d, type.imagedim, as,
+					ir.string_at(v.name) });
 			}
 		}
 
@@ -101,26 +124,36 @@ namespace autoshader {
 	//-------------------------------------------------------------------------------------------
 	// return the execution model for the shaders first entry point
 
-	spv::ExecutionModel get_execution_model(spirv_cross::Compiler &comp) {
-		auto ep = comp.get_entry_points_and_stages();
-		if (ep.empty())
+	spv::ExecutionModel get_execution_model(const Reflection &ir) {
+		if (ir.entryPoints == 0)
 			throw std::runtime_error("shader stages has no entry point");
-		return ep[0].execution_model;
+		return ir.model;
 	}
 
 
 	//-------------------------------------------------------------------------------------------
 	// gather the descriptors from the shader
 
-	void get_descriptor_sets(std::map<uint32_t, DescriptorSet> &r, spirv_cross::Compiler &comp) {
-		auto em = get_execution_model(comp);
-		spirv_cross::ShaderResources res = comp.get_shader_resources();
-		get_descriptor_sets(r, comp, em, res.uniform_buffers, DescriptorType::Uniform);
-		get_descriptor_sets(r, comp, em, res.storage_buffers, DescriptorType::StorageBuffer);
-		get_descriptor_sets(r, comp, em, res.storage_images, DescriptorType::StorageImage);
-		get_descriptor_sets(r, comp, em, res.sampled_images, DescriptorType::ImageSampler);
-		get_descriptor_sets(r, comp, em, res.separate_images, DescriptorType::SampledImage);
-		get_descriptor_sets(r, comp, em, res.separate_samplers, DescriptorType::Sampler);
+	void get_descriptor_sets(std::map<uint32_t, DescriptorSet> &r, const Reflection &ir) {
+		auto em = get_execution_model(ir);
+		get_descriptor_sets(r, ir, em, ResourceKind::UniformBuffer, DescriptorType::Uniform);
+		get_descriptor_sets(r, ir, em, ResourceKind::StorageBuffer, DescriptorType::StorageBuffer);
+		get_descriptor_sets(r, ir, em, ResourceKind::StorageImage, DescriptorType::StorageImage);
+		get_descriptor_sets(r, ir, em, ResourceKind::SampledImage, DescriptorType::ImageSampler);
+		get_descriptor_sets(r, ir, em, ResourceKind::SeparateImage, DescriptorType::SampledImage);
+		get_descriptor_sets(r, ir, em, ResourceKind::SeparateSampler, DescriptorType::Sampler);
+	}
+
+
+	//-------------------------------------------------------------------------------------------
+	// merge the descriptors gathered from one shader into the pipeline sets
+
+	void merge_descriptor_sets(std::map<uint32_t, DescriptorSet> &r,
+			const std::map<uint32_t, DescriptorSet> &s) {
+		for (auto &set : s) {
+			for (auto &d : set.second.descriptors)
+				add_descriptor(r, set.first, d.first, d.second);
+		}
 	}
 
 	namespace {
@@ -168,19 +201,18 @@ R"({0}inline auto get{1}LayoutBindings({2}) {{
 	//-------------------------------------------------------------------------------------------
 	// return the stage flags for the first entry point
 
-	string get_shader_stage_flags(spirv_cross::Compiler &comp) {
-		return vulkan_stage_string(get_execution_model(comp));
+	string get_shader_stage_flags(const Reflection &ir) {
+		return vulkan_stage_string(get_execution_model(ir));
 	}
 
 
 	//-------------------------------------------------------------------------------------------
 	// return the execution model for the shaders first entry point
 
-	string get_first_entry_point_name(spirv_cross::Compiler &comp) {
-		auto ep = comp.get_entry_points_and_stages();
-		if (ep.empty())
+	string get_first_entry_point_name(const Reflection &ir) {
+		if (ir.entryPoints == 0)
 			throw std::runtime_error("shader stages has no entry point");
-		return ep[0].name;
+		return ir.entryPoint;
 	}
 
 } // namespace autoshader
@@ -8,7 +8,7 @@
 #define H_SOURCE_DESCRIPTORSET_H__
 
 #include "autoshader.h"
-#include "spirv_cross.hpp"
+#include "reflection.h"
 #include <fmt/format.h>
 #include <map>
 #include <set>
@@ -47,7 +47,7 @@ namespace autoshader {
 	//-------------------------------------------------------------------------------------------
 	// return the stage flags for the first entry point
 
-	string get_shader_stage_flags(spirv_cross::Compiler &comp);
+	string get_shader_stage_flags(const Reflection &ir);
 
 
 	//-------------------------------------------------------------------------------------------
@@ -59,19 +59,26 @@ namespace autoshader {
 	//-------------------------------------------------------------------------------------------
 	// return the execution model for the shaders first entry point
 
-	string get_first_entry_point_name(spirv_cross::Compiler &comp);
+	string get_first_entry_point_name(const Reflection &ir);
 
 
 	//-------------------------------------------------------------------------------------------
 	// return the execution model for the shaders first entry point
 
-	spv::ExecutionModel get_execution_model(spirv_cross::Compiler &comp);
+	spv::ExecutionModel get_execution_model(const Reflection &ir);
 
 
 	//-------------------------------------------------------------------------------------------
 	// gather the descriptors from the shader
 
-	void get_descriptor_sets(std::map<uint32_t, DescriptorSet> &r, spirv_cross::Compiler &comp);
+	void get_descriptor_sets(std::map<uint32_t, DescriptorSet> &r, const Reflection &ir);
+
+
+	//-------------------------------------------------------------------------------------------
+	// merge the descriptors gathered from one shader into the pipeline sets
+
+	void merge_descriptor_sets(std::map<uint32_t, DescriptorSet> &r,
+		const std::map<uint32_t, DescriptorSet> &s);
 
 
 	//-------------------------------------------------------------------------------------------
@@ -0,0 +1,367 @@
+//
+//  File: generate.cpp
+//
+//  Created by Jon Spencer on 2026-10-16 10:41:19
+//  Copyright (c) Jon Spencer. See LICENSE file.
+//
+
+#include "generate.h"
+#include "shadersource.h"
+#include "descriptorset.h"
+#include "descriptorwrite.h"
+#include "specializer.h"
+#include "vertexinput.h"
+#include "pushranges.h"
+#include "component.h"
+#include "namemap.h"
+#include "reflectoutput.h"
+#include "taskpool.h"
+#include "hash.h"
+#include <algorithm>
+#include <iostream>
+#include <fstream>
+
+#ifdef WIN32
+#include <direct.h>
+#define getcwd _getcwd
+#else
+#include <unistd.h>
+#endif
+
+namespace autoshader {
+
+	namespace {
+
+		void get_dependant_structs(vector<uint32_t> &r, vector<char> &visited, const Reflection &ir,
+				uint32_t b) {
+			if (b >= visited.size())
+				visited.resize(b + 1, 0);
+			if (visited[b])
+				return;
+			visited[b] = 1;
+			auto &type = ir.type(b);
+			if (type.basetype != spirv_cross::SPIRType::Struct)
+				throw std::runtime_error(fmt::format(
+					"get_dependant_structs called with non struct type {}", type.basetype));
+			for (auto &m : ir.struct_members(type)) {
+				auto &mtype = ir.type(m.type);
+				if (ir.type(mtype.self).basetype == spirv_cross::SPIRType::Struct) {
+					get_dependant_structs(r, visited, ir, mtype.self);
+				}
+			}
+			r.push_back(b);
+		}
+
+		bool is_file_match(const string &name, const string &data) {
+			std::ifstream str(name, std::ios::binary);
+			str.seekg(0, str.end);
+			size_t l = str.tellg();
+			if (l != data.size())
+				return false;
+			str.seekg(0, str.beg);
+			vector<char> t(l);
+			str.read(t.data(), t.size());
+			if (!str.good())
+				return false;
+			return std::equal(t.begin(), t.end(), data.begin());
+		}
+
+		void write_file(const string &name, const string &data) {
+			if (is_file_match(name, data))
+				return;
+			std::ofstream str(name, std::ios::binary);
+			str.write(data.data(), data.size());
+			if (!str.good())
+				throw std::runtime_error("error writing output to: " + name);
+		}
+
+		bool is_absolute(const string &p) {
+			#ifdef WIN32
+			if (p.size() > 1 && p[1] == ':')
+				return true;
+			if (!p.empty() && p[0] == '\\')
+				return true;
+			#endif
+			return !p.empty() && p[0] == '/';
+		}
+
+		void append(fmt::memory_buffer &r, const fmt::memory_buffer &p) {
+			r.append(p.data(), p.data() + p.size());
+		}
+
+	} // namespace
+
+
+	//------------------------------------------------------------------------------------------
+	//-- find the structures used by buffers and their dependencies
+
+	void find_buffer_structs(vector<uint32_t> &r, const Reflection &ir) {
+		vector<char> visited(ir.typeIndex.size(), 0);
+		for (auto t : r) {
+			if (t >= visited.size())
+				visited.resize(t + 1, 0);
+			visited[t] = 1;
+		}
+		for (auto &v : ir.resources(ResourceKind::UniformBuffer))
+			get_dependant_structs(r, visited, ir, v.baseType);
+		for (auto &v : ir.resources(ResourceKind::StorageBuffer))
+			get_dependant_structs(r, visited, ir, v.baseType);
+		for (auto &v : ir.resources(ResourceKind::PushConstantBuffer))
+			get_dependant_structs(r, visited, ir, v.baseType);
+	}
+
+
+	//------------------------------------------------------------------------------------------
+	//-- make a path absolute against the current directory
+
+	string absolute_path(const string &p) {
+		if (is_absolute(p))
+			return p;
+		char cwd[4096];
+		if (getcwd(cwd, sizeof(cwd)) == nullptr)
+			throw std::runtime_error("can't find the current directory");
+		return string(cwd) + "/" + p;
+	}
+
+
+	//------------------------------------------------------------------------------------------
+	//-- the binary file holding a stage - the data file name with the stage for an extension
+
+	string stage_binary_name(const string &data, const string &stage) {
+		auto s = data.find_last_of("/\\");
+		auto e = data.rfind('.');
+		auto base = e == string::npos || (s != string::npos && e < s) ? data : data.substr(0, e);
+		return base + "." + stage + ".bin";
+	}
+
+
+	//------------------------------------------------------------------------------------------
+	//-- load the spirv for every input
+
+	vector<ShaderRecord> load_shaders(const PipelineOptions &opts) {
+		vector<ShaderRecord> shaders(opts.input.empty() ? 1 : opts.input.size());
+		if (opts.input.empty())
+			shaders[0].source = load_spirv("stdin", std::cin);
+		for (size_t i = 0; i < opts.input.size(); ++i)
+			shaders[i].source = load_spirv(opts.input[i]);
+		return shaders;
+	}
+
+
+	//------------------------------------------------------------------------------------------
+	//-- reflect the loaded shaders and format the pipeline interface
+
+	PipelineOutput generate_pipeline(const string &prog, const PipelineOptions &opts,
+			vector<ShaderRecord> &shaders, size_t jobs) {
+
+		// parse all the shader stages and find all public structure definitions
+		bool withSource = !opts.noSource;
+		vector<std::map<uint32_t, DescriptorSet>> stageSets(shaders.size());
+		vector<StageData> stageData(withSource ? shaders.size() : 0);
+		vector<std::function<void()>> parses;
+		for (size_t i = 0; i < shaders.size(); ++i) {
+			parses.emplace_back([&, i] () {
+				auto &sh = shaders[i];
+				// the reflection is immutable, so a record keeps it but its names are found afresh
+				if (!sh.reflection)
+					sh.reflection = reflect_spirv(sh.source);
+				sh.structs.clear();
+				sh.names.clear();
+				find_buffer_structs(sh.structs, *sh.reflection);
+				get_descriptor_sets(stageSets[i], *sh.reflection);
+				// stripping only touches the emitted words, reflection has the names
+				if (withSource)
+					stageData[i] = stage_data(sh, opts.strip, opts.compress);
+			});
+		}
+		run_tasks(jobs, parses);
+
+		// combine the descriptors in shader order
+		std::map<uint32_t, DescriptorSet> descriptorSets;
+		for (auto &s : stageSets)
+			merge_descriptor_sets(descriptorSets, s);
+
+		// re-map potential name collisions
+		map_struct_names(shaders);
+
+		// the subgroup size is only required of a compute stage
+		if (opts.subgroupSize != 0 && std::none_of(shaders.begin(), shaders.end(),
+				[] (const ShaderRecord &s) {
+					return get_execution_model(*s.reflection) == spv::ExecutionModelGLCompute; }))
+			throw std::runtime_error("a subgroup size needs a compute shader");
+
+		// binary data is written as is and included by an assembler stub
+		bool incbin = opts.dataFormat == DataFormat::Incbin;
+		if (incbin && opts.data.empty())
+			throw std::runtime_error("the incbin data format needs a data file");
+
+		// Generate the output
+		fmt::memory_buffer r;
+		fmt::memory_buffer dr;
+		format_to(std::back_inserter(r), "// generated with {}\n\n", prog);
+
+		// figure out the namespace
+		auto &namespaces = opts.namespaces;
+		auto indent = namespaces.empty() ? string() : "  ";
+
+		if (!namespaces.empty()) {
+			for (size_t i = 0; i < namespaces.size(); ++i)
+				format_to(std::back_inserter(r), "{}namespace {} {{", i == 0 ? "" : " ", namespaces[i]);
+			format_to(std::back_inserter(r), "\n\n");
+
+			if (!opts.data.empty() && !incbin) {
+				for (size_t i = 0; i < namespaces.size(); ++i)
+					format_to(std::back_inserter(dr), "{}namespace {} {{", i == 0 ? "" : " ", namespaces[i]);
+				format_to(std::back_inserter(dr), "\n\n");
+			}
+		}
+
+		// emit the independent sections into their own buffers
+		bool withVertex = false;
+		bool withPush = false;
+		vector<fmt::memory_buffer> structParts(shaders.size()), sourceParts(shaders.size());
+		fmt::memory_buffer vertexPart, layoutPart, pushPart, writerPart, specPart, declPart;
+		fmt::memory_buffer reflectJson;
+		string reflectBinary;
+		vector<std::function<void()>> sections;
+
+		for (size_t i = 0; i < shaders.size(); ++i) {
+			sections.emplace_back([&, i] () {
+				for (auto t : shaders[i].structs) {
+					struct_definition(structParts[i], shaders[i], t, indent);
+					format_to(std::back_inserter(structParts[i]), ";\n\n");
+				}
+			});
+		}
+
+		if (!opts.noVertex) {
+			sections.emplace_back([&] () {
+				for (auto &sh : shaders) {
+					if (get_execution_model(*sh.reflection) != spv::ExecutionModelVertex)
+						continue;
+					withVertex = get_vertex_definition(vertexPart, *sh.reflection, opts.vertex, indent);
+				}
+			});
+		}
+
+		sections.emplace_back([&] () {
+			for (auto &s : descriptorSets) {
+				descriptor_layout(layoutPart, s.second, descriptorSets.size() == 1 ? "DescriptorSet" :
+					fmt::format("DescriptorSet{}", s.first), indent);
+			}
+		});
+
+		sections.emplace_back([&] () { withPush = push_ranges(pushPart, shaders, indent); });
+
+		sections.emplace_back([&] () { descriptor_writer(writerPart, descriptorSets, indent); });
+
+		sections.emplace_back([&] () { specializers(specPart, shaders, indent); });
+
+		// the machine readable reflection is built from the same records in either format
+		if (!opts.reflectJson.empty() || !opts.reflectBinary.empty()) {
+			sections.emplace_back([&] () {
+				auto tables = reflect_tables(shaders, descriptorSets, opts.vertex, opts.noVertex);
+				if (!opts.reflectJson.empty())
+					reflect_json(reflectJson, prog, tables);
+				if (!opts.reflectBinary.empty())
+					reflectBinary = reflect_binary(tables);
+			});
+		}
+
+		if (withSource) {
+			sections.emplace_back([&] () { shader_source_decl(declPart, stageData, indent); });
+			for (size_t i = 0; i < shaders.size() && !incbin; ++i)
+				sections.emplace_back([&, i] () { stage_source(sourceParts[i], stageData[i], indent); });
+		}
+
+		run_tasks(jobs, sections);
+
+		// stitch the sections together in order
+		for (auto &p : structParts)
+			append(r, p);
+		append(r, vertexPart);
+		append(r, layoutPart);
+		append(r, pushPart);
+		append(r, writerPart);
+		append(r, specPart);
+
+		if (withSource) {
+			append(r, declPart);
+
+			// the components depend on the vertex and push constant sections, and name the
+			// stage code by a hash of the words given to the driver
+			Hasher h;
+			for (auto &d : stageData)
+				h.add(d.stage).add(d.words, d.size());
+			generate_components(r, descriptorSets, shaders, withVertex, withPush, opts.compress,
+				opts.subgroupSize, h.result().lo, indent);
+
+			if (!incbin) {
+				auto &sr = !opts.data.empty() ? dr : r;
+				shader_source_begin(sr, &sr == &r);
+				for (auto &p : sourceParts)
+					append(sr, p);
+				shader_source_end(sr, &sr == &r);
+			}
+		}
+
+		// the stub refers to the binaries by absolute path so it can be assembled from anywhere
+		vector<OutputFile> extra;
+		if (incbin && withSource) {
+			vector<string> paths;
+			for (auto &d : stageData) {
+				auto name = stage_binary_name(opts.data, d.stage);
+				paths.push_back(absolute_path(name));
+				extra.push_back(OutputFile{ name, stage_binary(d) });
+			}
+			incbin_source(dr, prog, stageData, namespaces, paths);
+		}
+		else if (incbin) {
+			format_to(std::back_inserter(dr), "/* generated with {} */\n", prog);
+		}
+
+		if (!opts.reflectJson.empty())
+			extra.push_back(OutputFile{ opts.reflectJson, to_string(reflectJson) });
+		if (!opts.reflectBinary.empty())
+			extra.push_back(OutputFile{ opts.reflectBinary, move(reflectBinary) });
+
+		if (!namespaces.empty()) {
+			for (size_t i = 0; i < namespaces.size(); ++i)
+				format_to(std::back_inserter(r), "{}}}", i == 0 ? "" : " ");
+			format_to(std::back_inserter(r), "\n");
+
+			if (!opts.data.empty() && !incbin) {
+				for (size_t i = 0; i < namespaces.size(); ++i)
+					format_to(std::back_inserter(dr), "{}}}", i == 0 ? "" : " ");
+				format_to(std::back_inserter(dr), "\n");
+			}
+		}
+
+		vector<StageSize> sizes;
+		for (size_t i = 0; i < stageData.size(); ++i) {
+			sizes.push_back(StageSize{ stageData[i].stage, sizeof(uint32_t) * shaders[i].source.size(),
+				stageData[i].emitted_size() });
+		}
+
+		return PipelineOutput{ to_string(r), to_string(dr), move(extra), move(sizes) };
+	}
+
+
+	//------------------------------------------------------------------------------------------
+	//-- write the output files that have changed
+
+	void write_output(const PipelineOptions &opts, const PipelineOutput &out) {
+		if (opts.output.empty())
+			std::cout.write(out.header.data(), out.header.size());
+		else
+			write_file(opts.output, out.header);
+
+		// write the binaries first so the stub never refers to stale data
+		for (auto &f : out.extra)
+			write_file(f.name, f.contents);
+
+		if (!opts.data.empty())
+			write_file(opts.data, out.data);
+	}
+
+} // namespace autoshader
@@ -0,0 +1,104 @@
+//
+//  File: generate.h
+//
+//  Created by Jon Spencer on 2026-10-16 10:41:05
+//  Copyright (c) Jon Spencer. See LICENSE file.
+//
+#ifndef H_SOURCE_GENERATE_H__
+#define H_SOURCE_GENERATE_H__
+
+#include "typereflect.h"
+
+namespace autoshader {
+
+	//------------------------------------------------------------------------------------------
+	//-- outputFormatVersion: the version of the generated output, part of the cache key. bump
+	//-- it with any change to what the emitters write for the same input and options.
+
+	constexpr uint32_t outputFormatVersion = 5;
+
+	//------------------------------------------------------------------------------------------
+	//-- DataFormat: how the shader data is emitted. Source writes c++ array initializers, Incbin
+	//-- writes the raw words of each stage to a binary file and makes the data file an
+	//-- assembler stub that includes them.
+
+	enum struct DataFormat {
+		Source,
+		Incbin,
+	};
+
+	//------------------------------------------------------------------------------------------
+	//-- PipelineOptions: the settings for generating one pipeline interface
+
+	struct PipelineOptions {
+		vector<string> input;
+		string output;
+		string data;
+		vector<string> namespaces;
+		string vertex = "Vertex";
+		bool noVertex = false;
+		bool noSource = false;
+		DataFormat dataFormat = DataFormat::Source;
+		bool strip = false;
+		bool compress = false;
+		uint32_t subgroupSize = 0;
+		string reflectJson;
+		string reflectBinary;
+	};
+
+	//------------------------------------------------------------------------------------------
+	//-- StageSize: the size of a stage's spirv and of the data emitted for it, in bytes
+
+	struct StageSize {
+		string stage;
+		size_t original;
+		size_t emitted;
+	};
+
+	//------------------------------------------------------------------------------------------
+	//-- OutputFile: an additional generated file
+
+	struct OutputFile {
+		string name;
+		string contents;
+	};
+
+	//------------------------------------------------------------------------------------------
+	//-- PipelineOutput: the generated interface header, the optional data file, any stage
+	//-- binaries the data file refers to and the size of the emitted stages
+
+	struct PipelineOutput {
+		string header;
+		string data;
+		vector<OutputFile> extra;
+		vector<StageSize> sizes;
+	};
+
+	//------------------------------------------------------------------------------------------
+	//-- find the structures used by buffers, each after the structures it depends on
+	void find_buffer_structs(vector<uint32_t> &r, const Reflection &ir);
+
+	//------------------------------------------------------------------------------------------
+	//-- make a path absolute against the current directory
+	string absolute_path(const string &p);
+
+	//------------------------------------------------------------------------------------------
+	//-- the binary file holding a stage for the Incbin data format
+	string stage_binary_name(const string &data, const string &stage);
+
+	//------------------------------------------------------------------------------------------
+	//-- load the spirv for every input (stdin if there are none)
+	vector<ShaderRecord> load_shaders(const PipelineOptions &opts);
+
+	//------------------------------------------------------------------------------------------
+	//-- reflect the loaded shaders and format the pipeline interface
+	PipelineOutput generate_pipeline(const string &prog, const PipelineOptions &opts,
+		vector<ShaderRecord> &shaders, size_t jobs);
+
+	//------------------------------------------------------------------------------------------
+	//-- write the outputs, leaving files that are already up to date untouched
+	void write_output(const PipelineOptions &opts, const PipelineOutput &out);
+
+} // namespace autoshader
+
+#endif // H_SOURCE_GENERATE_H__
@@ -0,0 +1,113 @@
+//
+//  File: hash.cpp
+//
+//  Created by Jon Spencer on 2026-10-16 11:20:58
+//  Copyright (c) Jon Spencer. See LICENSE file.
+//
+
+#include "hash.h"
+#include <fmt/format.h>
+#include <algorithm>
+#include <cstring>
+
+namespace autoshader {
+
+	namespace {
+
+		constexpr uint64_t c1 = 0x87c37b91114253d5ull;
+		constexpr uint64_t c2 = 0x4cf5ad432745937full;
+
+		inline uint64_t rotl(uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+
+		inline uint64_t fmix(uint64_t k) {
+			k ^= k >> 33;
+			k *= 0xff51afd7ed558ccdull;
+			k ^= k >> 33;
+			k *= 0xc4ceb9fe1a85ec53ull;
+			k ^= k >> 33;
+			return k;
+		}
+
+		inline uint64_t load(const unsigned char *p) {
+			uint64_t r;
+			memcpy(&r, p, sizeof(r));
+			return r;
+		}
+
+		inline void mix_block(uint64_t &h1, uint64_t &h2, const unsigned char *b) {
+			uint64_t k1 = load(b), k2 = load(b + 8);
+			k1 *= c1; k1 = rotl(k1, 31); k1 *= c2; h1 ^= k1;
+			h1 = rotl(h1, 27); h1 += h2; h1 = h1 * 5 + 0x52dce729;
+			k2 *= c2; k2 = rotl(k2, 33); k2 *= c1; h2 ^= k2;
+			h2 = rotl(h2, 31); h2 += h1; h2 = h2 * 5 + 0x38495ab5;
+		}
+
+	} // namespace
+
+
+	string Hash128::hex() const {
+		return fmt::format("{:016x}{:016x}", hi, lo);
+	}
+
+
+	//------------------------------------------------------------------------------------------
+	//-- add a range of bytes to the hash
+
+	Hasher &Hasher::add(const void *d, size_t l) {
+		auto p = static_cast<const unsigned char*>(d);
+		size_t used = length & 15;
+		length += l;
+
+		// finish off a partial block
+		if (used != 0) {
+			size_t n = std::min(l, 16 - used);
+			memcpy(tail + used, p, n);
+			p += n;
+			l -= n;
+			if (used + n < 16)
+				return *this;
+			mix_block(h1, h2, tail);
+		}
+
+		for (; l >= 16; p += 16, l -= 16)
+			mix_block(h1, h2, p);
+
+		memcpy(tail, p, l);
+		return *this;
+	}
+
+
+	//------------------------------------------------------------------------------------------
+	//-- finalize the hash without disturbing the running state
+
+	Hash128 Hasher::result() const {
+		uint64_t a = h1, b = h2;
+		uint64_t k1 = 0, k2 = 0;
+		size_t used = length & 15;
+		for (size_t i = used; i-- > 8;)
+			k2 = (k2 << 8) | tail[i];
+		for (size_t i = std::min(used, size_t(8)); i-- > 0;)
+			k1 = (k1 << 8) | tail[i];
+		if (used > 8) {
+			k2 *= c2; k2 = rotl(k2, 33); k2 *= c1; b ^= k2;
+		}
+		if (used > 0) {
+			k1 *= c1; k1 = rotl(k1, 31); k1 *= c2; a ^= k1;
+		}
+
+		a ^= length;
+		b ^= length;
+		a += b;
+		b += a;
+		a = fmix(a);
+		b = fmix(b);
+		a += b;
+		b += a;
+
+		Hash128 r;
+		r.lo = a;
+		r.hi = b;
+		return r;
+	}
+
+} // namespace autoshader
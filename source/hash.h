@@ -0,0 +1,54 @@
+//
+//  File: hash.h
+//
+//  Created by Jon Spencer on 2026-10-16 11:20:44
+//  Copyright (c) Jon Spencer. See LICENSE file.
+//
+#ifndef H_SOURCE_HASH_H__
+#define H_SOURCE_HASH_H__
+
+#include "autoshader.h"
+#include <cstdint>
+
+namespace autoshader {
+
+	//------------------------------------------------------------------------------------------
+	//-- Hash128: a 128 bit content hash
+
+	struct Hash128 {
+		uint64_t lo = 0, hi = 0;
+
+		bool operator == (const Hash128 &o) const { return lo == o.lo && hi == o.hi; }
+		bool operator != (const Hash128 &o) const { return !(*this == o); }
+		bool operator < (const Hash128 &o) const { return hi != o.hi ? hi < o.hi : lo < o.lo; }
+
+		string hex() const;
+	};
+
+	struct Hash128Hasher {
+		size_t operator () (const Hash128 &h) const { return size_t(h.lo ^ (h.hi * 31)); }
+	};
+
+	//------------------------------------------------------------------------------------------
+	//-- Hasher: incremental MurmurHash3 (x64, 128 bit) over any number of byte ranges
+
+	struct Hasher {
+		explicit Hasher(uint64_t seed = 0) : h1(seed), h2(seed) {}
+
+		Hasher &add(const void *d, size_t l);
+		Hasher &add(uint64_t v) { return add(&v, sizeof(v)); }
+		Hasher &add(const Hash128 &h) { return add(h.lo).add(h.hi); }
+
+		// strings are length prefixed so adjacent strings can't run together
+		Hasher &add(const string &s) { return add(uint64_t(s.size())).add(s.data(), s.size()); }
+
+		Hash128 result() const;
+
+		uint64_t h1, h2;
+		uint64_t length = 0;
+		unsigned char tail[16];
+	};
+
+} // namespace autoshader
+
+#endif // H_SOURCE_HASH_H__
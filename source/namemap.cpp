@@ -7,13 +7,15 @@
 
 #include "namemap.h"
 #include "shadersource.h"
+#include "hash.h"
 #include <set>
+#include <unordered_map>
 
 namespace autoshader {
 
 	namespace {
 
-		void struct_signature(fmt::memory_buffer &r, spirv_cross::Compiler &comp, uint32_t t);
+		void struct_signature(fmt::memory_buffer &r, const Reflection &ir, uint32_t t);
 
 
 		//------------------------------------------------------------------------------------------
@@ -24,17 +26,27 @@ namespace autoshader {
 			uint32_t st;
 		};
 
+		//------------------------------------------------------------------------------------------
+		//-- StructGroup: like named structures with the same layout, in the order they're found
+
+		struct StructGroup {
+			Hash128 print;
+			vector<StructIndex> members;
+			string signature;
+		};
+
 		//------------------------------------------------------------------------------------------
 		//-- assign structure names to all the conflcting signatures
 
-		void assign_struct_names(vector<ShaderRecord> &sh, std::set<string> &shaders,
-				std::map<string, vector<StructIndex>> &sigs, string post) {
+		void assign_struct_names(vector<ShaderRecord> &sh, const vector<StructGroup*> &shaders,
+				string post) {
 			// assign each signature a unique name
 			size_t i = 0;
-			for (auto &sig : shaders) {
-				auto &s = sigs[sig];
+			for (auto sig : shaders) {
+				auto &s = sig->members;
 				auto &c = s.front();
-				string name = sh[c.sh].comp->get_name(c.st) + post;
+				auto &ir = *sh[c.sh].reflection;
+				string name = ir.name(ir.type(c.st)) + post;
 				if (shaders.size() > 1)
 					name += fmt::format("_{}", i++);
 
@@ -52,43 +64,132 @@ namespace autoshader {
 		}
 
 
+		//------------------------------------------------------------------------------------------
+		//-- StructPrints: the memoized fingerprints of the structures in a shader
+
+		typedef std::unordered_map<uint32_t, Hash128> StructPrints;
+
+		//------------------------------------------------------------------------------------------
+		//-- the fingerprint of a structure - a hash of everything in its signature string, with
+		//-- nested structures hashed once and added by their own fingerprint
+
+		Hash128 struct_fingerprint(StructPrints &prints, const Reflection &ir, uint32_t t) {
+			using spirv_cross::SPIRType;
+			auto p = prints.find(t);
+			if (p != prints.end())
+				return p->second;
+
+			auto &type = ir.type(t);
+			if (type.basetype != SPIRType::Struct)
+				throw std::runtime_error("struct_fingerprint called on non-struct");
+
+			auto members = ir.struct_members(type);
+			Hasher h;
+			h.add(ir.name(type));
+			h.add(uint64_t(type.size));
+			h.add(uint64_t(members.size()));
+			for (auto &m : members) {
+				auto &mtype = ir.type(m.type);
+				auto array = ir.array(mtype);
+				h.add(ir.string_at(m.name));
+				if (mtype.basetype == SPIRType::Struct)
+					h.add(uint64_t(1)).add(struct_fingerprint(prints, ir, mtype.self));
+				else
+					h.add(uint64_t(0)).add(type_string(ir, mtype));
+				h.add(uint64_t(m.offset));
+				if (mtype.columns > 1)
+					h.add(uint64_t(m.matrixStride));
+				if (!array.empty())
+					h.add(uint64_t(m.arrayStride));
+				h.add(uint64_t(array.size()));
+				for (auto a : array)
+					h.add(uint64_t(a));
+			}
+
+			auto r = h.result();
+			prints.emplace(t, r);
+			return r;
+		}
+
+
+		//------------------------------------------------------------------------------------------
+		//-- compare everything in the signature strings of two structures, for fingerprints that
+		//-- match
+
+		bool same_struct(const Reflection &ia, uint32_t ta, const Reflection &ib, uint32_t tb) {
+			using spirv_cross::SPIRType;
+			auto &a = ia.type(ta);
+			auto &b = ib.type(tb);
+			auto am = ia.struct_members(a), bm = ib.struct_members(b);
+			if (ia.name(a) != ib.name(b) || a.size != b.size || am.size() != bm.size())
+				return false;
+
+			for (size_t i = 0; i < am.size(); ++i) {
+				auto &ma = ia.type(am[i].type);
+				auto &mb = ib.type(bm[i].type);
+				auto aa = ia.array(ma), ba = ib.array(mb);
+				if (ia.string_at(am[i].name) != ib.string_at(bm[i].name))
+					return false;
+				bool sa = ma.basetype == SPIRType::Struct, sb = mb.basetype == SPIRType::Struct;
+				if (sa != sb)
+					return false;
+				if (sa && !same_struct(ia, ma.self, ib, mb.self))
+					return false;
+				if (!sa && type_string(ia, ma) != type_string(ib, mb))
+					return false;
+				if (am[i].offset != bm[i].offset)
+					return false;
+				if ((ma.columns > 1) != (mb.columns > 1))
+					return false;
+				if (ma.columns > 1 && am[i].matrixStride != bm[i].matrixStride)
+					return false;
+				if (aa.size() != ba.size() || !std::equal(aa.begin(), aa.end(), ba.begin()))
+					return false;
+				if (!aa.empty() && am[i].arrayStride != bm[i].arrayStride)
+					return false;
+			}
+			return true;
+		}
+
+
 		//------------------------------------------------------------------------------------------
 		//-- return the signature string for a type
 
-		void type_signature(fmt::memory_buffer &r, spirv_cross::Compiler &comp, uint32_t t) {
+		void type_signature(fmt::memory_buffer &r, const Reflection &ir, uint32_t t) {
 			using spirv_cross::SPIRType;
-			auto type = comp.get_type(t);
+			auto &type = ir.type(t);
 			if (type.basetype == SPIRType::Struct) {
 				format_to(std::back_inserter(r), "{{");
-				struct_signature(r, comp, type.self);
+				struct_signature(r, ir, type.self);
 				format_to(std::back_inserter(r), "}}");
 			}
 			else {
-				format_to(std::back_inserter(r), "{}", type_string(comp, type));
+				format_to(std::back_inserter(r), "{}", type_string(ir, type));
 			}
 		}
 
 		//------------------------------------------------------------------------------------------
 		//-- format the struct signature into a buffer
 
-		void struct_signature(fmt::memory_buffer &r, spirv_cross::Compiler &comp, uint32_t t) {
+		void struct_signature(fmt::memory_buffer &r, const Reflection &ir, uint32_t t) {
 			using spirv_cross::SPIRType;
-			auto type = comp.get_type(t);
+			auto &type = ir.type(t);
 			if (type.basetype != SPIRType::Struct)
 				throw std::runtime_error("struct_signature called on non-struct");
 
-			format_to(std::back_inserter(r), "{},{:09d}:", comp.get_name(t), comp.get_declared_struct_size(type));
+			format_to(std::back_inserter(r), "{},{:09d}:", ir.name(type), type.size);
 
-			for (uint32_t i = 0; size_t(i) < type.member_types.size(); ++i) {
-				auto mtype = comp.get_type(type.member_types[i]);
-				format_to(std::back_inserter(r), "{},", comp.get_member_name(t, i));
-				type_signature(r, comp, type.member_types[i]);
-				format_to(std::back_inserter(r), ",{}", comp.type_struct_member_offset(type, i));
+			for (auto &m : ir.struct_members(type)) {
+				auto &mtype = ir.type(m.type);
+				auto array = ir.array(mtype);
+				format_to(std::back_inserter(r), "{},", ir.string_at(m.name));
+				type_signature(r, ir, m.type);
+				format_to(std::back_inserter(r), ",{}", m.offset);
 				if (mtype.columns > 1)
-					format_to(std::back_inserter(r), ";{}", comp.type_struct_member_matrix_stride(type, i));
-				if (!mtype.array.empty())
-					format_to(std::back_inserter(r), ",{}", comp.type_struct_member_array_stride(type, i));
-				for (auto t : mtype.array)
+					format_to(std::back_inserter(r), ";{}", m.matrixStride);
+				if (!array.empty())
+					format_to(std::back_inserter(r), ",{}", m.arrayStride);
+				for (auto t : array)
 					format_to(std::back_inserter(r), ",{}", t);
 				format_to(std::back_inserter(r), ":");
 			}
@@ -97,9 +198,9 @@ namespace autoshader {
 		//------------------------------------------------------------------------------------------
 		//-- return the signature string for a structure type
 
-		string struct_signature(spirv_cross::Compiler &comp, uint32_t t) {
+		string struct_signature(const Reflection &ir, uint32_t t) {
 			fmt::memory_buffer r;
-			struct_signature(r, comp, t);
+			struct_signature(r, ir, t);
 			return to_string(r);
 		}
 
@@ -114,30 +215,58 @@ namespace autoshader {
 		// build a map of all like named structures
 		for (size_t i = 0; i < sh.size(); ++i) {
 			for (auto t : sh[i].structs) {
-				names[sh[i].comp->get_name(t)].push_back({ i, t });
+				auto &ir = *sh[i].reflection;
+				names[ir.name(ir.type(t))].push_back({ i, t });
 			}
 		}
 
 		// fix any name collisions
+		vector<StructPrints> prints(sh.size());
 		for (auto &p : names) {
-			// get all the different structure layouts
-			std::map<string, vector<StructIndex>> sigs;
+			// group the different structure layouts by fingerprint
+			vector<StructGroup> groups;
+			std::unordered_map<Hash128, vector<size_t>, Hash128Hasher> byPrint;
 			for (auto i : p.second) {
-				auto sig = struct_signature(*sh[i.sh].comp, i.st);
-				sigs[sig].push_back(i);
+				auto print = struct_fingerprint(prints[i.sh], *sh[i.sh].reflection, i.st);
+				auto &candidates = byPrint[print];
+				auto g = std::find_if(candidates.begin(), candidates.end(), [&] (size_t g) {
+					auto &f = groups[g].members.front();
+					return same_struct(*sh[f.sh].reflection, f.st, *sh[i.sh].reflection, i.st);
+				});
+				if (g != candidates.end()) {
+					groups[*g].members.push_back(i);
+				}
+				else {
+					candidates.push_back(groups.size());
+					groups.push_back(StructGroup{ print, { i }, string() });
+				}
+			}
+
+			// the numbering of conflicting layouts follows their signature strings, which are
+			// only needed when there is a conflict
+			vector<StructGroup*> sorted;
+			for (auto &g : groups)
+				sorted.push_back(&g);
+			if (groups.size() > 1) {
+				for (auto &g : groups) {
+					auto &f = g.members.front();
+					g.signature = struct_signature(*sh[f.sh].reflection, f.st);
+				}
+				std::sort(sorted.begin(), sorted.end(), [] (auto a, auto b) {
+					return a->signature < b->signature; });
 			}
 
 			// figure out which structs are shared between shaders
-			std::set<string> globals;
-			vector<std::set<string>> locals(sh.size());
-			for (auto &s : sigs) {
+			vector<StructGroup*> globals;
+			vector<vector<StructGroup*>> locals(sh.size());
+			for (auto g : sorted) {
 				std::set<size_t> sources;
-				for (auto i : s.second)
+				for (auto i : g->members)
 					sources.insert(i.sh);
 				if (sources.size() == 1)
-					locals[*sources.begin()].insert(s.first);
+					locals[*sources.begin()].push_back(g);
 				else
-					globals.insert(s.first);
+					globals.push_back(g);
 			}
 
 			// count the number of non-empty shader namespaces
@@ -145,10 +274,10 @@ namespace autoshader {
 				std::count_if(locals.begin(), locals.end(), [] (auto &v) { return !v.empty(); });
 
 			// assign the struct names for each shader namespace
-			assign_struct_names(sh, globals, sigs, string());
+			assign_struct_names(sh, globals, string());
 			for (size_t i = 0; i < locals.size(); ++i) {
-				assign_struct_names(sh, locals[i], sigs, notempty == 1 ? string() :
-					"_" + get_execution_string(*sh[i].comp));
+				assign_struct_names(sh, locals[i], notempty == 1 ? string() :
+					"_" + get_execution_string(*sh[i].reflection));
 			}
 		}
 	}
@@ -7,59 +7,24 @@
 
 #include "pushranges.h"
 #include "descriptorset.h"
+#include "autoshader/layoutrules.h"
 #include <set>
 
 namespace autoshader {
 
 	namespace {
 
-		struct Range {
-			uint32_t start, end;
-		};
-
-		struct FlagRange {
-			uint32_t start, end;
-			std::set<spv::ExecutionModel> stages;
-		};
-
-		typedef vector<Range> Ranges;
-		typedef std::map<spv::ExecutionModel, Ranges> RangeMap;
-
-		uint32_t nextRangeAtOrAfter(const Ranges &r, uint32_t at) {
-			for (auto &i : r) {
-				if (i.start >= at)
-					return i.start;
-				if (i.end >= at)
-					return i.end;
-			}
-			return ~0u;
-		}
-
-		uint32_t nextRangeAtOrAfter(const RangeMap &rangemap, uint32_t at) {
-			uint32_t a = ~0u;
-			for (auto &i : rangemap)
-				a = std::min(a, nextRangeAtOrAfter(i.second, at));
-			return a;
-		}
-
-		bool active_at_spot(const Ranges &r, uint32_t at) {
-			for (auto &i : r) {
-				if (i.end <= at)
-					continue;
-				return i.start <= at;
-			}
-			return false;
-		}
-
 		//------------------------------------------------------------------------------------------
 		// the size of the type as declared in c
 
-		size_t push_type_size(spirv_cross::Compiler &comp, spirv_cross::SPIRType stype, uint32_t i) {
+		size_t push_type_size(const Reflection &ir, const ReflectMember &m) {
 			using spirv_cross::SPIRType;
 
-			auto type = comp.get_type(stype.member_types[i]);
-			if (!type.array.empty())
-				return type.array.front() * comp.type_struct_member_array_stride(stype, i);
+			// the last length is the outermost array
+			auto &type = ir.type(m.type);
+			auto array = ir.array(type);
+			if (!array.empty())
+				return layoutrules::arrayMemberSize(array.back(), m.arrayStride);
 
 			switch (type.basetype) {
 				default:
@@ -76,7 +41,7 @@ namespace autoshader {
 					return type.width * type.vecsize * type.columns / 8;
 
 				case SPIRType::Struct:
-					return comp.get_declared_struct_size(type);
+					return ir.type(type.self).size;
 			}
 
 			throw std::runtime_error("invalid type for push_type_size");
@@ -86,60 +51,51 @@ namespace autoshader {
 
 
 	//------------------------------------------------------------------------------------------
-	//-- format the push ranges into the buffer
+	//-- split the push constants into ranges used by the same stages
 
-	bool push_ranges(fmt::memory_buffer &r, vector<ShaderRecord> &sh, const string& indent) {
-		// gather the range of used push constants for each shader stage
-		std::map<spv::ExecutionModel, vector<Range>> rangemap;
+	vector<PushRange> get_push_ranges(vector<ShaderRecord> &sh) {
+		// gather the range of used push constants for each shader stage, with the rules the
+		// runtime reflection uses
+		vector<layoutrules::StageRange> ranges;
 		for (auto &s : sh) {
-			auto res = s.comp->get_shader_resources();
-			if (res.push_constant_buffers.empty())
+			auto &ir = *s.reflection;
+			auto res = ir.resources(ResourceKind::PushConstantBuffer);
+			if (res.empty())
 				continue;
-			auto em = get_execution_model(*s.comp);
-			auto &pr = res.push_constant_buffers.front();
-			auto type = s.comp->get_type(pr.base_type_id);
-			uint32_t rangeStart = 0, rangeEnd = 0;
-			for (uint32_t i = 0; size_t(i) < type.member_types.size(); ++i) {
-				uint32_t o = s.comp->type_struct_member_offset(type, i);
-				if (o != rangeEnd) {
-					if (rangeEnd != 0)
-						rangemap[em].push_back({ rangeStart, rangeEnd });
-					rangeStart = o;
-				}
-				auto sz = push_type_size(*s.comp, type, i);
-				rangeEnd = o + sz;
-			}
-			if (rangeEnd != 0)
-				rangemap[em].push_back({ rangeStart, rangeEnd });
+			auto em = get_execution_model(ir);
+			if (uint32_t(em) >= 32)
+				throw std::runtime_error("unsupported execution model for shader");
+			layoutrules::PushBlockRanges block(ranges, 1u << em);
+			for (auto &m : ir.struct_members(ir.type(res.front().baseType)))
+				block.member(m.offset, uint32_t(push_type_size(ir, m)));
+			block.finish();
 		}
 
-		// no push contants
-		if (rangemap.empty())
-			return false;
-
-		// find the start of the first range.
-		vector<FlagRange> flagranges;
-		for (uint32_t rangeStart = nextRangeAtOrAfter(rangemap, 0); rangeStart != ~0u;) {
-			// find the next stop point
-			auto rangeEnd = nextRangeAtOrAfter(rangemap, rangeStart + 1);
-			if (rangeEnd == ~0u)
-				break;
-
-			// grab the stages active here
+		// split them into ranges used by the same stages
+		vector<PushRange> flagranges;
+		layoutrules::splitPushRanges(ranges, [&flagranges] (uint32_t stages, uint32_t start,
+				uint32_t end) {
 			std::set<spv::ExecutionModel> models;
-			for (auto &i : rangemap) {
-				if (active_at_spot(i.second, rangeStart))
-					models.insert(i.first);
+			for (uint32_t m = 0; m < 32; ++m) {
+				if ((stages & (1u << m)) != 0)
+					models.insert(spv::ExecutionModel(m));
 			}
+			flagranges.emplace_back(PushRange{ start, end, move(models) });
+		});
 
-			if (!models.empty()) {
-				// store the range if active
-				flagranges.emplace_back(FlagRange{ rangeStart, rangeEnd, move(models) });
-			}
+		return flagranges;
+	}
 
-			// start again
-			rangeStart = rangeEnd;
-		}
+
+	//------------------------------------------------------------------------------------------
+	//-- format the push ranges into the buffer
+
+	bool push_ranges(fmt::memory_buffer &r, vector<ShaderRecord> &sh, const string& indent) {
+		auto flagranges = get_push_ranges(sh);
+
+		// no push contants
+		if (flagranges.empty())
+			return false;
 
 		bool c = false;
 		format_to(std::back_inserter(r), "{}inline auto getPushConstantRanges() {{\n", indent);
@@ -8,9 +8,23 @@
 #define H_SOURCE_PUSHRANGES_H__
 
 #include "typereflect.h"
+#include <set>
 
 namespace autoshader {
 
+	//------------------------------------------------------------------------------------------
+	//-- PushRange: a range of the push constants and the stages that use all of it
+
+	struct PushRange {
+		uint32_t start, end;
+		std::set<spv::ExecutionModel> stages;
+	};
+
+	//------------------------------------------------------------------------------------------
+	//-- split the push constants into ranges used by the same stages
+
+	vector<PushRange> get_push_ranges(vector<ShaderRecord> &sh);
+
 	//------------------------------------------------------------------------------------------
 	//-- format the push ranges into the buffer
 
@@ -0,0 +1,208 @@
+//
+//  File: reflection.cpp
+//
+//  Created by Jon Spencer on 2026-10-17 00:03:59
+//  Copyright (c) Jon Spencer. See LICENSE file.
+//
+
+#include "reflection.h"
+#include <fmt/format.h>
+
+namespace autoshader {
+
+	namespace {
+
+		//------------------------------------------------------------------------------------------
+		//-- ReflectionBuilder: fills in a reflection from the compiler
+
+		struct ReflectionBuilder {
+			const spirv_cross::Compiler &comp;
+			Reflection &r;
+
+			uint32_t add_string(const string &s) {
+				r.strings.push_back(s);
+				return uint32_t(r.strings.size() - 1);
+			}
+
+			void add_type(uint32_t id, bool layout);
+			void add_layout(uint32_t index, uint32_t id);
+			void add_resources(const spirv_cross::SmallVector<spirv_cross::Resource> &res,
+				ResourceKind kind, bool layout);
+			ReflectConstant add_constant(const spirv_cross::SpecializationConstant &c, bool named);
+		};
+
+		//------------------------------------------------------------------------------------------
+		//-- add a type, along with its base type and the layout of a buffer structure
+
+		void ReflectionBuilder::add_type(uint32_t id, bool layout) {
+			using spirv_cross::SPIRType;
+			if (id >= r.typeIndex.size())
+				r.typeIndex.resize(id + 1, Reflection::noType);
+
+			auto &st = comp.get_type(id);
+			auto index = r.typeIndex[id];
+			if (index == Reflection::noType) {
+				ReflectType t;
+				t.basetype = st.basetype;
+				t.width = st.width;
+				t.vecsize = st.vecsize;
+				t.columns = st.columns;
+				t.self = st.self;
+				if (st.basetype == SPIRType::Image || st.basetype == SPIRType::SampledImage) {
+					t.imagedim = st.image.dim;
+					t.imagesampled = st.image.sampled;
+				}
+				t.arrayIndex = uint32_t(r.arrays.size());
+				t.arrayCount = uint32_t(st.array.size());
+				r.arrays.insert(r.arrays.end(), st.array.begin(), st.array.end());
+				if (st.basetype == SPIRType::Struct)
+					t.name = add_string(comp.get_name(st.self));
+
+				index = r.typeIndex[id] = uint32_t(r.types.size());
+				r.types.push_back(t);
+			}
+			else if (!layout || r.types[index].layout) {
+				return;
+			}
+
+			// arrays are reflected along with their element type
+			if (uint32_t(st.self) != id)
+				add_type(st.self, layout);
+			else if (layout && st.basetype == SPIRType::Struct)
+				add_layout(index, id);
+		}
+
+		//------------------------------------------------------------------------------------------
+		//-- add the members and size of a structure
+
+		void ReflectionBuilder::add_layout(uint32_t index, uint32_t id) {
+			auto &st = comp.get_type(id);
+			r.types[index].layout = true;
+			r.types[index].size = uint32_t(comp.get_declared_struct_size(st));
+
+			// the members are contiguous, so reflect the member types first
+			vector<ReflectMember> ms;
+			for (uint32_t i = 0; size_t(i) < st.member_types.size(); ++i) {
+				uint32_t t = st.member_types[i];
+				auto &mt = comp.get_type(t);
+				add_type(t, true);
+				ms.push_back(ReflectMember{ t, add_string(comp.get_member_name(id, i)),
+					comp.type_struct_member_offset(st, i),
+					mt.columns > 1 ? comp.type_struct_member_matrix_stride(st, i) : 0,
+					mt.array.empty() ? 0 : comp.type_struct_member_array_stride(st, i) });
+			}
+
+			r.types[index].memberIndex = uint32_t(r.members.size());
+			r.types[index].memberCount = uint32_t(ms.size());
+			r.members.insert(r.members.end(), ms.begin(), ms.end());
+		}
+
+		//------------------------------------------------------------------------------------------
+		//-- add one kind of resource
+
+		void ReflectionBuilder::add_resources(
+				const spirv_cross::SmallVector<spirv_cross::Resource> &res, ResourceKind kind,
+				bool layout) {
+			r.resourceIndex[size_t(kind)] = uint32_t(r.resourceList.size());
+			for (auto &v : res) {
+				add_type(v.type_id, false);
+				add_type(v.base_type_id, layout);
+				r.resourceList.push_back(ReflectResource{ v.id, v.type_id, v.base_type_id,
+					comp.get_decoration(v.id, spv::DecorationDescriptorSet),
+					comp.get_decoration(v.id, spv::DecorationBinding),
+					comp.get_decoration(v.id, spv::DecorationLocation),
+					add_string(v.name) });
+			}
+			r.resourceIndex[size_t(kind) + 1] = uint32_t(r.resourceList.size());
+		}
+
+		//------------------------------------------------------------------------------------------
+		//-- add a specialization constant
+
+		ReflectConstant ReflectionBuilder::add_constant(const spirv_cross::SpecializationConstant &c,
+				bool named) {
+			ReflectConstant k;
+			k.id = c.id;
+			k.constantId = c.constant_id;
+			if (k.id != 0) {
+				k.type = comp.get_constant(c.id).constant_type;
+				add_type(k.type, false);
+			}
+			if (named)
+				k.name = add_string(comp.get_name(c.id));
+			return k;
+		}
+
+	} // namespace
+
+
+	//------------------------------------------------------------------------------------------
+	//-- look up a reflected type
+
+	const ReflectType &Reflection::type(uint32_t id) const {
+		if (id >= typeIndex.size() || typeIndex[id] == noType)
+			throw std::runtime_error(fmt::format("internal error: type {} not reflected", id));
+		return types[typeIndex[id]];
+	}
+
+
+	//------------------------------------------------------------------------------------------
+	//-- the members of a structure with a layout
+
+	Span<ReflectMember> Reflection::struct_members(const ReflectType &t) const {
+		if (t.basetype != spirv_cross::SPIRType::Struct || !t.layout)
+			throw std::runtime_error("internal error: structure has no layout");
+		return Span<ReflectMember>{ members.data() + t.memberIndex, t.memberCount };
+	}
+
+
+	//------------------------------------------------------------------------------------------
+	//-- reflect a parsed module
+
+	std::unique_ptr<const Reflection> reflect_spirv(const spirv_cross::Compiler &comp) {
+		std::unique_ptr<Reflection> r(new Reflection);
+		ReflectionBuilder b{ comp, *r };
+
+		// string zero is the empty name
+		b.add_string(string());
+
+		auto ep = comp.get_entry_points_and_stages();
+		r->entryPoints = uint32_t(ep.size());
+		if (!ep.empty()) {
+			r->model = ep[0].execution_model;
+			r->entryPoint = ep[0].name;
+		}
+
+		spirv_cross::ShaderResources res = comp.get_shader_resources();
+		b.add_resources(res.uniform_buffers, ResourceKind::UniformBuffer, true);
+		b.add_resources(res.storage_buffers, ResourceKind::StorageBuffer, true);
+		b.add_resources(res.storage_images, ResourceKind::StorageImage, false);
+		b.add_resources(res.sampled_images, ResourceKind::SampledImage, false);
+		b.add_resources(res.separate_images, ResourceKind::SeparateImage, false);
+		b.add_resources(res.separate_samplers, ResourceKind::SeparateSampler, false);
+		b.add_resources(res.push_constant_buffers, ResourceKind::PushConstantBuffer, true);
+		b.add_resources(res.stage_inputs, ResourceKind::StageInput, false);
+		b.add_resources(res.stage_outputs, ResourceKind::StageOutput, false);
+
+		for (auto &c : comp.get_specialization_constants())
+			r->specs.push_back(b.add_constant(c, true));
+
+		spirv_cross::SpecializationConstant x, y, z;
+		comp.get_work_group_size_specialization_constants(x, y, z);
+		r->workgroup[0] = b.add_constant(x, false);
+		r->workgroup[1] = b.add_constant(y, false);
+		r->workgroup[2] = b.add_constant(z, false);
+
+		return std::move(r);
+	}
+
+
+	//------------------------------------------------------------------------------------------
+	//-- parse and reflect a module
+
+	std::unique_ptr<const Reflection> reflect_spirv(const SpirvWords &words) {
+		spirv_cross::Compiler comp(words.data(), words.size());
+		return reflect_spirv(comp);
+	}
+
+} // namespace autoshader
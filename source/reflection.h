@@ -0,0 +1,148 @@
+//
+//  File: reflection.h
+//
+//  Created by Jon Spencer on 2026-10-17 00:03:59
+//  Copyright (c) Jon Spencer. See LICENSE file.
+//
+#ifndef H_SOURCE_REFLECTION_H__
+#define H_SOURCE_REFLECTION_H__
+
+#include "autoshader.h"
+#include "spirvload.h"
+#include "spirv_cross.hpp"
+#include <memory>
+
+namespace autoshader {
+
+	//------------------------------------------------------------------------------------------
+	//-- Span: a view of part of one of the reflection arrays
+
+	template <typename T>
+	struct Span {
+		const T *first = nullptr;
+		size_t count = 0;
+
+		const T *begin() const { return first; }
+		const T *end() const { return first + count; }
+		size_t size() const { return count; }
+		bool empty() const { return count == 0; }
+		const T &operator [] (size_t i) const { return first[i]; }
+		const T &front() const { return first[0]; }
+		const T &back() const { return first[count - 1]; }
+	};
+
+	//------------------------------------------------------------------------------------------
+	//-- ReflectType: the parts of a spirv type the generator uses. the array sizes, members
+	//-- and name are indices into the arrays of the Reflection. only structures used by
+	//-- buffers have a layout (members and a declared size).
+
+	struct ReflectType {
+		spirv_cross::SPIRType::BaseType basetype = spirv_cross::SPIRType::Unknown;
+		uint32_t width = 0;
+		uint32_t vecsize = 1;
+		uint32_t columns = 1;
+		uint32_t self = 0;
+		spv::Dim imagedim = spv::Dim1D;
+		uint32_t imagesampled = 0;
+		uint32_t arrayIndex = 0, arrayCount = 0;
+		uint32_t name = 0;
+		bool layout = false;
+		uint32_t size = 0;
+		uint32_t memberIndex = 0, memberCount = 0;
+	};
+
+	//------------------------------------------------------------------------------------------
+	//-- ReflectMember: a member of a structure with a layout. the strides are only set for
+	//-- matrix and array members.
+
+	struct ReflectMember {
+		uint32_t type;
+		uint32_t name;
+		uint32_t offset;
+		uint32_t matrixStride;
+		uint32_t arrayStride;
+	};
+
+	//------------------------------------------------------------------------------------------
+	//-- ResourceKind: the resource lists of the shader, in the order they're stored
+
+	enum struct ResourceKind {
+		UniformBuffer,
+		StorageBuffer,
+		StorageImage,
+		SampledImage,
+		SeparateImage,
+		SeparateSampler,
+		PushConstantBuffer,
+		StageInput,
+		StageOutput,
+		Count,
+	};
+
+	//------------------------------------------------------------------------------------------
+	//-- ReflectResource: a shader resource with its decorations
+
+	struct ReflectResource {
+		uint32_t id;
+		uint32_t type;
+		uint32_t baseType;
+		uint32_t set;
+		uint32_t binding;
+		uint32_t location;
+		uint32_t name;
+	};
+
+	//------------------------------------------------------------------------------------------
+	//-- ReflectConstant: a specialization constant
+
+	struct ReflectConstant {
+		uint32_t id = 0;
+		uint32_t constantId = 0;
+		uint32_t type = 0;
+		uint32_t name = 0;
+	};
+
+	//------------------------------------------------------------------------------------------
+	//-- Reflection: everything the generator needs from a shader, gathered in one pass so the
+	//-- emitters don't go back to the compiler. types are indexed by spirv id.
+
+	struct Reflection {
+		static constexpr uint32_t noType = ~0u;
+
+		uint32_t entryPoints = 0;
+		spv::ExecutionModel model = spv::ExecutionModelMax;
+		string entryPoint;
+
+		vector<uint32_t> typeIndex;
+		vector<ReflectType> types;
+		vector<ReflectMember> members;
+		vector<uint32_t> arrays;
+		vector<string> strings;
+		vector<ReflectResource> resourceList;
+		uint32_t resourceIndex[size_t(ResourceKind::Count) + 1] = {};
+		vector<ReflectConstant> specs;
+		ReflectConstant workgroup[3];
+
+		const ReflectType &type(uint32_t id) const;
+		const string &string_at(uint32_t i) const { return strings[i]; }
+		const string &name(const ReflectType &t) const { return strings[t.name]; }
+
+		Span<uint32_t> array(const ReflectType &t) const {
+			return Span<uint32_t>{ arrays.data() + t.arrayIndex, t.arrayCount }; }
+		Span<ReflectMember> struct_members(const ReflectType &t) const;
+		Span<ReflectResource> resources(ResourceKind k) const {
+			return Span<ReflectResource>{ resourceList.data() + resourceIndex[size_t(k)],
+				resourceIndex[size_t(k) + 1] - resourceIndex[size_t(k)] }; }
+	};
+
+	//------------------------------------------------------------------------------------------
+	//-- parse a spirv module and reflect it
+	std::unique_ptr<const Reflection> reflect_spirv(const SpirvWords &words);
+
+	//------------------------------------------------------------------------------------------
+	//-- reflect a parsed module
+	std::unique_ptr<const Reflection> reflect_spirv(const spirv_cross::Compiler &comp);
+
+} // namespace autoshader
+
+#endif // H_SOURCE_REFLECTION_H__
@@ -0,0 +1,397 @@
+//
+//  File: reflectoutput.cpp
+//
+//  Created by Jon Spencer on 2026-10-17 00:08:55
+//  Copyright (c) Jon Spencer. See LICENSE file.
+//
+
+#include "reflectoutput.h"
+#include "pushranges.h"
+#include "specializer.h"
+#include "vertexinput.h"
+#include <cstring>
+
+namespace autoshader {
+
+	namespace {
+
+		//------------------------------------------------------------------------------------------
+		//-- the vulkan stage bit for an execution model
+
+		uint32_t stage_bit(spv::ExecutionModel e) {
+			switch (e) {
+				case spv::ExecutionModelVertex: return 0x01;
+				case spv::ExecutionModelTessellationControl: return 0x02;
+				case spv::ExecutionModelTessellationEvaluation: return 0x04;
+				case spv::ExecutionModelGeometry: return 0x08;
+				case spv::ExecutionModelFragment: return 0x10;
+				case spv::ExecutionModelGLCompute: return 0x20;
+				default: break;
+			}
+			throw std::runtime_error("unsupported execution model for shader");
+		}
+
+		uint32_t stage_bits(const std::set<spv::ExecutionModel> &stages) {
+			uint32_t r = 0;
+			for (auto e : stages)
+				r |= stage_bit(e);
+			return r;
+		}
+
+		const char *stageNames[] = { "vert", "tesc", "tese", "geom", "frag", "comp" };
+
+		//------------------------------------------------------------------------------------------
+		//-- the VkDescriptorType value and name for a descriptor
+
+		uint32_t descriptor_value(DescriptorType type) {
+			switch (type) {
+				case DescriptorType::Sampler: return 0;
+				case DescriptorType::ImageSampler: return 1;
+				case DescriptorType::SampledImage: return 2;
+				case DescriptorType::StorageImage: return 3;
+				case DescriptorType::Uniform: return 6;
+				case DescriptorType::StorageBuffer: return 7;
+			}
+			throw std::runtime_error("internal error: invalid descriptor type");
+		}
+
+		const char *descriptor_name(uint32_t value) {
+			switch (value) {
+				case 0: return "sampler";
+				case 1: return "combinedImageSampler";
+				case 2: return "sampledImage";
+				case 3: return "storageImage";
+				case 6: return "uniformBuffer";
+				case 7: return "storageBuffer";
+				default: break;
+			}
+			throw std::runtime_error("internal error: invalid descriptor type");
+		}
+
+		//------------------------------------------------------------------------------------------
+		//-- the VkFormat value for a vertex attribute type, as the generated vertex input has
+
+		uint32_t vertex_format(const ReflectType &type) {
+			auto c = vertex_component(type);
+			if (type.columns != 1)
+				throw std::runtime_error("invalid type for vertex format");
+			return layoutrules::vertexFormat(c, type.width, type.vecsize);
+		}
+
+		string vertex_format_name(uint32_t format) {
+			auto bits = format >= 110 ? 64 : 32;
+			auto k = format - (bits == 64 ? 110 : 98);
+			static const char *components[4] = { "R", "G", "B", "A" };
+			static const char *ext[3] = { "UINT", "SINT", "SFLOAT" };
+			string r;
+			for (uint32_t i = 0; i <= k / 3; ++i)
+				r += fmt::format("{}{}", components[i], bits);
+			return r + "_" + ext[k % 3];
+		}
+
+		//------------------------------------------------------------------------------------------
+		//-- quote a string for json
+
+		string json_string(const char *s) {
+			string r = "\"";
+			for (; *s != 0; ++s) {
+				auto c = *s;
+				if (c == '"' || c == '\\')
+					r += fmt::format("\\{}", c);
+				else if (uint8_t(c) < 0x20)
+					r += fmt::format("\\u{:04x}", unsigned(c));
+				else
+					r += c;
+			}
+			return r + "\"";
+		}
+
+		//------------------------------------------------------------------------------------------
+		//-- format the names of the stages in a set of stage flags
+
+		void json_stages(fmt::memory_buffer &r, uint32_t flags) {
+			format_to(std::back_inserter(r), "[");
+			bool c = false;
+			for (uint32_t i = 0; i < 6; ++i) {
+				if ((flags & (1u << i)) == 0)
+					continue;
+				format_to(std::back_inserter(r), "{}\"{}\"", c ? ", " : "", stageNames[i]);
+				c = true;
+			}
+			format_to(std::back_inserter(r), "]");
+		}
+
+		const char *stage_name(uint32_t bit) {
+			for (uint32_t i = 0; i < 6; ++i) {
+				if (bit == 1u << i)
+					return stageNames[i];
+			}
+			throw std::runtime_error("internal error: invalid stage");
+		}
+
+		//------------------------------------------------------------------------------------------
+		//-- add the structures of a shader, the members refer to structures by name until all
+		//-- the structures are known
+
+		void add_structs(ReflectTables &t, ShaderRecord &sh, vector<string> &memberStructs) {
+			using spirv_cross::SPIRType;
+			auto &ir = *sh.reflection;
+			for (auto s : sh.structs) {
+				auto &type = ir.type(s);
+				auto members = ir.struct_members(type);
+				t.structs.push_back(reflectformat::Struct{ t.add_string(sh.names.at(s)), type.size,
+					uint32_t(t.members.size()), uint32_t(members.size()) });
+
+				for (auto &m : members) {
+					auto &mtype = ir.type(m.type);
+					auto &etype = ir.type(mtype.self);
+					auto array = ir.array(mtype);
+
+					uint32_t size;
+					if (etype.basetype == SPIRType::Struct)
+						size = etype.size;
+					else if (etype.columns > 1)
+						size = etype.columns * m.matrixStride;
+					else
+						size = etype.width / 8 * etype.vecsize;
+
+					memberStructs.push_back(etype.basetype == SPIRType::Struct ?
+						sh.names.at(etype.self) : string());
+					t.members.push_back(reflectformat::Member{ t.add_string(ir.string_at(m.name)),
+						t.add_string(type_string_mapped(sh, etype)), reflectformat::noIndex, m.offset,
+						size, m.matrixStride, m.arrayStride, uint32_t(t.dimensions.size()),
+						uint32_t(array.size()) });
+
+					// outermost dimension first, as they're declared in c
+					for (size_t i = array.size(); i-- != 0;)
+						t.dimensions.push_back(array[i]);
+				}
+			}
+		}
+
+		//------------------------------------------------------------------------------------------
+		//-- add the vertex attributes, laid out as the generated vertex structure with tightly
+		//-- packed vector types
+
+		void add_attributes(ReflectTables &t, const Reflection &ir, const string &name) {
+			auto inputs = ir.resources(ResourceKind::StageInput);
+			if (inputs.empty())
+				return;
+
+			t.attributes.clear();
+			layoutrules::VertexPacker packer;
+			for (auto &v : inputs) {
+				auto &type = ir.type(v.baseType);
+				auto format = vertex_format(type);
+				uint32_t count = 1;
+				for (auto d : ir.array(ir.type(v.type)))
+					count *= d;
+				auto offset = packer.add(type.width, type.vecsize, count);
+				t.attributes.push_back(reflectformat::Attribute{ v.location, format, offset,
+					packer.offset - offset, t.add_string(type_string(ir, type)),
+					t.add_string(ir.string_at(v.name)) });
+			}
+
+			t.header.vertexName = t.add_string(name);
+			t.header.vertexStride = packer.stride();
+		}
+
+		template <typename T>
+		void append_table(string &r, reflectformat::Section &s, const vector<T> &v) {
+			s.offset = uint32_t(r.size());
+			s.count = uint32_t(v.size());
+			r.append(reinterpret_cast<const char*>(v.data()), v.size() * sizeof(T));
+		}
+
+	} // namespace
+
+
+	//------------------------------------------------------------------------------------------
+	//-- add a string to the table once
+
+	uint32_t ReflectTables::add_string(const string &s) {
+		if (strings.empty())
+			strings.push_back(0);
+		if (s.empty())
+			return 0;
+		auto i = stringIndex.emplace(s, uint32_t(strings.size()));
+		if (i.second) {
+			strings += s;
+			strings.push_back(0);
+		}
+		return i.first->second;
+	}
+
+
+	//------------------------------------------------------------------------------------------
+	//-- gather the reflection of the pipeline, after the structure names are mapped
+
+	ReflectTables reflect_tables(vector<ShaderRecord> &sh,
+			const std::map<uint32_t, DescriptorSet> &sets, const string &vertex, bool noVertex) {
+		ReflectTables t;
+		t.add_string(string());
+
+		vector<string> memberStructs;
+		for (auto &s : sh) {
+			auto &ir = *s.reflection;
+			auto bit = stage_bit(get_execution_model(ir));
+			t.header.stageFlags |= bit;
+			t.stages.push_back(reflectformat::Stage{ bit, t.add_string(get_first_entry_point_name(ir)) });
+
+			add_structs(t, s, memberStructs);
+
+			for (auto &c : get_specializations(ir)) {
+				t.specConstants.push_back(reflectformat::SpecConstant{ bit, c.first,
+					t.add_string(type_string(ir, ir.type(c.second.type))), t.add_string(c.second.name) });
+			}
+
+			if (!noVertex && ir.model == spv::ExecutionModelVertex)
+				add_attributes(t, ir, vertex);
+		}
+
+		// the structure names are unique once they're mapped
+		std::map<string, uint32_t> structIndex;
+		for (uint32_t i = 0; size_t(i) < t.structs.size(); ++i)
+			structIndex.emplace(t.string_at(t.structs[i].name), i);
+		for (size_t i = 0; i < t.members.size(); ++i) {
+			if (memberStructs[i].empty())
+				continue;
+			auto s = structIndex.find(memberStructs[i]);
+			if (s == structIndex.end())
+				throw std::runtime_error("internal error: member of an unknown structure type");
+			t.members[i].structIndex = s->second;
+		}
+
+		for (auto &s : sets) {
+			for (auto &d : s.second.descriptors) {
+				t.descriptors.push_back(reflectformat::Descriptor{ s.first, d.first,
+					descriptor_value(d.second.type), uint32_t(d.second.arraysize),
+					stage_bits(d.second.stages), uint32_t(d.second.imagedim),
+					t.add_string(d.second.name) });
+			}
+		}
+
+		for (auto &p : get_push_ranges(sh)) {
+			t.pushRanges.push_back(reflectformat::PushRange{ stage_bits(p.stages), p.start,
+				p.end - p.start });
+		}
+
+		return t;
+	}
+
+
+	//------------------------------------------------------------------------------------------
+	//-- the reflection in the binary format
+
+	string reflect_binary(const ReflectTables &t) {
+		auto h = t.header;
+		h.magic = reflectformat::magic;
+		h.version = reflectformat::version;
+
+		string r(sizeof(h), 0);
+		append_table(r, h.stages, t.stages);
+		append_table(r, h.structs, t.structs);
+		append_table(r, h.members, t.members);
+		append_table(r, h.dimensions, t.dimensions);
+		append_table(r, h.descriptors, t.descriptors);
+		append_table(r, h.pushRanges, t.pushRanges);
+		append_table(r, h.attributes, t.attributes);
+		append_table(r, h.specConstants, t.specConstants);
+		h.strings.offset = uint32_t(r.size());
+		h.strings.count = uint32_t(t.strings.size());
+		r += t.strings;
+
+		// keep the size a whole number of words
+		r.resize((r.size() + 3) / 4 * 4, 0);
+		h.size = uint32_t(r.size());
+		memcpy(&r[0], &h, sizeof(h));
+		return r;
+	}
+
+
+	//------------------------------------------------------------------------------------------
+	//-- format the reflection as json
+
+	void reflect_json(fmt::memory_buffer &r, const string &prog, const ReflectTables &t) {
+		auto out = std::back_inserter(r);
+		auto str = [&t] (uint32_t i) { return json_string(t.string_at(i)); };
+
+		format_to(out, "{{\n  \"generator\": {},\n  \"version\": {},\n", json_string(prog.c_str()),
+			reflectformat::version);
+
+		format_to(out, "  \"stages\": [");
+		for (size_t i = 0; i < t.stages.size(); ++i) {
+			auto &s = t.stages[i];
+			format_to(out, "{}\n    {{ \"stage\": \"{}\", \"entryPoint\": {} }}", i ? "," : "",
+				stage_name(s.stage), str(s.entryPoint));
+		}
+		format_to(out, "{}],\n", t.stages.empty() ? "" : "\n  ");
+
+		format_to(out, "  \"structs\": [");
+		for (size_t i = 0; i < t.structs.size(); ++i) {
+			auto &s = t.structs[i];
+			format_to(out, "{}\n    {{\n      \"name\": {},\n      \"size\": {},\n      \"members\": [",
+				i ? "," : "", str(s.name), s.size);
+			for (uint32_t j = 0; j < s.memberCount; ++j) {
+				auto &m = t.members[s.firstMember + j];
+				format_to(out, "{}\n        {{ \"name\": {}, \"type\": {}, \"offset\": {}, \"size\": {}",
+					j ? "," : "", str(m.name), str(m.type), m.offset, m.size);
+				if (m.matrixStride != 0)
+					format_to(out, ", \"matrixStride\": {}", m.matrixStride);
+				if (m.dimensionCount != 0) {
+					format_to(out, ", \"arrayStride\": {}, \"array\": [", m.arrayStride);
+					for (uint32_t k = 0; k < m.dimensionCount; ++k)
+						format_to(out, "{}{}", k ? ", " : "", t.dimensions[m.firstDimension + k]);
+					format_to(out, "]");
+				}
+				format_to(out, " }}");
+			}
+			format_to(out, "{}]\n    }}", s.memberCount ? "\n      " : "");
+		}
+		format_to(out, "{}],\n", t.structs.empty() ? "" : "\n  ");
+
+		format_to(out, "  \"descriptors\": [");
+		for (size_t i = 0; i < t.descriptors.size(); ++i) {
+			auto &d = t.descriptors[i];
+			format_to(out, "{}\n    {{ \"set\": {}, \"binding\": {}, \"name\": {}, \"type\": \"{}\", "
+				"\"count\": {}, \"stages\": ", i ? "," : "", d.set, d.binding, str(d.name),
+				descriptor_name(d.descriptorType), d.count);
+			json_stages(r, d.stageFlags);
+			format_to(out, " }}");
+		}
+		format_to(out, "{}],\n", t.descriptors.empty() ? "" : "\n  ");
+
+		format_to(out, "  \"pushConstantRanges\": [");
+		for (size_t i = 0; i < t.pushRanges.size(); ++i) {
+			auto &p = t.pushRanges[i];
+			format_to(out, "{}\n    {{ \"stages\": ", i ? "," : "");
+			json_stages(r, p.stageFlags);
+			format_to(out, ", \"offset\": {}, \"size\": {} }}", p.offset, p.size);
+		}
+		format_to(out, "{}],\n", t.pushRanges.empty() ? "" : "\n  ");
+
+		if (t.attributes.empty()) {
+			format_to(out, "  \"vertex\": null,\n");
+		}
+		else {
+			format_to(out, "  \"vertex\": {{\n    \"name\": {},\n    \"stride\": {},\n    \"attributes\": [",
+				str(t.header.vertexName), t.header.vertexStride);
+			for (size_t i = 0; i < t.attributes.size(); ++i) {
+				auto &a = t.attributes[i];
+				format_to(out, "{}\n      {{ \"location\": {}, \"name\": {}, \"type\": {}, \"format\": \"{}\", "
+					"\"offset\": {}, \"size\": {} }}", i ? "," : "", a.location, str(a.name), str(a.type),
+					vertex_format_name(a.format), a.offset, a.size);
+			}
+			format_to(out, "\n    ]\n  }},\n");
+		}
+
+		format_to(out, "  \"specConstants\": [");
+		for (size_t i = 0; i < t.specConstants.size(); ++i) {
+			auto &c = t.specConstants[i];
+			format_to(out, "{}\n    {{ \"stage\": \"{}\", \"constantId\": {}, \"name\": {}, \"type\": {} }}",
+				i ? "," : "", stage_name(c.stage), c.constantId, str(c.name), str(c.type));
+		}
+		format_to(out, "{}]\n}}\n", t.specConstants.empty() ? "" : "\n  ");
+	}
+
+} // namespace autoshader
@@ -0,0 +1,52 @@
+//
+//  File: reflectoutput.h
+//
+//  Created by Jon Spencer on 2026-10-17 00:08:55
+//  Copyright (c) Jon Spencer. See LICENSE file.
+//
+#ifndef H_SOURCE_REFLECTOUTPUT_H__
+#define H_SOURCE_REFLECTOUTPUT_H__
+
+#include "typereflect.h"
+#include "descriptorset.h"
+#include "autoshader/reflectformat.h"
+
+namespace autoshader {
+
+	//------------------------------------------------------------------------------------------
+	//-- ReflectTables: the records of the binary reflection format. they are built once and
+	//-- written either as the binary file or as json.
+
+	struct ReflectTables {
+		reflectformat::Header header = {};
+		vector<reflectformat::Stage> stages;
+		vector<reflectformat::Struct> structs;
+		vector<reflectformat::Member> members;
+		vector<uint32_t> dimensions;
+		vector<reflectformat::Descriptor> descriptors;
+		vector<reflectformat::PushRange> pushRanges;
+		vector<reflectformat::Attribute> attributes;
+		vector<reflectformat::SpecConstant> specConstants;
+		string strings;
+		std::map<string, uint32_t> stringIndex;
+
+		uint32_t add_string(const string &s);
+		const char *string_at(uint32_t i) const { return strings.data() + i; }
+	};
+
+	//------------------------------------------------------------------------------------------
+	//-- gather the reflection of the pipeline, after the structure names are mapped
+	ReflectTables reflect_tables(vector<ShaderRecord> &sh,
+		const std::map<uint32_t, DescriptorSet> &sets, const string &vertex, bool noVertex);
+
+	//------------------------------------------------------------------------------------------
+	//-- the reflection in the binary format
+	string reflect_binary(const ReflectTables &t);
+
+	//------------------------------------------------------------------------------------------
+	//-- format the reflection as json
+	void reflect_json(fmt::memory_buffer &r, const string &prog, const ReflectTables &t);
+
+} // namespace autoshader
+
+#endif // H_SOURCE_REFLECTOUTPUT_H__
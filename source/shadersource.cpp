@@ -7,17 +7,88 @@
 
 #include "shadersource.h"
 #include "descriptorset.h"
+#include "hash.h"
+#include "spirvpack.h"
 
 namespace autoshader {
 
+	namespace {
+
+		//------------------------------------------------------------------------------------------
+		//-- the itanium c++ abi name for a variable in the namespaces
+
+		string mangled_name(const vector<string> &namespaces, const string &name) {
+			vector<string> parts;
+			for (auto &n : namespaces) {
+				for (size_t b = 0;;) {
+					auto e = n.find("::", b);
+					parts.push_back(n.substr(b, e - b));
+					if (e == string::npos)
+						break;
+					b = e + 2;
+				}
+			}
+			if (parts.empty())
+				return name;
+
+			fmt::memory_buffer r;
+			format_to(std::back_inserter(r), "_ZN");
+			for (auto &p : parts)
+				format_to(std::back_inserter(r), "{}{}", p.size(), p);
+			format_to(std::back_inserter(r), "{}{}E", name.size(), name);
+			return to_string(r);
+		}
+
+		//------------------------------------------------------------------------------------------
+		//-- quote a path for an assembler string
+
+		string asm_string(const string &s) {
+			string r = "\"";
+			for (auto c : s) {
+				if (c == '"' || c == '\\')
+					r += '\\';
+				r += c;
+			}
+			return r + "\"";
+		}
+
+		auto incbinPrefix =
+R"(/* generated with {0} */
+/* content {1} */
+
+#if defined(__APPLE__)
+#define AUTOSHADER_SYMBOL(s) _##s
+	.const
+#else
+#define AUTOSHADER_SYMBOL(s) s
+	.section .rodata
+#endif
+
+)";
+
+		auto incbinSymbol =
+R"(	.globl AUTOSHADER_SYMBOL({0})
+	.p2align 2
+AUTOSHADER_SYMBOL({0}):
+	{1}
+)";
+
+		auto incbinSuffix =
+R"(#if defined(__ELF__)
+	.section .note.GNU-stack,"",%progbits
+#endif
+)";
+
+	} // namespace
+
+
 	//------------------------------------------------------------------------------------------
 	//-- return the postifix based on the shader stage
 
-	string get_execution_string(spirv_cross::Compiler &comp) {
-		auto ep = comp.get_entry_points_and_stages();
-		if (ep.empty())
+	string get_execution_string(const Reflection &ir) {
+		if (ir.entryPoints == 0)
 			throw std::runtime_error("shader stages has no entry point");
-		switch (ep[0].execution_model) {
+		switch (ir.model) {
 			case spv::ExecutionModelVertex: return "vert";
 			case spv::ExecutionModelTessellationControl: return "tesc";
 			case spv::ExecutionModelTessellationEvaluation: return "tese";
@@ -31,43 +102,139 @@ namespace autoshader {
 	}
 
 
+	//------------------------------------------------------------------------------------------
+	//-- prepare the data emitted for a reflected stage
+
+	StageData stage_data(ShaderRecord &s, bool strip, bool compress) {
+		StageData r;
+		r.stage = get_execution_string(*s.reflection);
+		r.words = s.source.data();
+		r.count = s.source.size();
+		if (strip) {
+			r.stripped = strip_spirv(r.words, r.count);
+			r.words = r.stripped.data();
+			r.count = r.stripped.size();
+		}
+		if (compress) {
+			r.compressed = true;
+			r.packed = pack_spirv(r.words, r.count);
+		}
+		return r;
+	}
+
+
 	//------------------------------------------------------------------------------------------
 	//-- declare the storage for the shader source
 
-	void shader_source_decl(fmt::memory_buffer &r, vector<ShaderRecord> &sh, const string& indent) {
-		for (auto &s : sh) {
-			auto p = get_execution_string(*s.comp);
-			format_to(std::back_inserter(r), "{}extern const uint32_t {}_size;\n", indent, p);
-			format_to(std::back_inserter(r), "{}extern const uint32_t {}_data[];\n", indent, p);
+	void shader_source_decl(fmt::memory_buffer &r, const vector<StageData> &data,
+			const string& indent) {
+		for (auto &d : data) {
+			format_to(std::back_inserter(r), "{}extern const uint32_t {}_size;\n", indent, d.stage);
+			if (d.compressed) {
+				format_to(std::back_inserter(r), "{}extern const uint32_t {}_packed_size;\n", indent, d.stage);
+				format_to(std::back_inserter(r), "{}extern const uint8_t {}_packed[];\n", indent, d.stage);
+			}
+			else {
+				format_to(std::back_inserter(r), "{}extern const uint32_t {}_data[];\n", indent, d.stage);
+			}
 		}
 		format_to(std::back_inserter(r), "\n");
 	}
 
 
 	//------------------------------------------------------------------------------------------
-	//-- format the shader source into the buffer
+	//-- open the shader source section
 
-	void shader_source(fmt::memory_buffer &r, vector<ShaderRecord> &sh, const string& indent,
-			bool ifdef) {
+	void shader_source_begin(fmt::memory_buffer &r, bool ifdef) {
 		if (ifdef)
 			format_to(std::back_inserter(r), "#ifdef AUTOSHADER_SOURCE_DATA\n\n");
-		for (auto &s : sh) {
-			auto p = get_execution_string(*s.comp);
-			format_to(std::back_inserter(r), "{}extern const uint32_t {}_size = {};\n", indent, p,
-				sizeof(uint32_t) * s.source.size());
-			format_to(std::back_inserter(r), "{}extern const uint32_t {}_data[] = {{\n", indent, p);
-			for (size_t i = 0; i < s.source.size();) {
+	}
+
+
+	//------------------------------------------------------------------------------------------
+	//-- format the source for a single shader stage into the buffer
+
+	void stage_source(fmt::memory_buffer &r, const StageData &d, const string& indent) {
+		auto &p = d.stage;
+		format_to(std::back_inserter(r), "{}extern const uint32_t {}_size = {};\n", indent, p, d.size());
+		if (d.compressed) {
+			auto b = reinterpret_cast<const uint8_t*>(d.packed.data());
+			format_to(std::back_inserter(r), "{}extern const uint32_t {}_packed_size = {};\n", indent, p,
+				d.packed.size());
+			format_to(std::back_inserter(r), "{}extern const uint8_t {}_packed[] = {{\n", indent, p);
+			for (size_t i = 0; i < d.packed.size();) {
 				format_to(std::back_inserter(r), "{}  ", indent);
-				for (size_t j = 0; i < s.source.size() && j < 8; ++j, ++i) {
-					format_to(std::back_inserter(r), "0x{:08x}{}", s.source[i], i == s.source.size() - 1 ? "" : ",");
+				for (size_t j = 0; i < d.packed.size() && j < 16; ++j, ++i) {
+					format_to(std::back_inserter(r), "0x{:02x}{}", b[i], i == d.packed.size() - 1 ? "" : ",");
 				}
 				format_to(std::back_inserter(r), "\n");
 			}
 			format_to(std::back_inserter(r), "{}}};\n", indent);
+			return;
+		}
+
+		format_to(std::back_inserter(r), "{}extern const uint32_t {}_data[] = {{\n", indent, p);
+		for (size_t i = 0; i < d.count;) {
+			format_to(std::back_inserter(r), "{}  ", indent);
+			for (size_t j = 0; i < d.count && j < 8; ++j, ++i) {
+				format_to(std::back_inserter(r), "0x{:08x}{}", d.words[i], i == d.count - 1 ? "" : ",");
+			}
+			format_to(std::back_inserter(r), "\n");
 		}
+		format_to(std::back_inserter(r), "{}}};\n", indent);
+	}
+
+
+	//------------------------------------------------------------------------------------------
+	//-- close the shader source section
+
+	void shader_source_end(fmt::memory_buffer &r, bool ifdef) {
 		if (ifdef)
 			format_to(std::back_inserter(r), "\n#endif // AUTOSHADER_SOURCE_DATA\n");
 		format_to(std::back_inserter(r), "\n");
 	}
 
+
+	//------------------------------------------------------------------------------------------
+	//-- return the raw bytes of a stage for the binary data formats
+
+	string stage_binary(const StageData &d) {
+		if (d.compressed)
+			return d.packed;
+		return string(reinterpret_cast<const char*>(d.words), d.size());
+	}
+
+
+	//------------------------------------------------------------------------------------------
+	//-- format an assembler file defining the shader data from the stage binaries
+
+	void incbin_source(fmt::memory_buffer &r, const string &prog, const vector<StageData> &data,
+			const vector<string> &namespaces, const vector<string> &binaries) {
+
+		// the assembler can't see into the binaries, so make sure the file changes with them
+		Hasher h;
+		for (auto &d : data) {
+			auto b = stage_binary(d);
+			h.add(b);
+		}
+		format_to(std::back_inserter(r), incbinPrefix, prog, h.result().hex());
+
+		for (size_t i = 0; i < data.size(); ++i) {
+			auto &d = data[i];
+			format_to(std::back_inserter(r), incbinSymbol, mangled_name(namespaces, d.stage + "_size"),
+				fmt::format(".long {}", d.size()));
+			if (d.compressed) {
+				format_to(std::back_inserter(r), incbinSymbol,
+					mangled_name(namespaces, d.stage + "_packed_size"),
+					fmt::format(".long {}", d.packed.size()));
+			}
+			format_to(std::back_inserter(r), incbinSymbol,
+				mangled_name(namespaces, d.stage + (d.compressed ? "_packed" : "_data")),
+				fmt::format(".incbin {}", asm_string(binaries[i])));
+			format_to(std::back_inserter(r), "\n");
+		}
+
+		format_to(std::back_inserter(r), incbinSuffix);
+	}
+
 } // namespace autoshader
@@ -14,16 +14,51 @@ namespace autoshader {
 	//------------------------------------------------------------------------------------------
 	//-- return the name based on the shader stage
 
-	string get_execution_string(spirv_cross::Compiler &comp);
+	string get_execution_string(const Reflection &ir);
+
+	//------------------------------------------------------------------------------------------
+	//-- StageData: the shader data emitted for a stage - the words, optionally stripped, and
+	//-- the packed bytes when compressing
+
+	struct StageData {
+		string stage;
+		const uint32_t *words = nullptr;
+		size_t count = 0;
+		vector<uint32_t> stripped;
+		bool compressed = false;
+		string packed;
+
+		size_t size() const { return sizeof(uint32_t) * count; }
+		size_t emitted_size() const { return compressed ? packed.size() : size(); }
+	};
+
+	//------------------------------------------------------------------------------------------
+	//-- prepare the data emitted for a reflected stage
+	StageData stage_data(ShaderRecord &s, bool strip, bool compress);
 
 	//------------------------------------------------------------------------------------------
 	//-- declare the storage for the shader source
-	void shader_source_decl(fmt::memory_buffer &r, vector<ShaderRecord> &sh, const string& indent);
+	void shader_source_decl(fmt::memory_buffer &r, const vector<StageData> &data,
+		const string& indent);
+
+	//------------------------------------------------------------------------------------------
+	//-- open and close the shader source section around the stage sources
+	void shader_source_begin(fmt::memory_buffer &r, bool ifdef);
+	void shader_source_end(fmt::memory_buffer &r, bool ifdef);
+
+	//------------------------------------------------------------------------------------------
+	//-- format the source for a single shader stage into the buffer
+	void stage_source(fmt::memory_buffer &r, const StageData &d, const string& indent);
+
+	//------------------------------------------------------------------------------------------
+	//-- return the raw bytes of a stage for the binary data formats
+	string stage_binary(const StageData &d);
 
 	//------------------------------------------------------------------------------------------
-	//-- format the shader source into the buffer
-	void shader_source(fmt::memory_buffer &r, vector<ShaderRecord> &sh, const string& indent,
-		bool ifdef);
+	//-- format an assembler file defining the shader data by including the stage binaries. the
+	//-- symbols are mangled (itanium abi) for the namespaces.
+	void incbin_source(fmt::memory_buffer &r, const string &prog, const vector<StageData> &data,
+		const vector<string> &namespaces, const vector<string> &binaries);
 
 } // namespace autoshader
 
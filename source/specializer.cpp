@@ -57,65 +57,67 @@ R"(
 			return s;
 		}
 
-		void specializer_value(fmt::memory_buffer &r, spirv_cross::Compiler &comp,
-				const string &indent, size_t count, uint32_t id, const string &name,
+		void specializer_value(fmt::memory_buffer &r, const Reflection &ir,
+				const string &indent, size_t count, uint32_t typeID, const string &name,
 				uint32_t constantID, const string &specname) {
 
-			auto type = comp.get_type(comp.get_constant(id).constant_type);
+			auto &type = ir.type(typeID);
 			if (type.basetype == spirv_cross::SPIRType::Float) {
-				format_to(std::back_inserter(r), floatSrc, indent, name, count, type_string(comp, type),
+				format_to(std::back_inserter(r), floatSrc, indent, name, count, type_string(ir, type),
 					constantID, specname);
 			}
 			else {
-				format_to(std::back_inserter(r), intSrc, indent, name, count, type_string(comp, type),
+				format_to(std::back_inserter(r), intSrc, indent, name, count, type_string(ir, type),
 					constantID, specname);
 			}
 		}
 
-		void shader_specializer(fmt::memory_buffer &r, spirv_cross::Compiler &comp, string pre,
+		void shader_specializer(fmt::memory_buffer &r, const Reflection &ir, string pre,
 				const string &indent) {
 
-			struct SpecToWrite {
-				uint32_t id;
-				string name;
-			};
-
-			// grab all the names specialization constants
-			std::map<uint32_t, SpecToWrite> specs;
-			auto consts = comp.get_specialization_constants();
-			for (auto &c : consts) {
-				auto n = comp.get_name(c.id);
-				if (n.empty())
-					continue;
-				specs.emplace(c.constant_id, SpecToWrite{ c.id, move(n) });
-			}
-
-			// group the workgroup size constants
-			spirv_cross::SpecializationConstant x, y, z;
-			comp.get_work_group_size_specialization_constants(x, y, z);
-			if (uint32_t(x.id) != 0 || x.constant_id != 0)
-				specs.emplace(x.constant_id, SpecToWrite{ x.id, "WorkGroupSizeX" });
-			if (uint32_t(y.id) != 0 || y.constant_id != 0)
-				specs.emplace(y.constant_id, SpecToWrite{ y.id, "WorkGroupSizeY" });
-			if (uint32_t(z.id) != 0 || z.constant_id != 0)
-				specs.emplace(z.constant_id, SpecToWrite{ z.id, "WorkGroupSizeZ" });
+			auto specs = get_specializations(ir);
 
 			// common case - no specialization constant
 			if (specs.empty())
 				return;
 
 			format_to(std::back_inserter(r), writerSrc, indent, capitalize(pre), specs.size(),
-				get_shader_stage_flags(comp));
+				get_shader_stage_flags(ir));
 
 			for (auto &t : specs) {
-				specializer_value(r, comp, indent, specs.size(),
-					t.second.id, t.second.name, t.first, capitalize(pre));
+				specializer_value(r, ir, indent, specs.size(),
+					t.second.type, t.second.name, t.first, capitalize(pre));
 			}
 
 			format_to(std::back_inserter(r), "{0}}};\n\n", indent);
 		}
 	}
 
+	//-------------------------------------------------------------------------------------------
+	//-- the named specialization constants and the workgroup size constants, by constant id
+
+	std::map<uint32_t, Specialization> get_specializations(const Reflection &ir) {
+		// grab all the names specialization constants
+		std::map<uint32_t, Specialization> specs;
+		for (auto &c : ir.specs) {
+			auto &n = ir.string_at(c.name);
+			if (n.empty())
+				continue;
+			specs.emplace(c.constantId, Specialization{ c.type, n });
+		}
+
+		// group the workgroup size constants
+		static const char *workgroup[3] = { "WorkGroupSizeX", "WorkGroupSizeY", "WorkGroupSizeZ" };
+		for (size_t i = 0; i < 3; ++i) {
+			auto &c = ir.workgroup[i];
+			if (c.id != 0 || c.constantId != 0)
+				specs.emplace(c.constantId, Specialization{ c.type, workgroup[i] });
+		}
+
+		return specs;
+	}
+
+
 	//-------------------------------------------------------------------------------------------
 	//-- write out utility methods for creating vk::SpecializationInfo records.
 
@@ -123,7 +125,7 @@ R"(
 			const string &indent) {
 
 		for (auto &s : sh) {
-			shader_specializer(r, *s.comp, sh.size() == 1 ? "" : get_execution_string(*s.comp),
+			shader_specializer(r, *s.reflection, sh.size() == 1 ? "" : get_execution_string(*s.reflection),
 				indent);
 		}
 	}
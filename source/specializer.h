@@ -11,6 +11,19 @@
 
 namespace autoshader {
 
+	//-------------------------------------------------------------------------------------------
+	//-- Specialization: the type and name of a specialization constant
+
+	struct Specialization {
+		uint32_t type;
+		string name;
+	};
+
+	//-------------------------------------------------------------------------------------------
+	//-- the named specialization constants and the workgroup size constants, by constant id
+
+	std::map<uint32_t, Specialization> get_specializations(const Reflection &ir);
+
 	//-------------------------------------------------------------------------------------------
 	//-- write out utility methods for creating vk::SpecializationInfo records.
 
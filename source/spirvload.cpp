@@ -0,0 +1,109 @@
+//
+//  File: spirvload.cpp
+//
+//  Created by Jon Spencer on 2026-10-16 10:02:31
+//  Copyright (c) Jon Spencer. See LICENSE file.
+//
+
+#include "spirvload.h"
+#include <fstream>
+#include <stdexcept>
+#include <utility>
+
+#ifndef WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace autoshader {
+
+	SpirvWords::SpirvWords(vector<uint32_t> w) : owned(std::move(w)) {
+		words = owned.data();
+		count = owned.size();
+	}
+
+	SpirvWords::~SpirvWords() {
+		#ifndef WIN32
+		if (mapping != nullptr)
+			munmap(mapping, mapsize);
+		#endif
+	}
+
+	void SpirvWords::swap(SpirvWords &o) noexcept {
+		std::swap(words, o.words);
+		std::swap(count, o.count);
+		std::swap(owned, o.owned);
+		std::swap(mapping, o.mapping);
+		std::swap(mapsize, o.mapsize);
+	}
+
+
+	//------------------------------------------------------------------------------------------
+	//-- read a spirv module from a stream
+
+	SpirvWords load_spirv(const string &f, std::istream &str) {
+		vector<uint32_t> r(64 * 1024);
+		for (size_t s = 0;;) {
+			if (s == 4 * r.size())
+				r.resize(2 * r.size());
+			str.read(reinterpret_cast<char*>(r.data()) + s, 4 * r.size() - s);
+			if (str.bad())
+				throw std::runtime_error("error loading spriv from " + f);
+			s += str.gcount();
+			if (str.eof()) {
+				if (s & 3)
+					throw std::runtime_error("invalid spirv file length for " + f);
+				r.resize(s / 4);
+				return SpirvWords(std::move(r));
+			}
+		}
+	}
+
+
+	//------------------------------------------------------------------------------------------
+	//-- map a spirv module from a file
+
+	SpirvWords load_spirv(const string &f) {
+		#ifndef WIN32
+		int fd = open(f.c_str(), O_RDONLY);
+		if (fd < 0)
+			throw std::runtime_error("failed to open file: " + f);
+
+		struct stat st;
+		if (fstat(fd, &st) != 0) {
+			close(fd);
+			throw std::runtime_error("failed to stat file: " + f);
+		}
+
+		size_t l = size_t(st.st_size);
+		if (l & 3) {
+			close(fd);
+			throw std::runtime_error("invalid spirv file length for file " + f);
+		}
+
+		// an empty file can't be mapped, let the parser complain about it
+		SpirvWords r;
+		if (l != 0) {
+			void *m = mmap(nullptr, l, PROT_READ, MAP_PRIVATE, fd, 0);
+			if (m == MAP_FAILED) {
+				close(fd);
+				throw std::runtime_error("failed to map file: " + f);
+			}
+			r.mapping = m;
+			r.mapsize = l;
+			r.words = static_cast<const uint32_t*>(m);
+			r.count = l / 4;
+		}
+		close(fd);
+		return r;
+		#else
+		std::ifstream str(f, std::ios::binary);
+		if (!str.good())
+			throw std::runtime_error("failed to open file: " + f);
+		return load_spirv("file " + f, str);
+		#endif
+	}
+
+} // namespace autoshader
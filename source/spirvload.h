@@ -0,0 +1,56 @@
+//
+//  File: spirvload.h
+//
+//  Created by Jon Spencer on 2026-10-16 10:02:17
+//  Copyright (c) Jon Spencer. See LICENSE file.
+//
+#ifndef H_SOURCE_SPIRVLOAD_H__
+#define H_SOURCE_SPIRVLOAD_H__
+
+#include "autoshader.h"
+#include <cstdint>
+#include <istream>
+
+namespace autoshader {
+
+	//------------------------------------------------------------------------------------------
+	//-- SpirvWords: the words of a spirv module. files are mapped into memory and used in
+	//-- place, streams are read into an owned buffer.
+
+	struct SpirvWords {
+		SpirvWords() {}
+		explicit SpirvWords(vector<uint32_t> w);
+		SpirvWords(SpirvWords &&o) noexcept { swap(o); }
+		SpirvWords &operator = (SpirvWords &&o) noexcept { swap(o); return *this; }
+		~SpirvWords();
+
+		SpirvWords(const SpirvWords &) = delete;
+		SpirvWords &operator = (const SpirvWords &) = delete;
+
+		const uint32_t *data() const { return words; }
+		size_t size() const { return count; }
+		bool empty() const { return count == 0; }
+		const uint32_t *begin() const { return words; }
+		const uint32_t *end() const { return words + count; }
+		uint32_t operator [] (size_t i) const { return words[i]; }
+
+		void swap(SpirvWords &o) noexcept;
+
+		const uint32_t *words = nullptr;
+		size_t count = 0;
+		vector<uint32_t> owned;
+		void *mapping = nullptr;
+		size_t mapsize = 0;
+	};
+
+	//------------------------------------------------------------------------------------------
+	//-- read a spirv module from a stream
+	SpirvWords load_spirv(const string &f, std::istream &str);
+
+	//------------------------------------------------------------------------------------------
+	//-- map a spirv module from a file, falling back to reading it if mapping isn't available
+	SpirvWords load_spirv(const string &f);
+
+} // namespace autoshader
+
+#endif // H_SOURCE_SPIRVLOAD_H__
@@ -0,0 +1,141 @@
+//
+//  File: spirvpack.cpp
+//
+//  Created by Jon Spencer on 2026-10-16 13:44:26
+//  Copyright (c) Jon Spencer. See LICENSE file.
+//
+
+#include "spirvpack.h"
+#include <cstring>
+#include <stdexcept>
+
+namespace autoshader {
+
+	namespace {
+
+		// the opcodes of the instructions that are stripped
+		enum : uint32_t {
+			OpSourceContinued = 2,
+			OpSource = 3,
+			OpSourceExtension = 4,
+			OpName = 5,
+			OpMemberName = 6,
+			OpString = 7,
+			OpLine = 8,
+			OpExtInstImport = 11,
+			OpNoLine = 317,
+			OpModuleProcessed = 330,
+		};
+
+		constexpr size_t headerSize = 5;
+
+		// the shortest match worth a token
+		constexpr size_t minMatch = 2;
+		constexpr unsigned hashBits = 16;
+
+		void put(string &r, uint32_t v) {
+			for (; v >= 0x80; v >>= 7)
+				r += char(v | 0x80);
+			r += char(v);
+		}
+
+		uint32_t match_hash(const uint32_t *w) {
+			uint64_t h = (uint64_t(w[0]) << 32 | w[1]) * 0x9e3779b97f4a7c15ull;
+			return uint32_t(h >> (64 - hashBits));
+		}
+
+		void put_literals(string &r, const uint32_t *w, size_t n) {
+			if (n == 0)
+				return;
+			put(r, uint32_t(n - 1) << 1);
+			for (size_t i = 0; i < n; ++i)
+				put(r, w[i]);
+		}
+
+	} // namespace
+
+
+	//------------------------------------------------------------------------------------------
+	//-- strip the debug instructions
+
+	vector<uint32_t> strip_spirv(const uint32_t *words, size_t count) {
+		if (count < headerSize)
+			throw std::runtime_error("invalid spirv module");
+
+		// strings may be operands of non-semantic instructions like the shader debug info
+		bool keepStrings = false;
+		for (size_t i = headerSize; i < count;) {
+			auto op = words[i] & 0xffff, wc = words[i] >> 16;
+			if (wc == 0 || wc > count - i)
+				throw std::runtime_error("invalid spirv instruction");
+			if (op == OpExtInstImport && wc > 2) {
+				auto name = reinterpret_cast<const char*>(words + i + 2);
+				keepStrings |= strncmp(name, "NonSemantic.", 12) == 0;
+			}
+			i += wc;
+		}
+
+		vector<uint32_t> r(words, words + headerSize);
+		r.reserve(count);
+		for (size_t i = headerSize; i < count;) {
+			auto op = words[i] & 0xffff, wc = words[i] >> 16;
+			switch (op) {
+				case OpString:
+					if (keepStrings)
+						r.insert(r.end(), words + i, words + i + wc);
+					break;
+				case OpSourceContinued: case OpSource: case OpSourceExtension: case OpName:
+				case OpMemberName: case OpLine: case OpNoLine: case OpModuleProcessed:
+					break;
+				default:
+					r.insert(r.end(), words + i, words + i + wc);
+					break;
+			}
+			i += wc;
+		}
+		return r;
+	}
+
+
+	//------------------------------------------------------------------------------------------
+	//-- greedy word level lz - repeated operand sequences are common in spirv
+
+	string pack_spirv(const uint32_t *words, size_t count) {
+		if (count > 0x7fffffff)
+			throw std::runtime_error("spirv module too large to pack");
+
+		string r;
+		put(r, uint32_t(count));
+
+		vector<size_t> table(size_t(1) << hashBits, ~size_t(0));
+		size_t lit = 0;
+		for (size_t i = 0; i + minMatch <= count;) {
+			auto &slot = table[match_hash(words + i)];
+			auto c = slot;
+			slot = i;
+
+			size_t l = 0;
+			if (c != ~size_t(0)) {
+				while (i + l < count && l < 0x7fffffff && words[c + l] == words[i + l])
+					l += 1;
+			}
+			if (l < minMatch) {
+				i += 1;
+				continue;
+			}
+
+			put_literals(r, words + lit, i - lit);
+			put(r, uint32_t(l - minMatch) << 1 | 1);
+			put(r, uint32_t(i - c));
+
+			// remember the positions inside the match too
+			for (size_t k = i + 1; k < i + l && k + minMatch <= count; ++k)
+				table[match_hash(words + k)] = k;
+			i += l;
+			lit = i;
+		}
+		put_literals(r, words + lit, count - lit);
+		return r;
+	}
+
+} // namespace autoshader
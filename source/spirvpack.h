@@ -0,0 +1,26 @@
+//
+//  File: spirvpack.h
+//
+//  Created by Jon Spencer on 2026-10-16 13:44:10
+//  Copyright (c) Jon Spencer. See LICENSE file.
+//
+#ifndef H_SOURCE_SPIRVPACK_H__
+#define H_SOURCE_SPIRVPACK_H__
+
+#include "autoshader.h"
+#include <cstdint>
+
+namespace autoshader {
+
+	//------------------------------------------------------------------------------------------
+	//-- remove the debug instructions that don't affect the module - names, source and line
+	//-- information. strings are kept if a non-semantic instruction set might refer to them.
+	vector<uint32_t> strip_spirv(const uint32_t *words, size_t count);
+
+	//------------------------------------------------------------------------------------------
+	//-- compress spirv words into the format read by include/autoshader/spirvpack.h
+	string pack_spirv(const uint32_t *words, size_t count);
+
+} // namespace autoshader
+
+#endif // H_SOURCE_SPIRVPACK_H__
@@ -0,0 +1,54 @@
+//
+//  File: taskpool.cpp
+//
+//  Created by Jon Spencer on 2026-10-16 09:12:52
+//  Copyright (c) Jon Spencer. See LICENSE file.
+//
+
+#include "taskpool.h"
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <thread>
+
+namespace autoshader {
+
+	//------------------------------------------------------------------------------------------
+	//-- run the tasks on up to 'jobs' threads
+
+	void run_tasks(size_t jobs, vector<std::function<void()>> &tasks) {
+		if (jobs <= 1 || tasks.size() <= 1) {
+			for (auto &t : tasks)
+				t();
+			return;
+		}
+
+		// each worker pulls the next task until they are all taken
+		std::atomic<size_t> next(0);
+		vector<std::exception_ptr> errors(tasks.size());
+		auto worker = [&] () {
+			for (size_t i; (i = next++) < tasks.size();) {
+				try {
+					tasks[i]();
+				}
+				catch (...) {
+					errors[i] = std::current_exception();
+				}
+			}
+		};
+
+		// the calling thread does its share of the work
+		vector<std::thread> threads;
+		for (size_t i = 1; i < std::min(jobs, tasks.size()); ++i)
+			threads.emplace_back(worker);
+		worker();
+		for (auto &t : threads)
+			t.join();
+
+		for (auto &e : errors) {
+			if (e)
+				std::rethrow_exception(e);
+		}
+	}
+
+} // namespace autoshader
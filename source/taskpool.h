@@ -0,0 +1,23 @@
+//
+//  File: taskpool.h
+//
+//  Created by Jon Spencer on 2026-10-16 09:12:40
+//  Copyright (c) Jon Spencer. See LICENSE file.
+//
+#ifndef H_SOURCE_TASKPOOL_H__
+#define H_SOURCE_TASKPOOL_H__
+
+#include "autoshader.h"
+#include <functional>
+
+namespace autoshader {
+
+	//------------------------------------------------------------------------------------------
+	//-- run the tasks on up to 'jobs' threads. with a single job the tasks are run in order on
+	//-- the calling thread. the first failure (in task order) is re-thrown once all are done.
+
+	void run_tasks(size_t jobs, vector<std::function<void()>> &tasks);
+
+} // namespace autoshader
+
+#endif // H_SOURCE_TASKPOOL_H__
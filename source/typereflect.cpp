@@ -16,7 +16,7 @@ namespace autoshader {
 		//------------------------------------------------------------------------------------------
 		//-- return the correct type for vector and matrix types (i.e. float vs. vec4 vs. mat2x3)
 
-		string vector_string(spirv_cross::SPIRType const& type, const char *base,
+		string vector_string(const ReflectType &type, const char *base,
 				const char *vec, const char *mat = nullptr) {
 			if (type.vecsize == 1) {
 				if (type.columns != 1)
@@ -61,27 +61,14 @@ namespace autoshader {
 			throw std::runtime_error("invalid image dimension");
 		}
 
-		//------------------------------------------------------------------------------------------
-		//-- given a type return the mapped type name
-
-		string type_string_mapped(ShaderRecord &sh, spirv_cross::SPIRType type) {
-			using spirv_cross::SPIRType;
-			if (type.basetype != SPIRType::Struct)
-				return type_string(*sh.comp, type);
-			auto i = sh.names.find(type.self);
-			if (i == sh.names.end())
-				throw std::runtime_error("internal error: unmapped structure name");
-			return sh.names[type.self];
-		}
-
 		//------------------------------------------------------------------------------------------
 		// the size of the type as declared in c
 
-		size_t c_type_size(spirv_cross::Compiler &comp, spirv_cross::SPIRType type) {
+		size_t c_type_size(const ReflectType &type) {
 			using spirv_cross::SPIRType;
 
 			// array's will get the correct padding to match the stride
-			if (!type.array.empty())
+			if (type.arrayCount != 0)
 				throw std::runtime_error("shouldn't get c_type_size of array elements");
 
 			switch (type.basetype) {
@@ -100,7 +87,9 @@ namespace autoshader {
 
 				case SPIRType::Struct:
 					// struct's will be padded to the declared size
-					return comp.get_declared_struct_size(type);
+					if (!type.layout)
+						throw std::runtime_error("internal error: structure has no layout");
+					return type.size;
 			}
 
 			throw std::runtime_error("invalid type for structure member");
@@ -118,21 +107,20 @@ namespace autoshader {
 		//------------------------------------------------------------------------------------------
 		//-- declare a the member of the structure type
 
-		size_t declare_member(fmt::memory_buffer &r, ShaderRecord &sh,
-				uint32_t t, uint32_t m) {
-			auto &comp = *sh.comp;
-			auto stct = comp.get_type(t);
-			string name = comp.get_member_name(t, m);
-			auto type = comp.get_type(stct.member_types[m]);
+		size_t declare_member(fmt::memory_buffer &r, ShaderRecord &sh, const ReflectMember &m) {
+			auto &ir = *sh.reflection;
+			auto &name = ir.string_at(m.name);
+			auto &type = ir.type(m.type);
+			auto array = ir.array(type);
 
 			// check if this type needs column padding
 			int colpad = 0;
-			auto arrtype = comp.get_type(type.self);
+			auto &arrtype = ir.type(type.self);
 			auto coltype = arrtype;
 			coltype.columns = 1;
-			auto ccolsize = c_type_size(comp, coltype);
+			auto ccolsize = c_type_size(coltype);
 			if (arrtype.columns > 1) {
-				auto scolsize = comp.type_struct_member_matrix_stride(stct, m);
+				auto scolsize = m.matrixStride;
 				colpad = scolsize - ccolsize;
 				ccolsize = scolsize;
 			}
@@ -140,10 +128,10 @@ namespace autoshader {
 			// check it the type needs array column padding
 			int arrpad = 0;
 			auto carrsize = ccolsize * arrtype.columns;
-			if (!type.array.empty()) {
-				auto l = std::max(type.array.back(), uint32_t(1));
-				auto s = comp.type_struct_member_array_stride(stct, m);
-				auto t = std::accumulate(type.array.begin(), type.array.end(), uint32_t(1),
+			if (!array.empty()) {
+				auto l = std::max(array.back(), uint32_t(1));
+				auto s = m.arrayStride;
+				auto t = std::accumulate(array.begin(), array.end(), uint32_t(1),
 					[] (auto a, auto b) { return a * std::max(b, uint32_t(1)); });
 				arrpad = s * l / t - carrsize;
 				carrsize += arrpad;
@@ -173,9 +161,9 @@ namespace autoshader {
 			}
 
 			// add the array elements
-			for (size_t i = type.array.size(); i-- != 0;) {
-				format_to(std::back_inserter(r), "[{}]", type.array[i]);
-				carrsize *= type.array[i];
+			for (size_t i = array.size(); i-- != 0;) {
+				format_to(std::back_inserter(r), "[{}]", array[i]);
+				carrsize *= array[i];
 			}
 
 			return carrsize;
@@ -210,10 +198,24 @@ namespace autoshader {
 	} // namespace
 
 
+	//------------------------------------------------------------------------------------------
+	//-- given a type return the mapped type name
+
+	string type_string_mapped(ShaderRecord &sh, const ReflectType &type) {
+		using spirv_cross::SPIRType;
+		if (type.basetype != SPIRType::Struct)
+			return type_string(*sh.reflection, type);
+		auto i = sh.names.find(type.self);
+		if (i == sh.names.end())
+			throw std::runtime_error("internal error: unmapped structure name");
+		return i->second;
+	}
+
+
 	//------------------------------------------------------------------------------------------
 	//-- return the the c type matching the glsl type
 
-	string type_string(spirv_cross::Compiler &comp, spirv_cross::SPIRType type) {
+	string type_string(const Reflection &ir, const ReflectType &type) {
 		using spirv_cross::SPIRType;
 		switch (type.basetype) {
 			default:
@@ -260,11 +262,11 @@ namespace autoshader {
 				return vector_string(type, "double", "dvec", "dmat");
 			}
 			case SPIRType::Struct: {
-				return comp.get_name(type.self);
+				return ir.name(type);
 			}
 			case SPIRType::Image: {
-				return fmt::format("{}{}", type.image.sampled == 1 ? "texture" : "image",
-					image_dimension_string(type.image.dim));
+				return fmt::format("{}{}", type.imagesampled == 1 ? "texture" : "image",
+					image_dimension_string(type.imagedim));
 			}
 		}
 		throw std::runtime_error("invalid type can't be converted to string");
@@ -276,8 +278,8 @@ namespace autoshader {
 	void struct_definition(fmt::memory_buffer &r, ShaderRecord &sh, uint32_t t,
 			const string& indent) {
 		using spirv_cross::SPIRType;
-		auto &comp = *sh.comp;
-		SPIRType type = comp.get_type(t);
+		auto &ir = *sh.reflection;
+		auto &type = ir.type(t);
 		if (type.basetype != SPIRType::Struct)
 			throw std::runtime_error("struct_definition called on non-struct");
 
@@ -286,19 +288,19 @@ namespace autoshader {
 		// keep track of pad variables
 		int padindex = 0;
 		std::set<string> members;
-		for (uint32_t i = 0; size_t(i) < type.member_types.size(); ++i)
-			members.insert(comp.get_member_name(t, i));
+		auto sm = ir.struct_members(type);
+		for (auto &m : sm)
+			members.insert(ir.string_at(m.name));
 
 		size_t offset = 0;
-		for (uint32_t i = 0; size_t(i) < type.member_types.size(); ++i) {
+		for (auto &m : sm) {
 			// Add padding to bring to the declared offset
-			add_padding(r, offset, comp.type_struct_member_offset(type, i), padindex,
-				members, indent);
+			add_padding(r, offset, m.offset, padindex, members, indent);
 
 			format_to(std::back_inserter(r), "{}  ", indent);
 
 			// add the member declaration
-			auto csize = declare_member(r, sh, t, i);
+			auto csize = declare_member(r, sh, m);
 			format_to(std::back_inserter(r), ";\n");
 
 			// update the size of the c structure
@@ -306,7 +308,7 @@ namespace autoshader {
 		}
 
 		// pad up to the declared structure size (can this happen?)
-		add_padding(r, offset, comp.get_declared_struct_size(type), padindex, members, indent);
+		add_padding(r, offset, type.size, padindex, members, indent);
 
 		format_to(std::back_inserter(r), "{}}}", indent);
 	}
@@ -8,22 +8,27 @@
 #define H_SOURCE_TYPEREFLECT_H__
 
 #include "autoshader.h"
-#include "spirv_cross.hpp"
+#include "spirvload.h"
+#include "reflection.h"
 #include <fmt/format.h>
 #include <map>
 
 namespace autoshader {
 
 	struct ShaderRecord {
-		std::unique_ptr<spirv_cross::Compiler> comp;
-		vector<uint32_t> source;
+		std::unique_ptr<const Reflection> reflection;
+		SpirvWords source;
 		vector<uint32_t> structs;
 		std::map<uint32_t, string> names;
 	};
 
 	//------------------------------------------------------------------------------------------
 	//-- return the the c type matching the glsl type
-	string type_string(spirv_cross::Compiler &comp, spirv_cross::SPIRType type);
+	string type_string(const Reflection &ir, const ReflectType &type);
+
+	//------------------------------------------------------------------------------------------
+	//-- return the c type, with structures under their mapped names
+	string type_string_mapped(ShaderRecord &sh, const ReflectType &type);
 
 	//------------------------------------------------------------------------------------------
 	//-- format the structure definition into the buffer
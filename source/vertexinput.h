@@ -8,12 +8,18 @@
 #define H_SOURCE_VERTEXINPUT_H__
 
 #include "autoshader.h"
-#include "spirv_cross.hpp"
+#include "reflection.h"
+#include "autoshader/layoutrules.h"
 #include <fmt/format.h>
 
 namespace autoshader {
 
-	bool get_vertex_definition(fmt::memory_buffer &r, spirv_cross::Compiler &comp,
+	//------------------------------------------------------------------------------------------
+	// the component type of a vertex attribute, throwing if the type has no vertex format
+
+	layoutrules::VertexComponent vertex_component(const ReflectType &type);
+
+	bool get_vertex_definition(fmt::memory_buffer &r, const Reflection &ir,
 			const string &name, const string &indent);
 
 } // namespace autoshader
@@ -0,0 +1,171 @@
+//
+//  File: watch.cpp
+//
+//  Created by Jon Spencer on 2026-10-16 12:35:24
+//  Copyright (c) Jon Spencer. See LICENSE file.
+//
+
+#include "watch.h"
+#include <cerrno>
+#include <chrono>
+#include <iostream>
+#include <set>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace autoshader {
+
+	#ifdef __linux__
+
+	namespace {
+
+		//------------------------------------------------------------------------------------------
+		//-- WatchedPipeline: a pipeline with the stages parsed on the last generation
+
+		struct WatchedPipeline {
+			const PipelineOptions *opts;
+			vector<ShaderRecord> shaders;
+		};
+
+		//------------------------------------------------------------------------------------------
+		//-- StageRef: a stage of a watched pipeline
+
+		struct StageRef {
+			size_t pipeline;
+			size_t stage;
+		};
+
+		//------------------------------------------------------------------------------------------
+		//-- split a path into the directory to watch and the name within it
+
+		std::pair<string, string> split_path(const string &p) {
+			auto s = p.rfind('/');
+			if (s == string::npos)
+				return std::make_pair(string("."), p);
+			return std::make_pair(s == 0 ? string("/") : p.substr(0, s), p.substr(s + 1));
+		}
+
+		//------------------------------------------------------------------------------------------
+		//-- load a stage into memory the watcher owns. the file may be rewritten in place at any
+		//-- time, so a mapping of it could change (or fault) under a later generation.
+
+		void load_stage(ShaderRecord &sh, const string &f) {
+			auto m = load_spirv(f);
+			sh = ShaderRecord();
+			sh.source = SpirvWords(vector<uint32_t>(m.begin(), m.end()));
+		}
+
+		//------------------------------------------------------------------------------------------
+		//-- generate one pipeline, loading any stage that isn't loaded yet. errors are reported
+		//-- rather than thrown so the watch carries on.
+
+		void regenerate(const string &prog, WatchedPipeline &p, size_t jobs) {
+			auto start = std::chrono::steady_clock::now();
+			try {
+				for (size_t i = 0; i < p.shaders.size(); ++i) {
+					if (p.shaders[i].source.empty())
+						load_stage(p.shaders[i], p.opts->input[i]);
+				}
+				write_output(*p.opts, generate_pipeline(prog, *p.opts, p.shaders, jobs));
+			}
+			catch (std::exception &err) {
+				std::cerr << prog << ": " << p.opts->output << " failed: " << err.what() << std::endl;
+				return;
+			}
+			auto t = std::chrono::duration<double, std::milli>(
+				std::chrono::steady_clock::now() - start).count();
+			std::cerr << fmt::format("{}: generated {} in {:.1f}ms\n", prog, p.opts->output, t);
+		}
+
+	} // namespace
+
+
+	void watch_pipelines(const string &prog, const vector<PipelineOptions> &pipelines,
+			size_t jobs, size_t rounds) {
+
+		int fd = inotify_init1(IN_CLOEXEC);
+		if (fd < 0)
+			throw std::runtime_error("failed to initialize inotify");
+
+		// watch the directories holding the inputs, so files replaced by a rename are seen. the
+		// stages are keyed by watch descriptor so different spellings of a directory agree.
+		typedef std::pair<int, string> WatchName;
+		std::map<WatchName, vector<StageRef>> stages;
+		vector<WatchedPipeline> watched(pipelines.size());
+		for (size_t i = 0; i < pipelines.size(); ++i) {
+			watched[i].opts = &pipelines[i];
+			watched[i].shaders.resize(pipelines[i].input.size());
+			for (size_t j = 0; j < pipelines[i].input.size(); ++j) {
+				auto p = split_path(pipelines[i].input[j]);
+				int wd = inotify_add_watch(fd, p.first.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+				if (wd < 0)
+					throw std::runtime_error("failed to watch directory: " + p.first);
+				stages[WatchName(wd, p.second)].push_back({ i, j });
+			}
+		}
+
+		// generate everything once
+		std::set<size_t> dirty;
+		for (size_t i = 0; i < watched.size(); ++i)
+			dirty.insert(i);
+
+		vector<char> buf(64 * 1024);
+		for (size_t round = 0;;) {
+			if (!dirty.empty()) {
+				for (auto i : dirty)
+					regenerate(prog, watched[i], jobs);
+				dirty.clear();
+				if (++round == rounds)
+					break;
+			}
+
+			// wait for a change, then collect the burst of events that usually follows
+			std::set<WatchName> changed;
+			for (int timeout = -1;; timeout = 20) {
+				pollfd pfd{ fd, POLLIN, 0 };
+				int n = poll(&pfd, 1, timeout);
+				if (n < 0 && errno != EINTR)
+					throw std::runtime_error("error waiting for inotify events");
+				if (n <= 0)
+					break;
+
+				auto l = read(fd, buf.data(), buf.size());
+				if (l <= 0)
+					throw std::runtime_error("error reading inotify events");
+				for (ssize_t o = 0; o < l;) {
+					auto e = reinterpret_cast<const inotify_event*>(buf.data() + o);
+					o += sizeof(inotify_event) + e->len;
+					if (e->len != 0)
+						changed.insert(WatchName(e->wd, e->name));
+				}
+			}
+
+			// drop only the changed stages, the rest keep their parse
+			for (auto &c : changed) {
+				auto s = stages.find(c);
+				if (s == stages.end())
+					continue;
+				for (auto &r : s->second) {
+					watched[r.pipeline].shaders[r.stage] = ShaderRecord();
+					dirty.insert(r.pipeline);
+				}
+			}
+		}
+
+		close(fd);
+	}
+
+	#else
+
+	void watch_pipelines(const string &prog, const vector<PipelineOptions> &pipelines,
+			size_t jobs, size_t rounds) {
+		throw std::runtime_error("watch mode needs inotify and is only available on linux");
+	}
+
+	#endif
+
+} // namespace autoshader
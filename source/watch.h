@@ -0,0 +1,25 @@
+//
+//  File: watch.h
+//
+//  Created by Jon Spencer on 2026-10-16 12:35:10
+//  Copyright (c) Jon Spencer. See LICENSE file.
+//
+#ifndef H_SOURCE_WATCH_H__
+#define H_SOURCE_WATCH_H__
+
+#include "generate.h"
+
+namespace autoshader {
+
+	//------------------------------------------------------------------------------------------
+	//-- generate the pipelines, then stay resident and regenerate the pipelines whose inputs
+	//-- change. the parsed stages are kept between runs, so a change only re-parses the
+	//-- stages whose files changed. the watch returns after rounds generations that regenerate
+	//-- something, counting the first, or never if rounds is zero.
+
+	void watch_pipelines(const string &prog, const vector<PipelineOptions> &pipelines,
+		size_t jobs, size_t rounds = 0);
+
+} // namespace autoshader
+
+#endif // H_SOURCE_WATCH_H__
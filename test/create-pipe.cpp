@@ -23,7 +23,7 @@ TEST_CASE( "create-pipe" ) {
 	SECTION( "create pipe" ) {
 
 		vk::ApplicationInfo appinfo{ "create-pipe", 0x010000, "autoshader", 0x010000,
-			VK_API_VERSION_1_0 };
+			VK_API_VERSION_1_3 };
 		auto inst = vk::createInstanceUnique({ {}, &appinfo });
 		auto phys = inst->enumeratePhysicalDevices();
 		REQUIRE( phys.size() > 0 );
@@ -50,6 +50,45 @@ TEST_CASE( "create-pipe" ) {
 		auto pipeline = pcomp.createPipe(*dev, *rp);
 		REQUIRE( *pipeline != vk::Pipeline() );
 
+		// a batch comes back in order
+		auto pipes = autoshader::createPipes(pcomp.pipeArgs(*rp),
+			pcomp.pipeArgs(*rp, vk::CullModeFlagBits::eBack),
+			pcomp.pipeArgs(*rp, vk::PrimitiveTopology::eTriangleList));
+		REQUIRE( pipes.size() == 3 );
+		for (auto &p : pipes) {
+			REQUIRE( p.result == vk::Result::eSuccess );
+			REQUIRE( *p.pipeline != vk::Pipeline() );
+		}
+
+		// a pipeline that fails keeps its place in the batch
+		if (phys[0].getProperties().apiVersion < VK_API_VERSION_1_3 ||
+				!phys[0].getFeatures2<vk::PhysicalDeviceFeatures2,
+					vk::PhysicalDeviceVulkan13Features>().get<vk::PhysicalDeviceVulkan13Features>()
+					.pipelineCreationCacheControl) {
+			WARN( "FailIfUncached needs pipelineCreationCacheControl, skipped" );
+			return;
+		}
+		vk::PhysicalDeviceVulkan13Features control;
+		control.pipelineCreationCacheControl = true;
+		vk::DeviceCreateInfo info{ {}, 1, &que };
+		info.pNext = &control;
+		auto cdev = phys[0].createDeviceUnique(info);
+		auto crp = cdev->createRenderPassUnique({ {}, 1, &attachment, 1, &subpass });
+
+		// the batch uses the empty cache of the first pack, so only that pack fails
+		shader::Components ccomp(*cdev);
+		auto cache = cdev->createPipelineCacheUnique({});
+		auto mixed = autoshader::createPipes(
+			ccomp.pipeArgs(*crp, *cache, autoshader::FailIfUncached()),
+			ccomp.pipeArgs(*crp, vk::CullModeFlagBits::eBack),
+			ccomp.pipeArgs(*crp, vk::PrimitiveTopology::eTriangleList));
+		REQUIRE( mixed[0].result == vk::Result::ePipelineCompileRequired );
+		REQUIRE( !mixed[0].pipeline );
+		for (size_t i = 1; i < mixed.size(); ++i) {
+			REQUIRE( mixed[i].result == vk::Result::eSuccess );
+			REQUIRE( *mixed[i].pipeline != vk::Pipeline() );
+		}
+
 	}
 
 }
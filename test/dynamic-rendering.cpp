@@ -0,0 +1,67 @@
+//
+//  File: dynamic-rendering.cpp
+//
+//  Created by Jon Spencer on 2026-10-17 00:47:31
+//  Copyright (c) Jon Spencer. See LICENSE file.
+//
+
+#include <catch2/catch_test_macros.hpp>
+#include "glm/glm.hpp"
+#include "autoshader/pipelinevariants.h"
+#include "test-device.h"
+
+namespace shader {
+
+	using namespace glm;
+
+	#define AUTOSHADER_SOURCE_DATA
+	#include "create-pipe-autoshader.h"
+
+}
+
+TEST_CASE( "dynamic-rendering" ) {
+
+	testdevice::Device d("dynamic-rendering", VK_API_VERSION_1_3);
+	if (d.phys.getProperties().apiVersion < VK_API_VERSION_1_3) {
+		WARN( "dynamic rendering needs vulkan 1.3, skipped" );
+		return;
+	}
+	auto features = d.phys.getFeatures2<vk::PhysicalDeviceFeatures2,
+		vk::PhysicalDeviceVulkan13Features>();
+	if (!features.get<vk::PhysicalDeviceVulkan13Features>().dynamicRendering) {
+		WARN( "dynamicRendering isn't supported, skipped" );
+		return;
+	}
+	vk::PhysicalDeviceVulkan13Features enable;
+	enable.dynamicRendering = true;
+	d.create(0, nullptr, &enable);
+
+	// the fragment shader writes location 0
+	REQUIRE( uint32_t(shader::Components::colorAttachmentCount) == 1 );
+
+	vk::Format color[] = { vk::Format::eR8G8B8A8Unorm, vk::Format::eR8G8B8A8Unorm };
+	vk::Format other[] = { vk::Format::eB8G8R8A8Unorm };
+
+	SECTION( "a pipeline is created without a render pass" ) {
+		shader::Components comp(*d.dev);
+		auto p = comp.createPipe(vk::PipelineRenderingCreateInfo{ 0, 1, color,
+			vk::Format::eD32Sfloat });
+		REQUIRE( p );
+
+		// a second color attachment gets a second default blend
+		p = comp.createPipe(vk::PipelineRenderingCreateInfo{ 0, 2, color });
+		REQUIRE( p );
+	}
+
+	SECTION( "rendering formats are keyed by value" ) {
+		autoshader::PipelineVariants<shader::Components> variants(shader::Components(*d.dev));
+		vk::Format same[] = { vk::Format::eR8G8B8A8Unorm };
+		auto a = variants.get(vk::PipelineRenderingCreateInfo{ 0, 1, color });
+		REQUIRE( a != vk::Pipeline() );
+		REQUIRE( variants.get(vk::PipelineRenderingCreateInfo{ 0, 1, same }) == a );
+		REQUIRE( variants.get(vk::PipelineRenderingCreateInfo{ 0, 1, other }) != a );
+		REQUIRE( variants.get(vk::PipelineRenderingCreateInfo{ 0, 1, color,
+			vk::Format::eD32Sfloat }) != a );
+		REQUIRE( variants.size() == 3 );
+	}
+}
@@ -0,0 +1,79 @@
+//
+//  File: dynamic-state.cpp
+//
+//  Created by Jon Spencer on 2026-10-17 00:37:26
+//  Copyright (c) Jon Spencer. See LICENSE file.
+//
+
+#include <catch2/catch_test_macros.hpp>
+#include "glm/glm.hpp"
+#include "autoshader/pipelinevariants.h"
+#include "test-device.h"
+
+namespace shader {
+
+	using namespace glm;
+
+	#define AUTOSHADER_SOURCE_DATA
+	#include "create-pipe-autoshader.h"
+
+}
+
+TEST_CASE( "dynamic-state" ) {
+
+	testdevice::Device d("dynamic-state", VK_API_VERSION_1_3);
+	if (d.phys.getProperties().apiVersion < VK_API_VERSION_1_3) {
+		WARN( "extended dynamic state needs vulkan 1.3, skipped" );
+		return;
+	}
+	d.create();
+
+	// the extended groups are set with vulkan 1.3 commands, so this links with the loader
+	autoshader::DynamicStates<autoshader::DynamicGroup::Extended |
+		autoshader::DynamicGroup::Extended2> dynamic;
+	const vk::CullModeFlagBits culls[] = { vk::CullModeFlagBits::eNone,
+		vk::CullModeFlagBits::eFront, vk::CullModeFlagBits::eBack };
+	const vk::CompareOp depths[] = { vk::CompareOp::eLess, vk::CompareOp::eAlways };
+
+	SECTION( "pipelines that differ in dynamic state are the same pipeline" ) {
+		autoshader::PipelineVariants<shader::Components> variants(shader::Components(*d.dev));
+		for (auto c : culls) {
+			for (auto depth : depths) {
+				variants.get(*d.rp, c, depth, vk::FrontFace::eClockwise);
+				variants.get(*d.rp, c, depth, vk::FrontFace::eCounterClockwise);
+			}
+		}
+		REQUIRE( variants.size() == 12 );
+
+		variants.clear();
+		variants.resetStats();
+		for (auto c : culls) {
+			for (auto depth : depths) {
+				REQUIRE( variants.get(*d.rp, dynamic, c, depth, vk::FrontFace::eClockwise) != vk::Pipeline() );
+				variants.get(*d.rp, dynamic, c, depth, vk::FrontFace::eCounterClockwise);
+			}
+		}
+		REQUIRE( variants.size() == 1 );
+		REQUIRE( variants.stats().misses == 1 );
+
+		// only the topology class is in the pipeline
+		variants.get(*d.rp, dynamic, vk::PrimitiveTopology::eTriangleList);
+		REQUIRE( variants.size() == 1 );
+		variants.get(*d.rp, dynamic, vk::PrimitiveTopology::eLineList);
+		REQUIRE( variants.size() == 2 );
+	}
+
+	SECTION( "the state is set on the command buffer" ) {
+		shader::Components comp(*d.dev);
+		auto pipeline = comp.createPipe(*d.rp, dynamic);
+		REQUIRE( *pipeline != vk::Pipeline() );
+
+		auto pool = d.dev->createCommandPoolUnique({ {}, 0 });
+		auto cbs = d.dev->allocateCommandBuffersUnique({ *pool, vk::CommandBufferLevel::ePrimary, 1 });
+		cbs[0]->begin(vk::CommandBufferBeginInfo{});
+		cbs[0]->bindPipeline(vk::PipelineBindPoint::eGraphics, *pipeline);
+		comp.cmdSetDynamicState(*cbs[0], dynamic, vk::CullModeFlagBits::eBack,
+			vk::Extent2D(64, 64));
+		cbs[0]->end();
+	}
+}
@@ -0,0 +1,41 @@
+//
+//  File: incbin.cpp
+//
+//  Created by Jon Spencer on 2026-10-16 13:05:41
+//  Copyright (c) Jon Spencer. See LICENSE file.
+//
+
+#include <catch2/catch_test_macros.hpp>
+#include "glm/glm.hpp"
+#include "vulkan/vulkan.hpp"
+#include "autoshader/createpipe.h"
+#include <cstring>
+
+namespace incbin {
+
+	using namespace glm;
+
+}
+
+// the incbin symbols are mangled for the --namespace option, so this header is not nested
+#include "incbin-autoshader.h"
+
+namespace shader {
+
+	using namespace glm;
+
+	#define AUTOSHADER_SOURCE_DATA
+	#include "jobs-serial-autoshader.h"
+
+}
+
+TEST_CASE( "incbin" ) {
+
+	SECTION( "binary data matches the source data" ) {
+		REQUIRE( incbin::vert_size == shader::vert_size );
+		REQUIRE( std::memcmp(incbin::vert_data, shader::vert_data, shader::vert_size) == 0 );
+		REQUIRE( incbin::frag_size == shader::frag_size );
+		REQUIRE( std::memcmp(incbin::frag_data, shader::frag_data, shader::frag_size) == 0 );
+	}
+
+}
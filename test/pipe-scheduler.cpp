@@ -0,0 +1,125 @@
+//
+//  File: pipe-scheduler.cpp
+//
+//  Created by Jon Spencer on 2026-10-17 00:22:42
+//  Copyright (c) Jon Spencer. See LICENSE file.
+//
+
+#include <catch2/catch_test_macros.hpp>
+#include "glm/glm.hpp"
+#include "autoshader/pipescheduler.h"
+#include "test-device.h"
+#include <future>
+
+namespace shader {
+
+	using namespace glm;
+
+	#define AUTOSHADER_SOURCE_DATA
+	#include "create-pipe-autoshader.h"
+
+}
+
+TEST_CASE( "pipe-scheduler" ) {
+
+	testdevice::Device d("pipe-scheduler", VK_API_VERSION_1_3);
+	d.create();
+
+	SECTION( "pipelines are delivered and the caches merged" ) {
+		std::vector<autoshader::Pipeline<shader::Components>> pipes(16);
+		for (auto &p : pipes)
+			p.components = shader::Components(*d.dev);
+
+		auto master = d.dev->createPipelineCacheUnique({});
+		autoshader::PipeScheduler scheduler(*d.dev, *master, 4);
+		for (size_t i = 0; i < pipes.size(); ++i) {
+			scheduler.createPipe(pipes[i], *d.rp, i % 2 == 0 ? vk::CullModeFlagBits::eBack :
+				vk::CullModeFlagBits::eFront);
+		}
+		REQUIRE( scheduler.merge() == vk::Result::eSuccess );
+		for (auto &p : pipes)
+			REQUIRE( p.pipeline != vk::Pipeline() );
+		REQUIRE( scheduler.masterCache() == *master );
+	}
+
+	SECTION( "async pipelines use the fallback until they are ready" ) {
+		autoshader::Pipeline<shader::Components> fallback(*d.dev, *d.rp);
+		REQUIRE( fallback.pipeline != vk::Pipeline() );
+
+		std::vector<std::unique_ptr<autoshader::AsyncPipe<shader::Components>>> pipes;
+		for (size_t i = 0; i < 8; ++i) {
+			pipes.emplace_back(new autoshader::AsyncPipe<shader::Components>(
+				shader::Components(*d.dev), fallback.pipeline));
+		}
+
+		autoshader::PipeScheduler scheduler(*d.dev, {}, 2);
+		for (size_t i = 0; i < pipes.size(); ++i) {
+			REQUIRE( !scheduler.createPipeAsync(*pipes[i], int(i), *d.rp) );
+			auto p = pipes[i]->get();
+			REQUIRE( (p == fallback.pipeline || pipes[i]->ready()) );
+		}
+		scheduler.wait();
+		for (auto &p : pipes) {
+			REQUIRE( p->ready() );
+			REQUIRE( !p->failed() );
+			REQUIRE( p->get() == p->pipeline.pipeline );
+			REQUIRE( p->get() != fallback.pipeline );
+		}
+	}
+
+	SECTION( "higher priority pipelines are created first" ) {
+		autoshader::Pipeline<shader::Components> low, high;
+		low.components = shader::Components(*d.dev);
+		high.components = shader::Components(*d.dev);
+
+		// hold the one worker until everything is queued
+		autoshader::PipeScheduler scheduler(*d.dev, {}, 1);
+		std::promise<void> gate;
+		std::shared_future<void> opened = gate.get_future().share();
+		scheduler.schedule(0, [opened] (vk::PipelineCache) { opened.wait(); });
+
+		// each pipeline is followed by a task at its priority that records it was created
+		std::vector<int> order;
+		scheduler.createPipeAt(0, low, *d.rp);
+		scheduler.schedule(0, [&order] (vk::PipelineCache) { order.push_back(0); });
+		scheduler.createPipeAt(1, high, *d.rp, vk::CullModeFlagBits::eBack);
+		scheduler.schedule(1, [&order] (vk::PipelineCache) { order.push_back(1); });
+		gate.set_value();
+		scheduler.wait();
+
+		std::vector<int> expected{ 1, 0 };
+		REQUIRE( order == expected );
+		REQUIRE( low.pipeline != vk::Pipeline() );
+		REQUIRE( high.pipeline != vk::Pipeline() );
+	}
+
+	SECTION( "a probe of a warmed master cache is ready at once" ) {
+		if (d.phys.getProperties().apiVersion < VK_API_VERSION_1_3 ||
+				!d.phys.getFeatures2<vk::PhysicalDeviceFeatures2,
+					vk::PhysicalDeviceVulkan13Features>().get<vk::PhysicalDeviceVulkan13Features>()
+					.pipelineCreationCacheControl) {
+			WARN( "probing the cache needs pipelineCreationCacheControl, skipped" );
+			return;
+		}
+		vk::PhysicalDeviceVulkan13Features control;
+		control.pipelineCreationCacheControl = true;
+		testdevice::Device c("pipe-scheduler", VK_API_VERSION_1_3);
+		c.create(0, nullptr, &control);
+
+		// create the pipeline on a worker and merge it into the master cache
+		auto master = c.dev->createPipelineCacheUnique({});
+		autoshader::PipeScheduler scheduler(*c.dev, *master, 2);
+		autoshader::AsyncPipe<shader::Components> warm(shader::Components(*c.dev));
+		REQUIRE( !scheduler.createPipeAsync(warm, 0, *c.rp) );
+		REQUIRE( scheduler.merge() == vk::Result::eSuccess );
+		REQUIRE( warm.ready() );
+
+		scheduler.probeCache = true;
+		autoshader::AsyncPipe<shader::Components> probed(shader::Components(*c.dev));
+		REQUIRE( scheduler.createPipeAsync(probed, 0, *c.rp) );
+		REQUIRE( probed.ready() );
+		REQUIRE( probed.get() != vk::Pipeline() );
+		scheduler.wait();
+	}
+
+}
@@ -0,0 +1,121 @@
+//
+//  File: pipeline-cache.cpp
+//
+//  Created by Jon Spencer on 2026-10-17 00:25:32
+//  Copyright (c) Jon Spencer. See LICENSE file.
+//
+
+#include <catch2/catch_test_macros.hpp>
+#include "glm/glm.hpp"
+#include "autoshader/pipeline.h"
+#include "autoshader/pipelinecache.h"
+#include "test-device.h"
+#include <cstdio>
+#include <fstream>
+
+namespace shader {
+
+	using namespace glm;
+
+	#define AUTOSHADER_SOURCE_DATA
+	#include "create-pipe-autoshader.h"
+
+}
+
+TEST_CASE( "pipeline-cache" ) {
+
+	testdevice::Device d("pipeline-cache");
+	d.create();
+	auto props = d.phys.getProperties();
+
+	std::string base = "pipeline-cache-test";
+	auto file = base + autoshader::PipelineCacheFile::fileKey(props);
+	std::remove(file.c_str());
+
+	SECTION( "the caches are saved and loaded by content hash" ) {
+		REQUIRE( shader::Components::contentHash() != 0 );
+		{
+			autoshader::PipelineCacheFile cf(*d.dev, props, base);
+			REQUIRE( cf.status() == autoshader::CacheFileStatus::Missing );
+			REQUIRE( cf.fileName() == file );
+			autoshader::Pipeline<shader::Components> p(*d.dev, cf.cache<shader::Components>(), *d.rp);
+			REQUIRE( p.pipeline != vk::Pipeline() );
+			REQUIRE( cf.stats().misses == 1 );
+			REQUIRE( cf.save() );
+			REQUIRE( cf.stats().savedBytes > 0 );
+		}
+		{
+			autoshader::PipelineCacheFile cf(*d.dev, props, base);
+			REQUIRE( cf.status() == autoshader::CacheFileStatus::Loaded );
+			REQUIRE( cf.stats().loadedBytes > 0 );
+			cf.cache<shader::Components>();
+			REQUIRE( cf.stats().hits == 1 );
+			REQUIRE( cf.stats().misses == 0 );
+		}
+	}
+
+	SECTION( "the caches are saved when destroyed unless asked not to" ) {
+		{
+			autoshader::PipelineCacheFile cf(*d.dev, props, base);
+			cf.saveOnDestroy = false;
+			autoshader::Pipeline<shader::Components> p(*d.dev, cf.cache<shader::Components>(), *d.rp);
+		}
+		{
+			autoshader::PipelineCacheFile cf(*d.dev, props, base);
+			REQUIRE( cf.status() == autoshader::CacheFileStatus::Missing );
+			autoshader::Pipeline<shader::Components> p(*d.dev, cf.cache<shader::Components>(), *d.rp);
+		}
+		autoshader::PipelineCacheFile cf(*d.dev, props, base);
+		REQUIRE( cf.status() == autoshader::CacheFileStatus::Loaded );
+		cf.cache<shader::Components>();
+		REQUIRE( cf.stats().hits == 1 );
+	}
+
+	SECTION( "unused programs are pruned" ) {
+		{
+			autoshader::PipelineCacheFile cf(*d.dev, props, base);
+			autoshader::Pipeline<shader::Components> p(*d.dev, cf.cache(1), *d.rp);
+			REQUIRE( cf.save() );
+		}
+		autoshader::PipelineCacheFile cf(*d.dev, props, base);
+		cf.keepSaves = 2;
+		REQUIRE( cf.save() );
+		REQUIRE( cf.stats().pruned == 0 );
+		REQUIRE( cf.save() );
+		REQUIRE( cf.stats().pruned == 1 );
+	}
+
+	SECTION( "data for another device is rejected" ) {
+		{
+			autoshader::PipelineCacheFile cf(*d.dev, props, base);
+			autoshader::Pipeline<shader::Components> p(*d.dev, cf.cache<shader::Components>(), *d.rp);
+			REQUIRE( cf.save() );
+		}
+		auto other = props;
+		other.pipelineCacheUUID[0] ^= 0xff;
+		auto otherFile = base + autoshader::PipelineCacheFile::fileKey(other);
+		REQUIRE( otherFile != file );
+		REQUIRE( std::rename(file.c_str(), otherFile.c_str()) == 0 );
+
+		autoshader::PipelineCacheFile cf(*d.dev, props, base);
+		REQUIRE( cf.status() == autoshader::CacheFileStatus::Missing );
+		autoshader::PipelineCacheFile of(*d.dev, other, base);
+		of.saveOnDestroy = false;
+		REQUIRE( of.status() == autoshader::CacheFileStatus::Loaded );
+		REQUIRE( of.stats().rejected == 1 );
+		std::remove(otherFile.c_str());
+	}
+
+	SECTION( "a damaged file is ignored" ) {
+		{
+			std::ofstream str(file, std::ios::binary);
+			str << "not a pipeline cache";
+		}
+		autoshader::PipelineCacheFile cf(*d.dev, props, base);
+		REQUIRE( cf.status() == autoshader::CacheFileStatus::Invalid );
+		cf.cache<shader::Components>();
+		REQUIRE( cf.stats().misses == 1 );
+	}
+
+	std::remove(file.c_str());
+}
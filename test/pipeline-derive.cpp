@@ -0,0 +1,110 @@
+//
+//  File: pipeline-derive.cpp
+//
+//  Created by Jon Spencer on 2026-10-17 00:28:37
+//  Copyright (c) Jon Spencer. See LICENSE file.
+//
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include "glm/glm.hpp"
+#include "autoshader/pipeline.h"
+#include "test-device.h"
+#include <vector>
+
+namespace shader {
+
+	using namespace glm;
+
+	#define AUTOSHADER_SOURCE_DATA
+	#include "create-pipe-autoshader.h"
+
+}
+
+namespace {
+
+	// a family of variants that differ only in raster and depth state
+	const vk::CullModeFlagBits culls[] = { vk::CullModeFlagBits::eNone,
+		vk::CullModeFlagBits::eFront, vk::CullModeFlagBits::eBack };
+	const vk::FrontFace faces[] = { vk::FrontFace::eCounterClockwise, vk::FrontFace::eClockwise };
+	const vk::CompareOp depths[] = { vk::CompareOp::eLess, vk::CompareOp::eLessOrEqual,
+		vk::CompareOp::eGreater, vk::CompareOp::eAlways };
+
+	// create every variant, derived from the parent if there is one
+	void createVariants(std::vector<autoshader::Pipeline<shader::Components>> &v,
+			vk::RenderPass rp, vk::Pipeline parent) {
+		size_t i = 0;
+		for (auto c : culls) {
+			for (auto f : faces) {
+				for (auto d : depths) {
+					v[i].deriveFrom(parent);
+					v[i].createPipe(rp, c, f, d);
+					i += 1;
+				}
+			}
+		}
+	}
+
+	constexpr size_t variantCount = 3 * 2 * 4;
+
+}
+
+TEST_CASE( "pipeline-derive" ) {
+
+	testdevice::Device d("pipeline-derive");
+	d.create();
+
+	SECTION( "variants are derived from a parent" ) {
+		autoshader::Pipeline<shader::Components> parent(*d.dev, *d.rp,
+			autoshader::AllowDerivatives());
+		REQUIRE( parent.pipeline != vk::Pipeline() );
+
+		std::vector<autoshader::Pipeline<shader::Components>> v(variantCount);
+		for (auto &p : v)
+			p.components = shader::Components(*d.dev);
+		createVariants(v, *d.rp, parent.pipeline);
+		for (auto &p : v) {
+			REQUIRE( p.pipeline != vk::Pipeline() );
+			REQUIRE( p.parent == parent.pipeline );
+		}
+	}
+
+	SECTION( "a batch derives from a pipeline earlier in the batch" ) {
+		shader::Components pcomp(*d.dev);
+		auto pipes = autoshader::createPipes(
+			pcomp.pipeArgs(*d.rp, autoshader::AllowDerivatives()),
+			pcomp.pipeArgs(*d.rp, vk::CullModeFlagBits::eBack, autoshader::BasePipeline(0)),
+			pcomp.pipeArgs(*d.rp, vk::CullModeFlagBits::eFront, autoshader::BasePipeline(0)));
+		for (auto &p : pipes) {
+			REQUIRE( p.result == vk::Result::eSuccess );
+			REQUIRE( *p.pipeline != vk::Pipeline() );
+		}
+	}
+
+}
+
+//------------------------------------------------------------------------------------------
+//-- the creation time of a variant family with and without derivatives. hidden from the
+//-- default run, run it with: pipeline-derive-test "[benchmark]", on lavapipe by pointing
+//-- VK_ICD_FILENAMES at lvp_icd.*.json.
+
+TEST_CASE( "pipeline-derive-bench", "[.][benchmark]" ) {
+
+	testdevice::Device d("pipeline-derive");
+	d.create();
+	autoshader::Pipeline<shader::Components> parent(*d.dev, *d.rp,
+		autoshader::AllowDerivatives());
+	std::vector<autoshader::Pipeline<shader::Components>> v(variantCount);
+	for (auto &p : v)
+		p.components = shader::Components(*d.dev);
+
+	BENCHMARK( "independent variants" ) {
+		createVariants(v, *d.rp, vk::Pipeline());
+		return v[0].pipeline;
+	};
+
+	BENCHMARK( "derived variants" ) {
+		createVariants(v, *d.rp, parent.pipeline);
+		return v[0].pipeline;
+	};
+}
@@ -0,0 +1,88 @@
+//
+//  File: pipeline-library.cpp
+//
+//  Created by Jon Spencer on 2026-10-17 00:33:30
+//  Copyright (c) Jon Spencer. See LICENSE file.
+//
+
+#include <catch2/catch_test_macros.hpp>
+#include "glm/glm.hpp"
+#include "autoshader/pipelinelibrary.h"
+#include "test-device.h"
+#include <stdexcept>
+
+namespace shader {
+
+	using namespace glm;
+
+	#define AUTOSHADER_SOURCE_DATA
+	#include "create-pipe-autoshader.h"
+
+}
+
+TEST_CASE( "pipeline-library" ) {
+
+	testdevice::Device d("pipeline-library", VK_API_VERSION_1_1);
+
+	auto features = d.phys.getFeatures2<vk::PhysicalDeviceFeatures2,
+		vk::PhysicalDeviceGraphicsPipelineLibraryFeaturesEXT>();
+	if (!testdevice::hasExtension(d.phys, VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME) ||
+			!features.get<vk::PhysicalDeviceGraphicsPipelineLibraryFeaturesEXT>()
+				.graphicsPipelineLibrary) {
+		WARN( "graphicsPipelineLibrary is not supported, skipped" );
+		return;
+	}
+
+	vk::PhysicalDeviceGraphicsPipelineLibraryFeaturesEXT library{ true };
+	const char *extensions[] = { VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME,
+		VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME };
+	d.create(2, extensions, &library);
+
+	SECTION( "parts are shared between pipelines" ) {
+		autoshader::PipelineLibraries<shader::Components> libs(shader::Components(*d.dev));
+		auto a = libs.get(*d.rp, vk::CullModeFlagBits::eBack);
+		REQUIRE( a != vk::Pipeline() );
+		REQUIRE( libs.stats().partsCreated == 4 );
+
+		// only the pre-rasterization part changes with the cull mode
+		auto b = libs.get(*d.rp, vk::CullModeFlagBits::eFront);
+		REQUIRE( b != vk::Pipeline() );
+		REQUIRE( b != a );
+		REQUIRE( libs.stats().partsCreated == 5 );
+		REQUIRE( libs.stats().partsFound == 3 );
+
+		REQUIRE( libs.get(*d.rp, vk::CullModeFlagBits::eBack) == a );
+		REQUIRE( libs.stats().fastLinks == 2 );
+		REQUIRE( libs.stats().linksFound == 1 );
+
+		// a probe finds the parts and the link made without it
+		REQUIRE( libs.get(*d.rp, vk::CullModeFlagBits::eBack, autoshader::FailIfUncached()) == a );
+		REQUIRE( libs.stats().partsCreated == 5 );
+		REQUIRE( libs.stats().linksFound == 2 );
+	}
+
+	SECTION( "the optimized link replaces the fast link when ready" ) {
+		autoshader::PipeScheduler scheduler(*d.dev, {}, 1);
+		autoshader::PipelineLibraries<shader::Components> libs(shader::Components(*d.dev),
+			&scheduler);
+		auto fast = libs.get(*d.rp);
+		REQUIRE( fast != vk::Pipeline() );
+		REQUIRE( libs.stats().optimizedLinks == 1 );
+
+		scheduler.wait();
+		auto optimized = libs.get(*d.rp);
+		REQUIRE( optimized != vk::Pipeline() );
+		REQUIRE( optimized != fast );
+	}
+
+	SECTION( "destroying the libraries leaves the other work on the scheduler alone" ) {
+		autoshader::PipeScheduler scheduler(*d.dev, {}, 1);
+		scheduler.schedule(1, [] (vk::PipelineCache) { throw std::runtime_error("other work"); });
+		{
+			autoshader::PipelineLibraries<shader::Components> libs(shader::Components(*d.dev),
+				&scheduler);
+			REQUIRE( libs.get(*d.rp) != vk::Pipeline() );
+		}
+		REQUIRE_THROWS_AS( scheduler.wait(), std::runtime_error );
+	}
+}
@@ -0,0 +1,60 @@
+//
+//  File: pipeline-reload.cpp
+//
+//  Created by Jon Spencer on 2026-10-17 00:18:07
+//  Copyright (c) Jon Spencer. See LICENSE file.
+//
+
+#include <catch2/catch_test_macros.hpp>
+#include "glm/glm.hpp"
+#include "autoshader/pipeline.h"
+#include "autoshader/spirvwatch.h"
+#include "test-device.h"
+
+namespace shader {
+
+	using namespace glm;
+
+	#define AUTOSHADER_SOURCE_DATA
+	#include "create-pipe-autoshader.h"
+
+}
+
+TEST_CASE( "pipeline-reload" ) {
+
+	testdevice::Device d("pipeline-reload");
+	d.create();
+
+	autoshader::Pipeline<shader::Components> pipeline(*d.dev, *d.rp);
+	REQUIRE( pipeline.pipeline != vk::Pipeline() );
+	auto layout = pipeline.components.layout;
+	auto set1 = pipeline.components.set1Layout;
+
+	SECTION( "compatible code replaces the stage" ) {
+		std::vector<uint32_t> frag;
+		REQUIRE( autoshader::readSpirv("reload-compatible.frag.spv", frag) );
+		auto frag0 = pipeline.components.frag;
+		REQUIRE( pipeline.reload({ { frag.data(), frag.size() } }, *d.rp) == autoshader::ReflectError::None );
+		REQUIRE( pipeline.pipeline != vk::Pipeline() );
+		REQUIRE( pipeline.components.frag != frag0 );
+		REQUIRE( pipeline.components.layout == layout );
+		REQUIRE( pipeline.components.set1Layout == set1 );
+	}
+
+	SECTION( "incompatible code leaves the pipeline alone" ) {
+		std::vector<uint32_t> frag;
+		REQUIRE( autoshader::readSpirv("reload-incompatible.frag.spv", frag) );
+		auto frag0 = pipeline.components.frag;
+		auto pipe0 = pipeline.pipeline;
+		REQUIRE( pipeline.reload({ { frag.data(), frag.size() } }, *d.rp) == autoshader::ReflectError::LayoutMismatch );
+		REQUIRE( pipeline.pipeline == pipe0 );
+		REQUIRE( pipeline.components.frag == frag0 );
+	}
+
+	SECTION( "a stage that isn't in the pipeline is rejected" ) {
+		std::vector<uint32_t> comp;
+		REQUIRE( autoshader::readSpirv("array-descriptor.comp.spv", comp) );
+		REQUIRE( pipeline.reload({ { comp.data(), comp.size() } }, *d.rp) != autoshader::ReflectError::None );
+	}
+
+}
@@ -0,0 +1,79 @@
+//
+//  File: pipeline-stats.cpp
+//
+//  Created by Jon Spencer on 2026-10-17 00:44:11
+//  Copyright (c) Jon Spencer. See LICENSE file.
+//
+
+#include <catch2/catch_test_macros.hpp>
+#include "glm/glm.hpp"
+#include "autoshader/pipelinestats.h"
+#include "test-device.h"
+
+namespace shader {
+
+	using namespace glm;
+
+	#define AUTOSHADER_SOURCE_DATA
+	#include "create-pipe-autoshader.h"
+
+}
+
+// the executable properties commands aren't exported by the loader
+VULKAN_HPP_DEFAULT_DISPATCH_LOADER_DYNAMIC_STORAGE
+
+TEST_CASE( "pipeline-stats" ) {
+
+	testdevice::Device d("pipeline-stats", VK_API_VERSION_1_3);
+	if (d.phys.getProperties().apiVersion < VK_API_VERSION_1_3) {
+		WARN( "creation feedback needs vulkan 1.3, skipped" );
+		return;
+	}
+
+	// capture the executable statistics when the device can report them
+	auto features = d.phys.getFeatures2<vk::PhysicalDeviceFeatures2,
+		vk::PhysicalDevicePipelineExecutablePropertiesFeaturesKHR>();
+	bool statistics = testdevice::hasExtension(d.phys,
+		VK_KHR_PIPELINE_EXECUTABLE_PROPERTIES_EXTENSION_NAME) &&
+		features.get<vk::PhysicalDevicePipelineExecutablePropertiesFeaturesKHR>()
+			.pipelineExecutableInfo;
+	vk::PhysicalDevicePipelineExecutablePropertiesFeaturesKHR executableInfo{ true };
+	const char *extensions[] = { VK_KHR_PIPELINE_EXECUTABLE_PROPERTIES_EXTENSION_NAME };
+	if (statistics)
+		d.create(1, extensions, &executableInfo);
+	else
+		d.create();
+
+	SECTION( "feedback is returned for the pipeline and its stages" ) {
+		shader::Components comp(*d.dev);
+		autoshader::CreationFeedback f;
+		auto p = comp.createPipe(*d.rp, &f);
+		REQUIRE( *p != vk::Pipeline() );
+		REQUIRE( f.stageCount == shader::Components::stageFlags().size() );
+		REQUIRE( f.stageFlags[0] == shader::Components::stageFlags()[0] );
+	}
+
+	SECTION( "profiled pipelines are recorded by components" ) {
+		auto &stats = autoshader::pipelineStats<shader::Components>();
+		stats.clear();
+		REQUIRE( stats.contentHash == shader::Components::contentHash() );
+
+		shader::Components comp(*d.dev);
+		REQUIRE( autoshader::createPipeProfiled(comp, *d.rp) );
+		if (statistics)
+			REQUIRE( autoshader::createPipeWithStatistics(comp, *d.rp, vk::CullModeFlagBits::eBack) );
+		else
+			REQUIRE( autoshader::createPipeProfiled(comp, *d.rp, vk::CullModeFlagBits::eBack) );
+		auto records = stats.pipelines();
+		REQUIRE( records.size() == 2 );
+		REQUIRE( records[0].stages.size() == shader::Components::stageFlags().size() );
+		REQUIRE( records[0].executables.empty() );
+		if (statistics)
+			REQUIRE( !records[1].executables.empty() );
+
+		auto json = stats.json();
+		REQUIRE( json.find("\"pipelines\"") != std::string::npos );
+		REQUIRE( json.find("\"duration\"") != std::string::npos );
+		REQUIRE( stats.save("pipeline-stats-test.json") );
+	}
+}
@@ -0,0 +1,76 @@
+//
+//  File: pipeline-variants.cpp
+//
+//  Created by Jon Spencer on 2026-10-17 00:30:33
+//  Copyright (c) Jon Spencer. See LICENSE file.
+//
+
+#include <catch2/catch_test_macros.hpp>
+#include "glm/glm.hpp"
+#include "autoshader/pipelinevariants.h"
+#include "test-device.h"
+
+namespace shader {
+
+	using namespace glm;
+
+	#define AUTOSHADER_SOURCE_DATA
+	#include "create-pipe-autoshader.h"
+
+}
+
+TEST_CASE( "pipeline-variants" ) {
+
+	testdevice::Device d("pipeline-variants");
+	d.create();
+
+	autoshader::PipelineVariants<shader::Components> variants(shader::Components(*d.dev), 2);
+
+	SECTION( "the same state finds the same pipeline" ) {
+		auto a = variants.get(*d.rp, vk::CullModeFlagBits::eBack);
+		auto b = variants.get(*d.rp, vk::CullModeFlagBits::eFront);
+		REQUIRE( a != vk::Pipeline() );
+		REQUIRE( b != vk::Pipeline() );
+		REQUIRE( a != b );
+		REQUIRE( variants.get(*d.rp, vk::CullModeFlagBits::eBack) == a );
+		REQUIRE( variants.stats().hits == 1 );
+		REQUIRE( variants.stats().misses == 2 );
+		REQUIRE( variants.size() == 2 );
+	}
+
+	SECTION( "a probe finds the pipeline created without it" ) {
+		auto a = variants.get(*d.rp, vk::CullModeFlagBits::eBack);
+		REQUIRE( variants.get(*d.rp, vk::CullModeFlagBits::eBack, autoshader::FailIfUncached()) == a );
+		REQUIRE( variants.stats().hits == 1 );
+		REQUIRE( variants.stats().misses == 1 );
+		REQUIRE( variants.size() == 1 );
+	}
+
+	SECTION( "specialization data is part of the key" ) {
+		uint32_t v1 = 1, v2 = 2, v3 = 1;
+		vk::SpecializationMapEntry entry{ 0, 0, sizeof(uint32_t) };
+		auto a = variants.get(*d.rp, vk::SpecializationInfo{ 1, &entry, sizeof(v1), &v1 });
+		auto b = variants.get(*d.rp, vk::SpecializationInfo{ 1, &entry, sizeof(v2), &v2 });
+		REQUIRE( a != b );
+		REQUIRE( variants.get(*d.rp, vk::SpecializationInfo{ 1, &entry, sizeof(v3), &v3 }) == a );
+	}
+
+	SECTION( "the least recently used pipeline is evicted" ) {
+		auto a = variants.get(*d.rp, vk::CullModeFlagBits::eBack);
+		variants.get(*d.rp, vk::CullModeFlagBits::eFront);
+		REQUIRE( variants.get(*d.rp, vk::CullModeFlagBits::eBack) == a );
+		variants.get(*d.rp, vk::CullModeFlagBits::eNone);
+		REQUIRE( variants.size() == 2 );
+		REQUIRE( variants.stats().evictions == 1 );
+
+		// front was evicted, back was used more recently
+		REQUIRE( variants.get(*d.rp, vk::CullModeFlagBits::eBack) == a );
+		variants.get(*d.rp, vk::CullModeFlagBits::eFront);
+		REQUIRE( variants.stats().hits == 2 );
+		REQUIRE( variants.stats().misses == 4 );
+		variants.destroyRetired();
+
+		variants.setBudget(1);
+		REQUIRE( variants.size() == 1 );
+	}
+}
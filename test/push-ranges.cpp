@@ -23,7 +23,7 @@ TEST_CASE( "push-ranges" ) {
 	SECTION( "std140 basic rules" ) {
 
 		auto pr = shader::getPushConstantRanges();
-		REQUIRE( pr.size() == 4 );
+		REQUIRE( pr.size() == 5 );
 		REQUIRE( pr[0].stageFlags == vk::ShaderStageFlagBits::eVertex );
 		REQUIRE( pr[0].offset == 0 );
 		REQUIRE( pr[0].size == 64 );
@@ -37,6 +37,11 @@ TEST_CASE( "push-ranges" ) {
 		REQUIRE( pr[3].offset == 144 );
 		REQUIRE( pr[3].size == 48 );
 
+		// a float[2][3] is two arrays of three floats
+		REQUIRE( pr[4].stageFlags == vk::ShaderStageFlagBits::eVertex );
+		REQUIRE( pr[4].offset == 192 );
+		REQUIRE( pr[4].size == 24 );
+
 	}
 
 }
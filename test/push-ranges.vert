@@ -4,6 +4,7 @@
 layout(push_constant) uniform Push {
 	layout(offset=0) mat4 test0;
 	layout(offset=80) mat4 test2;
+	layout(offset=192) float test5[2][3];
 } push;
 
 void main() {
@@ -0,0 +1,138 @@
+//
+//  File: reflect-format.cpp
+//
+//  Created by Jon Spencer on 2026-10-17 00:08:55
+//  Copyright (c) Jon Spencer. See LICENSE file.
+//
+
+#include <catch2/catch_test_macros.hpp>
+#include "glm/glm.hpp"
+#include "vulkan/vulkan.hpp"
+#include "autoshader/createpipe.h"
+#include "autoshader/reflectformat.h"
+#include <fstream>
+#include <iterator>
+#include <string>
+
+namespace layout {
+
+	using namespace glm;
+
+	#include "reflect-layout-autoshader.h"
+
+}
+
+namespace push {
+
+	using namespace glm;
+
+	#include "reflect-push-autoshader.h"
+
+}
+
+namespace vertex {
+
+	using namespace glm;
+
+	#include "reflect-vertex-autoshader.h"
+
+}
+
+namespace {
+
+	std::vector<uint32_t> read_words(const char *name) {
+		std::ifstream str(name, std::ios::binary);
+		std::string s((std::istreambuf_iterator<char>(str)), std::istreambuf_iterator<char>());
+		std::vector<uint32_t> r((s.size() + 3) / 4);
+		std::copy(s.begin(), s.end(), reinterpret_cast<char*>(r.data()));
+		return r;
+	}
+
+}
+
+TEST_CASE( "reflect-format" ) {
+
+	SECTION( "descriptors match the generated layouts" ) {
+		auto w = read_words("reflect-layout.bin");
+		autoshader::ReflectView v(w.data(), w.size() * 4);
+		REQUIRE( v.valid() );
+		REQUIRE( v.stages().size() == 2 );
+		REQUIRE( v.header->stageFlags == uint32_t(VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT) );
+
+		auto d = v.descriptors();
+		auto s0 = layout::getDescriptorSet0LayoutBindings();
+		auto s1 = layout::getDescriptorSet1LayoutBindings();
+		REQUIRE( d.size() == s0.size() + s1.size() );
+		for (size_t i = 0; i < d.size(); ++i) {
+			auto &b = i < s0.size() ? s0[i] : s1[i - s0.size()];
+			REQUIRE( d[i].set == (i < s0.size() ? 0u : 1u) );
+			REQUIRE( d[i].binding == b.binding );
+			REQUIRE( vk::DescriptorType(d[i].descriptorType) == b.descriptorType );
+			REQUIRE( d[i].count == b.descriptorCount );
+			REQUIRE( vk::ShaderStageFlags(d[i].stageFlags) == b.stageFlags );
+		}
+		REQUIRE( std::string(v.string(d[2].name)) == "heights" );
+	}
+
+	SECTION( "push ranges and structures match the generated interface" ) {
+		auto w = read_words("reflect-push.bin");
+		autoshader::ReflectView v(w.data(), w.size() * 4);
+		REQUIRE( v.valid() );
+
+		auto p = v.pushRanges();
+		auto pr = push::getPushConstantRanges();
+		REQUIRE( p.size() == pr.size() );
+		for (size_t i = 0; i < p.size(); ++i) {
+			REQUIRE( vk::ShaderStageFlags(p[i].stageFlags) == pr[i].stageFlags );
+			REQUIRE( p[i].offset == pr[i].offset );
+			REQUIRE( p[i].size == pr[i].size );
+		}
+
+		REQUIRE( v.structs().size() == 2 );
+		auto &s = v.structs()[0];
+		REQUIRE( std::string(v.string(s.name)) == "Push_vert" );
+		REQUIRE( s.size == sizeof(push::Push_vert) );
+		auto m = v.members(s);
+		REQUIRE( m.size() == 3 );
+		REQUIRE( std::string(v.string(m[1].name)) == "test2" );
+		REQUIRE( std::string(v.string(m[1].type)) == "mat4" );
+		REQUIRE( m[1].offset == offsetof(push::Push_vert, test2) );
+		REQUIRE( m[1].size == 64 );
+		REQUIRE( m[1].matrixStride == 16 );
+		REQUIRE( m[1].structIndex == autoshader::reflectformat::noIndex );
+		REQUIRE( m[2].offset == offsetof(push::Push_vert, test5) );
+		REQUIRE( m[2].arrayStride == 12 );
+		REQUIRE( m[2].dimensionCount == 2 );
+	}
+
+	SECTION( "vertex attributes match the generated structure" ) {
+		auto w = read_words("reflect-vertex.bin");
+		autoshader::ReflectView v(w.data(), w.size() * 4);
+		REQUIRE( v.valid() );
+		REQUIRE( std::string(v.string(v.header->vertexName)) == "Vertex" );
+		REQUIRE( v.header->vertexStride == sizeof(vertex::Vertex) );
+
+		auto a = v.attributes();
+		auto va = vertex::getVertexAttributeDescriptions();
+		REQUIRE( a.size() == va.size() );
+		for (size_t i = 0; i < a.size(); ++i) {
+			REQUIRE( a[i].location == va[i].location );
+			REQUIRE( vk::Format(a[i].format) == va[i].format );
+			REQUIRE( a[i].offset == va[i].offset );
+		}
+
+		std::ifstream json("reflect-vertex.json");
+		std::string s((std::istreambuf_iterator<char>(json)), std::istreambuf_iterator<char>());
+		REQUIRE( s.find("\"stride\": 128") != std::string::npos );
+		REQUIRE( s.find("\"format\": \"R64G64B64_SFLOAT\"") != std::string::npos );
+	}
+
+	SECTION( "a damaged file is rejected" ) {
+		auto w = read_words("reflect-layout.bin");
+		autoshader::ReflectView v(w.data(), w.size() * 4 - 4);
+		REQUIRE( !v.valid() );
+		w[0] = 0;
+		REQUIRE( !v.open(w.data(), w.size() * 4) );
+	}
+
+}
@@ -0,0 +1,11 @@
+#version 450
+
+layout(location = 0) in vec2 texCoord;
+
+layout(set = 1, binding = 0) uniform sampler2D colorTexture;
+
+layout(location = 0) out vec4 outColor;
+
+void main() {
+	outColor = texture(colorTexture, texCoord);
+}
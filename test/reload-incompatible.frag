@@ -0,0 +1,13 @@
+#version 450
+
+layout(location = 0) in vec2 texCoord;
+
+layout(set = 1, binding = 0) uniform Tint {
+	vec4 color;
+} tint;
+
+layout(location = 0) out vec4 outColor;
+
+void main() {
+	outColor = tint.color * vec4(texCoord, 0, 1);
+}
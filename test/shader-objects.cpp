@@ -0,0 +1,86 @@
+//
+//  File: shader-objects.cpp
+//
+//  Created by Jon Spencer on 2026-10-17 00:40:31
+//  Copyright (c) Jon Spencer. See LICENSE file.
+//
+
+#include <catch2/catch_test_macros.hpp>
+#include "glm/glm.hpp"
+#include "autoshader/shaderobjects.h"
+#include "test-device.h"
+
+namespace shader {
+
+	using namespace glm;
+
+	#define AUTOSHADER_SOURCE_DATA
+	#include "create-pipe-autoshader.h"
+
+}
+
+// the extension commands aren't exported by the loader
+VULKAN_HPP_DEFAULT_DISPATCH_LOADER_DYNAMIC_STORAGE
+
+TEST_CASE( "shader stage order" ) {
+
+	// a linked stage names the next stage by pipeline order, not by the value of its bit
+	using autoshader::stageOrder;
+	using S = vk::ShaderStageFlagBits;
+	REQUIRE( stageOrder(S::eVertex) < stageOrder(S::eTessellationControl) );
+	REQUIRE( stageOrder(S::eTessellationEvaluation) < stageOrder(S::eGeometry) );
+	REQUIRE( stageOrder(S::eGeometry) < stageOrder(S::eFragment) );
+	REQUIRE( stageOrder(S::eTaskEXT) < stageOrder(S::eMeshEXT) );
+	REQUIRE( stageOrder(S::eMeshEXT) < stageOrder(S::eFragment) );
+	REQUIRE( stageOrder(S::eCompute) == 0 );
+}
+
+TEST_CASE( "shader-objects" ) {
+
+	testdevice::Device d("shader-objects", VK_API_VERSION_1_3);
+
+	auto features = d.phys.getFeatures2<vk::PhysicalDeviceFeatures2,
+		vk::PhysicalDeviceShaderObjectFeaturesEXT>();
+	if (d.phys.getProperties().apiVersion < VK_API_VERSION_1_3 ||
+			!testdevice::hasExtension(d.phys, VK_EXT_SHADER_OBJECT_EXTENSION_NAME) ||
+			!features.get<vk::PhysicalDeviceShaderObjectFeaturesEXT>().shaderObject) {
+		WARN( "shaderObject is not supported, skipped" );
+		return;
+	}
+
+	// tessellation and geometry are bound to null if the device has them
+	vk::PhysicalDeviceFeatures2 enabled;
+	auto &supported = features.get<vk::PhysicalDeviceFeatures2>().features;
+	enabled.features.tessellationShader = supported.tessellationShader;
+	enabled.features.geometryShader = supported.geometryShader;
+	autoshader::NullStages nulls;
+	if (supported.tessellationShader) {
+		nulls.stages |= vk::ShaderStageFlagBits::eTessellationControl |
+			vk::ShaderStageFlagBits::eTessellationEvaluation;
+	}
+	if (supported.geometryShader)
+		nulls.stages |= vk::ShaderStageFlagBits::eGeometry;
+
+	vk::PhysicalDeviceShaderObjectFeaturesEXT shaderObject{ true };
+	enabled.pNext = &shaderObject;
+	const char *extensions[] = { VK_EXT_SHADER_OBJECT_EXTENSION_NAME };
+	d.create(1, extensions, &enabled);
+
+	SECTION( "linked shaders are created from the embedded code" ) {
+		autoshader::ShaderObjects<shader::Components> so(*d.dev);
+		REQUIRE( so.valid() );
+		for (auto s : so.shaders)
+			REQUIRE( s != vk::ShaderEXT() );
+	}
+
+	SECTION( "binding sets the state a pipeline would hold" ) {
+		autoshader::ShaderObjects<shader::Components> so(*d.dev);
+		REQUIRE( so.valid() );
+
+		auto pool = d.dev->createCommandPoolUnique({ {}, 0 });
+		auto cbs = d.dev->allocateCommandBuffersUnique({ *pool, vk::CommandBufferLevel::ePrimary, 1 });
+		cbs[0]->begin(vk::CommandBufferBeginInfo{});
+		so.bind(*cbs[0], vk::Extent2D(64, 64), vk::CullModeFlagBits::eBack, nulls);
+		cbs[0]->end();
+	}
+}
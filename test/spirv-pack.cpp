@@ -0,0 +1,60 @@
+//
+//  File: spirv-pack.cpp
+//
+//  Created by Jon Spencer on 2026-10-16 14:22:08
+//  Copyright (c) Jon Spencer. See LICENSE file.
+//
+
+#include <catch2/catch_test_macros.hpp>
+#include "glm/glm.hpp"
+#include "vulkan/vulkan.hpp"
+#include "autoshader/createpipe.h"
+#include <cstring>
+
+namespace pack { using namespace glm; }
+namespace strip { using namespace glm; }
+
+#define AUTOSHADER_SOURCE_DATA
+#include "pack-autoshader.h"
+#include "strip-autoshader.h"
+
+namespace shader {
+
+	using namespace glm;
+
+	#include "jobs-serial-autoshader.h"
+
+}
+
+TEST_CASE( "spirv-pack" ) {
+
+	SECTION( "packed data unpacks to the original words" ) {
+		std::vector<uint32_t> w;
+		REQUIRE( pack::vert_size == shader::vert_size );
+		auto v = autoshader::unpackSpirv(w, pack::vert_packed, pack::vert_packed_size);
+		REQUIRE( w.size() * 4 == shader::vert_size );
+		REQUIRE( std::memcmp(v, shader::vert_data, shader::vert_size) == 0 );
+		REQUIRE( pack::vert_packed_size < pack::vert_size );
+
+		REQUIRE( pack::frag_size == shader::frag_size );
+		auto f = autoshader::unpackSpirv(w, pack::frag_packed, pack::frag_packed_size);
+		REQUIRE( w.size() * 4 == shader::frag_size );
+		REQUIRE( std::memcmp(f, shader::frag_data, shader::frag_size) == 0 );
+	}
+
+	SECTION( "stripped data keeps the header and drops the names" ) {
+		std::vector<uint32_t> w;
+		auto v = autoshader::unpackSpirv(w, strip::vert_packed, strip::vert_packed_size);
+		REQUIRE( w.size() * 4 == strip::vert_size );
+		REQUIRE( strip::vert_size < shader::vert_size );
+		REQUIRE( std::memcmp(v, shader::vert_data, 20) == 0 );
+		for (size_t i = 5; i < w.size(); i += w[i] >> 16)
+			REQUIRE( (w[i] & 0xffff) != 5 );
+	}
+
+	SECTION( "corrupt data is rejected" ) {
+		std::vector<uint32_t> w;
+		REQUIRE_THROWS( autoshader::unpackSpirv(w, pack::vert_packed, pack::vert_packed_size / 2) );
+	}
+
+}
@@ -0,0 +1,202 @@
+//
+//  File: spirv-reflect.cpp
+//
+//  Created by Jon Spencer on 2026-10-17 00:14:10
+//  Copyright (c) Jon Spencer. See LICENSE file.
+//
+
+#include <catch2/catch_test_macros.hpp>
+#include "glm/glm.hpp"
+#include "vulkan/vulkan.hpp"
+#include "autoshader/createpipe.h"
+#include "autoshader/spirvreflect.h"
+#include "autoshader/spirvwatch.h"
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+namespace layout {
+
+	using namespace glm;
+
+	#include "reflect-layout-autoshader.h"
+
+}
+
+namespace push {
+
+	using namespace glm;
+
+	#include "reflect-push-autoshader.h"
+
+}
+
+namespace vertex {
+
+	using namespace glm;
+
+	#include "reflect-vertex-autoshader.h"
+
+}
+
+namespace {
+
+	std::vector<uint32_t> read_words(const char *name) {
+		std::ifstream str(name, std::ios::binary);
+		std::string s((std::istreambuf_iterator<char>(str)), std::istreambuf_iterator<char>());
+		std::vector<uint32_t> r(s.size() / 4);
+		std::copy(s.begin(), s.begin() + r.size() * 4, reinterpret_cast<char*>(r.data()));
+		return r;
+	}
+
+	autoshader::SpirvCode code(const std::vector<uint32_t> &w) {
+		return autoshader::SpirvCode{ w.data(), w.size() };
+	}
+
+	template <typename T>
+	void require_bindings(const std::vector<vk::DescriptorSetLayoutBinding> &a, const T &b) {
+		REQUIRE( a.size() == b.size() );
+		for (size_t i = 0; i < a.size(); ++i) {
+			REQUIRE( a[i].binding == b[i].binding );
+			REQUIRE( a[i].descriptorType == b[i].descriptorType );
+			REQUIRE( a[i].descriptorCount == b[i].descriptorCount );
+			REQUIRE( a[i].stageFlags == b[i].stageFlags );
+		}
+	}
+
+}
+
+TEST_CASE( "spirv-reflect" ) {
+
+	autoshader::LayoutReflector reflector;
+	autoshader::LayoutReflection r;
+
+	SECTION( "descriptor sets match the generated layouts" ) {
+		auto vert = read_words("descriptor-set-layout.vert.spv");
+		auto frag = read_words("descriptor-set-layout.frag.spv");
+		REQUIRE( reflector.reflect(r, { code(vert), code(frag) }) == autoshader::ReflectError::None );
+		REQUIRE( r.stages.size() == 2 );
+		REQUIRE( r.stages[0] == vk::ShaderStageFlagBits::eVertex );
+		REQUIRE( r.stages[1] == vk::ShaderStageFlagBits::eFragment );
+		REQUIRE( r.sets.size() == 2 );
+		require_bindings(r.sets[0], layout::getDescriptorSet0LayoutBindings());
+		require_bindings(r.sets[1], layout::getDescriptorSet1LayoutBindings());
+	}
+
+	SECTION( "push constant ranges match the generated ranges" ) {
+		auto vert = read_words("push-ranges.vert.spv");
+		auto frag = read_words("push-ranges.frag.spv");
+		REQUIRE( reflector.reflect(r, { code(vert), code(frag) }) == autoshader::ReflectError::None );
+		auto pr = push::getPushConstantRanges();
+		REQUIRE( r.pushRanges.size() == pr.size() );
+		for (size_t i = 0; i < pr.size(); ++i) {
+			REQUIRE( r.pushRanges[i].stageFlags == pr[i].stageFlags );
+			REQUIRE( r.pushRanges[i].offset == pr[i].offset );
+			REQUIRE( r.pushRanges[i].size == pr[i].size );
+		}
+	}
+
+	SECTION( "vertex input matches the generated structure" ) {
+		auto vert = read_words("vertex-input.vert.spv");
+		REQUIRE( reflector.reflect(r, { code(vert) }) == autoshader::ReflectError::None );
+		REQUIRE( r.vertexBinding.stride == sizeof(vertex::Vertex) );
+		REQUIRE( r.vertexBinding.inputRate == vk::VertexInputRate::eVertex );
+		auto va = vertex::getVertexAttributeDescriptions();
+		REQUIRE( r.vertexAttributes.size() == va.size() );
+		for (size_t i = 0; i < va.size(); ++i) {
+			REQUIRE( r.vertexAttributes[i].location == va[i].location );
+			REQUIRE( r.vertexAttributes[i].format == va[i].format );
+			REQUIRE( r.vertexAttributes[i].offset == va[i].offset );
+		}
+	}
+
+	SECTION( "bad spirv is rejected" ) {
+		auto vert = read_words("vertex-input.vert.spv");
+		vert[0] = 0;
+		REQUIRE( autoshader::reflectLayouts(r, { code(vert) }) == autoshader::ReflectError::InvalidSpirv );
+		REQUIRE( r.stages.empty() );
+		vert.resize(3);
+		REQUIRE( reflector.reflect(r, { code(vert) }) == autoshader::ReflectError::InvalidSpirv );
+
+		// a push constant block that contains itself
+		std::vector<uint32_t> block = {
+			0x07230203, 0x10000, 0, 5, 0,
+			(5 << 16) | 15, 0, 1, 0x6e69616d, 0,	// OpEntryPoint Vertex %1 "main"
+			(3 << 16) | 30, 2, 2,					// %2 = OpTypeStruct %2
+			(5 << 16) | 72, 2, 0, 35, 0,			// OpMemberDecorate %2 0 Offset 0
+			(4 << 16) | 32, 3, 9, 2,				// %3 = OpTypePointer PushConstant %2
+			(4 << 16) | 59, 3, 4, 9,				// %4 = OpVariable %3 PushConstant
+		};
+		REQUIRE( reflector.reflect(r, { code(block) }) == autoshader::ReflectError::InvalidSpirv );
+
+		// a uniform array of itself
+		std::vector<uint32_t> array = {
+			0x07230203, 0x10000, 0, 8, 0,
+			(5 << 16) | 15, 0, 1, 0x6e69616d, 0,	// OpEntryPoint Vertex %1 "main"
+			(4 << 16) | 21, 5, 32, 0,				// %5 = OpTypeInt 32 0
+			(4 << 16) | 43, 5, 6, 2,				// %6 = OpConstant %5 2
+			(4 << 16) | 28, 2, 2, 6,				// %2 = OpTypeArray %2 %6
+			(4 << 16) | 32, 3, 2, 2,				// %3 = OpTypePointer Uniform %2
+			(4 << 16) | 59, 3, 4, 2,				// %4 = OpVariable %3 Uniform
+		};
+		REQUIRE( reflector.reflect(r, { code(array) }) == autoshader::ReflectError::InvalidSpirv );
+	}
+
+	SECTION( "runtime arrays have no count" ) {
+		auto comp = read_words("array-descriptor.comp.spv");
+		REQUIRE( reflector.reflect(r, { code(comp) }) == autoshader::ReflectError::None );
+		REQUIRE( r.sets.size() == 2 );
+		REQUIRE( r.sets[0][0].descriptorType == vk::DescriptorType::eStorageBuffer );
+		REQUIRE( r.sets[0][0].descriptorCount == 0 );
+		REQUIRE( r.sets[1][0].descriptorCount == 64 );
+	}
+
+	SECTION( "mismatched stages are rejected" ) {
+		auto vert = read_words("descriptor-set-layout.vert.spv");
+		auto other = read_words("array-descriptor.comp.spv");
+		auto e = reflector.reflect(r, { code(vert), code(other) });
+		REQUIRE( e == autoshader::ReflectError::DescriptorMismatch );
+		REQUIRE( std::string(autoshader::reflectErrorString(e)) != "" );
+	}
+
+	SECTION( "replacement stages are checked against the layouts" ) {
+		auto vert = read_words("create-pipe.vert.spv");
+		auto frag = read_words("create-pipe.frag.spv");
+		autoshader::LayoutReflection l;
+		REQUIRE( reflector.reflect(l, { code(vert), code(frag) }) == autoshader::ReflectError::None );
+
+		auto good = read_words("reload-compatible.frag.spv");
+		REQUIRE( reflector.reflect(r, { code(good) }) == autoshader::ReflectError::None );
+		REQUIRE( autoshader::checkLayoutCompatible(l, r) == autoshader::ReflectError::None );
+
+		auto bad = read_words("reload-incompatible.frag.spv");
+		REQUIRE( reflector.reflect(r, { code(bad) }) == autoshader::ReflectError::None );
+		REQUIRE( autoshader::checkLayoutCompatible(l, r) == autoshader::ReflectError::LayoutMismatch );
+
+		auto push = read_words("push-ranges.vert.spv");
+		REQUIRE( reflector.reflect(r, { code(push) }) == autoshader::ReflectError::None );
+		REQUIRE( autoshader::checkLayoutCompatible(l, r) == autoshader::ReflectError::LayoutMismatch );
+	}
+
+	SECTION( "a rewritten file is seen by the watcher" ) {
+		auto frag = read_words("reload-compatible.frag.spv");
+		std::remove("watch-test.spv");
+		autoshader::SpirvWatcher watcher;
+		size_t other, index;
+		REQUIRE( watcher.watch("watch-other.spv", other) );
+		REQUIRE( watcher.watch("watch-test.spv", index) );
+		std::vector<size_t> changed;
+		REQUIRE( watcher.poll(changed) == 0 );
+
+		std::ofstream(std::string("watch-test.spv"), std::ios::binary).write(
+			reinterpret_cast<const char*>(frag.data()), frag.size() * 4);
+		REQUIRE( watcher.poll(changed, 2000) == 1 );
+		REQUIRE( changed[0] == index );
+
+		std::vector<uint32_t> words;
+		REQUIRE( autoshader::readSpirv("watch-test.spv", words) );
+		REQUIRE( words == frag );
+	}
+
+}
@@ -0,0 +1,86 @@
+//
+//  File: subgroup-size.cpp
+//
+//  Created by Jon Spencer on 2026-10-17 00:50:55
+//  Copyright (c) Jon Spencer. See LICENSE file.
+//
+
+#include <catch2/catch_test_macros.hpp>
+#include "glm/glm.hpp"
+#include "autoshader/pipelinevariants.h"
+#include "test-device.h"
+
+namespace shader {
+
+	using namespace glm;
+
+	#define AUTOSHADER_SOURCE_DATA
+	#include "subgroup-size-autoshader.h"
+
+}
+
+TEST_CASE( "subgroup-size" ) {
+
+	testdevice::Device d("subgroup-size", VK_API_VERSION_1_3);
+	if (d.phys.getProperties().apiVersion < VK_API_VERSION_1_3) {
+		WARN( "subgroup size control needs vulkan 1.3, skipped" );
+		return;
+	}
+	auto features = d.phys.getFeatures2<vk::PhysicalDeviceFeatures2,
+		vk::PhysicalDeviceVulkan13Features>().get<vk::PhysicalDeviceVulkan13Features>();
+	vk::PhysicalDeviceVulkan13Features enable;
+	enable.subgroupSizeControl = features.subgroupSizeControl;
+	enable.computeFullSubgroups = features.computeFullSubgroups;
+	d.create(0, nullptr, &enable);
+
+	REQUIRE( uint32_t(shader::Components::subgroupSize) == 32 );
+	auto props = d.phys.getProperties2<vk::PhysicalDeviceProperties2,
+		vk::PhysicalDeviceSubgroupSizeControlProperties>();
+	auto &sub = props.get<vk::PhysicalDeviceSubgroupSizeControlProperties>();
+	bool control = features.subgroupSizeControl &&
+		(sub.requiredSubgroupSizeStages & vk::ShaderStageFlagBits::eCompute);
+
+	SECTION( "the preferred size is required only within the device limits" ) {
+		auto r = shader::Components::requiredSubgroupSize(d.phys);
+		if (sub.minSubgroupSize <= 32 && sub.maxSubgroupSize >= 32 &&
+				(sub.requiredSubgroupSizeStages & vk::ShaderStageFlagBits::eCompute))
+			REQUIRE( r.requiredSubgroupSize == 32 );
+		else
+			REQUIRE( r.requiredSubgroupSize == 0 );
+		REQUIRE( autoshader::requiredSubgroupSize(d.phys, 24).requiredSubgroupSize == 0 );
+		REQUIRE( autoshader::requiredSubgroupSize(d.phys, sub.maxSubgroupSize * 2)
+			.requiredSubgroupSize == 0 );
+	}
+
+	SECTION( "a pipeline is created with the size the device supports" ) {
+		if (!control) {
+			WARN( "subgroupSizeControl isn't supported for compute, skipped" );
+			return;
+		}
+		shader::Components comp(*d.dev);
+		auto size = shader::Components::requiredSubgroupSize(d.phys);
+		auto p = comp.createPipe(size);
+		REQUIRE( p );
+		if (features.computeFullSubgroups) {
+			p = comp.createPipe(size, vk::PipelineShaderStageCreateFlagBits::eRequireFullSubgroups);
+			REQUIRE( p );
+		}
+	}
+
+	SECTION( "each subgroup size is its own variant" ) {
+		if (!control) {
+			WARN( "subgroupSizeControl isn't supported for compute, skipped" );
+			return;
+		}
+		autoshader::PipelineVariants<shader::Components> variants(shader::Components(*d.dev));
+		auto a = variants.get(vk::PipelineShaderStageRequiredSubgroupSizeCreateInfo{
+			sub.minSubgroupSize });
+		REQUIRE( a != vk::Pipeline() );
+		REQUIRE( variants.get(vk::PipelineShaderStageRequiredSubgroupSizeCreateInfo{
+			sub.minSubgroupSize }) == a );
+		if (sub.maxSubgroupSize != sub.minSubgroupSize) {
+			REQUIRE( variants.get(vk::PipelineShaderStageRequiredSubgroupSizeCreateInfo{
+				sub.maxSubgroupSize }) != a );
+		}
+	}
+}
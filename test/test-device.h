@@ -0,0 +1,78 @@
+//
+//  File: test-device.h
+//
+//  Created by Jon Spencer on 2026-10-17 01:31:05
+//  Copyright (c) Jon Spencer. See LICENSE file.
+//
+
+#ifndef H_AUTOSHADER_TEST_DEVICE_H__
+#define H_AUTOSHADER_TEST_DEVICE_H__
+
+#include <catch2/catch_test_macros.hpp>
+#include "vulkan/vulkan.hpp"
+#include <cstring>
+
+namespace testdevice {
+
+	//-- hasExtension - true if the physical device has the extension
+	inline bool hasExtension(vk::PhysicalDevice phys, const char *name) {
+		for (auto &e : phys.enumerateDeviceExtensionProperties()) {
+			if (std::strcmp(e.extensionName, name) == 0)
+				return true;
+		}
+		return false;
+	}
+
+	//----------------------------------------------------------------------------------------
+	//-- Device - the instance, device and single color attachment render pass the pipeline
+	//-- tests create with, on the first physical device. the device is created by create(),
+	//-- so a test can check phys and choose the extensions and features first. with the
+	//-- dynamic dispatcher, the default dispatcher is initialized for the instance and device.
+
+	struct Device {
+		explicit Device(const char *name, uint32_t apiVersion = VK_API_VERSION_1_0) {
+#if VULKAN_HPP_DISPATCH_LOADER_DYNAMIC == 1
+			VULKAN_HPP_DEFAULT_DISPATCHER.init();
+#endif
+			vk::ApplicationInfo appinfo{ name, 0x010000, "autoshader", 0x010000, apiVersion };
+			inst = vk::createInstanceUnique({ {}, &appinfo });
+#if VULKAN_HPP_DISPATCH_LOADER_DYNAMIC == 1
+			VULKAN_HPP_DEFAULT_DISPATCHER.init(*inst);
+#endif
+			auto p = inst->enumeratePhysicalDevices();
+			REQUIRE( p.size() > 0 );
+			phys = p[0];
+		}
+
+		//-- create the device with one queue from family 0, then the render pass
+		void create(uint32_t extensionCount = 0, const char *const *extensions = nullptr,
+				const void *features = nullptr) {
+			float priority = 1.0f;
+			auto que = vk::DeviceQueueCreateInfo{ {}, 0, 1, &priority };
+			vk::DeviceCreateInfo info{ {}, 1, &que, 0, nullptr, extensionCount, extensions };
+			info.pNext = features;
+			dev = phys.createDeviceUnique(info);
+#if VULKAN_HPP_DISPATCH_LOADER_DYNAMIC == 1
+			VULKAN_HPP_DEFAULT_DISPATCHER.init(*dev);
+#endif
+
+			vk::AttachmentDescription attachment{{}, vk::Format::eR8G8B8A8Unorm,
+				vk::SampleCountFlagBits::e1, vk::AttachmentLoadOp::eClear,
+				vk::AttachmentStoreOp::eStore, vk::AttachmentLoadOp::eDontCare,
+				vk::AttachmentStoreOp::eDontCare, vk::ImageLayout::eTransferSrcOptimal,
+				vk::ImageLayout::eTransferSrcOptimal };
+			vk::AttachmentReference colorReference{ 0, vk::ImageLayout::eColorAttachmentOptimal };
+			vk::SubpassDescription subpass({}, vk::PipelineBindPoint::eGraphics, 0, nullptr, 1,
+				&colorReference, nullptr, nullptr);
+			rp = dev->createRenderPassUnique({ {}, 1, &attachment, 1, &subpass });
+		}
+
+		vk::UniqueInstance inst;
+		vk::PhysicalDevice phys;
+		vk::UniqueDevice dev;
+		vk::UniqueRenderPass rp;
+	};
+
+} // namespace testdevice
+
+#endif // H_AUTOSHADER_TEST_DEVICE_H__
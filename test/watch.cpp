@@ -0,0 +1,76 @@
+//
+//  File: watch.cpp
+//
+//  Created by Jon Spencer on 2026-10-17 01:14:56
+//  Copyright (c) Jon Spencer. See LICENSE file.
+//
+
+#include <catch2/catch_test_macros.hpp>
+#include "watch.h"
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+
+namespace {
+
+	std::string read_file(const std::string &name) {
+		std::ifstream str(name, std::ios::binary);
+		return std::string((std::istreambuf_iterator<char>(str)), std::istreambuf_iterator<char>());
+	}
+
+	void write_file(const std::string &name, const std::string &s) {
+		std::ofstream(name, std::ios::binary).write(s.data(), s.size());
+	}
+
+	bool file_exists(const std::string &name) {
+		return std::ifstream(name).good();
+	}
+
+}
+
+TEST_CASE( "watch" ) {
+
+	// two pipelines, as two lines of a manifest would give, with their own copies of the stages
+	auto vert = read_file("create-pipe.vert.spv");
+	auto frag = read_file("create-pipe.frag.spv");
+	REQUIRE( !vert.empty() );
+	REQUIRE( !frag.empty() );
+
+	std::vector<autoshader::PipelineOptions> pipelines(2);
+	for (size_t i = 0; i < pipelines.size(); ++i) {
+		auto name = "watch-" + std::to_string(i);
+		write_file(name + ".vert.spv", vert);
+		write_file(name + ".frag.spv", frag);
+		std::remove((name + "-autoshader.h").c_str());
+		pipelines[i].input = { name + ".vert.spv", name + ".frag.spv" };
+		pipelines[i].output = name + "-autoshader.h";
+	}
+
+	// generate both pipelines, then only the pipeline whose stage changes. the test has a
+	// timeout in case the change is never seen.
+	std::thread watcher([&pipelines] {
+		autoshader::watch_pipelines("watch-test", pipelines, 1, 2);
+	});
+
+	// the inputs are watched before the first outputs are written
+	auto until = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+	bool generated = false;
+	while (!generated && std::chrono::steady_clock::now() < until) {
+		generated = file_exists(pipelines[0].output) && file_exists(pipelines[1].output);
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+
+	// touch one stage of the first pipeline
+	std::remove(pipelines[0].output.c_str());
+	std::remove(pipelines[1].output.c_str());
+	write_file(pipelines[0].input[1], frag);
+	watcher.join();
+
+	REQUIRE( generated );
+	REQUIRE( file_exists(pipelines[0].output) );
+	REQUIRE( !file_exists(pipelines[1].output) );
+
+}